@@ -181,6 +181,9 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
 #if MODE_SMARTRTL_ENABLED
     SCHED_TASK_CLASS(ModeSmartRTL,         &copter.mode_smartrtl,       save_position,    3, 100,  51),
 #endif
+#if MODE_AUTO_ENABLED && AC_WPNAV_MISSION_PLAN_ENABLED
+    SCHED_TASK_CLASS(ModeAuto,             &copter.mode_auto,           update_mission_plan, 10, 100,  52),
+#endif
 #if HAL_SPRAYER_ENABLED
     SCHED_TASK_CLASS(AC_Sprayer,           &copter.sprayer,               update,         3,  90,  54),
 #endif
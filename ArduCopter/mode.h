@@ -606,6 +606,11 @@ public:
     // Mission change detector
     AP_Mission_ChangeDetector mis_change_detector;
 
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+    // compile the mission time estimate in the background and log the time remaining
+    void update_mission_plan();
+#endif
+
     // true if weathervaning is allowed in auto
 #if WEATHERVANE_ENABLED
     bool allows_weathervaning(void) const override;
@@ -785,6 +790,12 @@ private:
     } desired_speed_override;
 
     float circle_last_num_complete;
+
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+    // whole mission time to complete estimate
+    AC_WPNav_MissionPlan mission_plan{mission};
+    uint32_t mission_plan_log_ms;   // system time the time remaining was last logged
+#endif
 };
 
 #if AUTOTUNE_ENABLED
@@ -2406,4 +2406,30 @@ int32_t ModeAuto::get_alt_above_ground_cm() const
     return Mode::get_alt_above_ground_cm();
 }
 
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+// compile the mission plan in the background while in AUTO and log
+// the time remaining once a second while flying it. The plan is only
+// an estimate, so outside AUTO it is dropped to free its memory
+void ModeAuto::update_mission_plan()
+{
+    if (copter.flightmode != this) {
+        mission_plan.reset();
+        return;
+    }
+    mission_plan.update(*wp_nav);
+
+#if HAL_LOGGING_ENABLED
+    if (_mode != SubMode::WP) {
+        return;
+    }
+    const uint32_t now_ms = millis();
+    if (now_ms - mission_plan_log_ms < 1000) {
+        return;
+    }
+    mission_plan_log_ms = now_ms;
+    mission_plan.log_time_remaining(mission.get_current_nav_index(), wp_nav->get_wp_distance_to_destination_cm());
+#endif
+}
+#endif
+
 #endif
@@ -0,0 +1,202 @@
+--[[
+   scenario driver for batch_sitl.py
+
+   Reads scenario.txt from the SITL working directory, then applies
+   timed RC overrides, mode changes, arming and parameter changes
+   (used to inject failures) while watching the pass and fail
+   conditions. The outcome is written to result.txt, which the batch
+   runner waits for.
+
+   All times are in simulated seconds since the script started, so a
+   scenario behaves the same whatever speedup it is run at.
+--]]
+
+---@diagnostic disable: param-type-mismatch
+
+local UPDATE_MS = 100
+local MAV_SEVERITY_INFO = 6
+
+local events = {}
+local next_event = 1
+local overrides = {}
+local pass_conditions = {}
+local fail_conditions = {}
+local timeout_s = 600
+local mission_file = nil
+
+local start_ms = nil
+local was_armed = false
+local arm_pending = false
+local max_dist = 0
+local finished = false
+
+local function result(passed, reason)
+   local t = (millis() - start_ms):tofloat() * 0.001
+   -- the runner polls for result.txt, so make it appear complete
+   local f = assert(io.open("result.tmp", "w"), "could not open result.tmp")
+   f:write(string.format("%s %.1f %.1f %s\n", passed and "PASS" or "FAIL", t, max_dist, reason))
+   f:close()
+   os.rename("result.tmp", "result.txt")
+   gcs:send_text(MAV_SEVERITY_INFO, string.format("Scenario %s: %s", passed and "PASS" or "FAIL", reason))
+   finished = true
+end
+
+local function split(line)
+   local words = {}
+   for w in string.gmatch(line, "%S+") do
+      words[#words+1] = w
+   end
+   return words
+end
+
+local function read_scenario(file_name)
+   local file = assert(io.open(file_name), "could not open " .. file_name)
+   for line in file:lines() do
+      local w = split(line)
+      if #w == 0 or string.sub(w[1], 1, 1) == "#" then
+         -- blank line or comment
+      elseif w[1] == "at" then
+         events[#events+1] = { t = tonumber(w[2]), cmd = w[3], a = w[4], b = w[5] }
+      elseif w[1] == "pass" then
+         pass_conditions[#pass_conditions+1] = { what = w[2], value = tonumber(w[3]) }
+      elseif w[1] == "fail" then
+         fail_conditions[#fail_conditions+1] = { what = w[2], value = tonumber(w[3]) }
+      elseif w[1] == "timeout" then
+         timeout_s = tonumber(w[2])
+      elseif w[1] == "mission" then
+         mission_file = w[2]
+      end
+      -- other keywords are for the batch runner
+   end
+   file:close()
+   table.sort(events, function(e1, e2) return e1.t < e2.t end)
+end
+
+local function load_mission(file_name)
+   local file = assert(io.open(file_name), "could not open " .. file_name)
+   assert(string.find(file:read('l'), 'QGC WPL 110') == 1, file_name .. ': incorrect format')
+   assert(mission:clear(), 'could not clear mission')
+   local item = mavlink_mission_item_int_t()
+   local index = 0
+   for line in file:lines() do
+      local ret, _, seq, _, frame, cmd, p1, p2, p3, p4, x, y, z, _ = string.find(line, "^(%d+)%s+(%d+)%s+(%d+)%s+(%d+)%s+([-.%d]+)%s+([-.%d]+)%s+([-.%d]+)%s+([-.%d]+)%s+([-.%d]+)%s+([-.%d]+)%s+([-.%d]+)%s+(%d+)")
+      assert(ret and tonumber(seq) == index, string.format("%s: bad item %u", file_name, index))
+      item:seq(index)
+      item:frame(tonumber(frame))
+      item:command(tonumber(cmd))
+      item:param1(tonumber(p1))
+      item:param2(tonumber(p2))
+      item:param3(tonumber(p3))
+      item:param4(tonumber(p4))
+      if mission:cmd_has_location(tonumber(cmd)) then
+         item:x(math.floor(tonumber(x)*10^7))
+         item:y(math.floor(tonumber(y)*10^7))
+      else
+         item:x(math.floor(tonumber(x)))
+         item:y(math.floor(tonumber(y)))
+      end
+      item:z(tonumber(z))
+      assert(mission:set_item(index, item), string.format("%s: could not set item %u", file_name, index))
+      index = index + 1
+   end
+   file:close()
+   gcs:send_text(MAV_SEVERITY_INFO, string.format("Scenario: loaded %u mission items", index))
+end
+
+local function run_event(e)
+   if e.cmd == "rc" then
+      overrides[tonumber(e.a)] = tonumber(e.b)
+   elseif e.cmd == "mode" then
+      vehicle:set_mode(tonumber(e.a))
+   elseif e.cmd == "arm" then
+      arm_pending = true
+   elseif e.cmd == "disarm" then
+      arm_pending = false
+      arming:disarm()
+   elseif e.cmd == "param" then
+      if not param:set(e.a, tonumber(e.b)) then
+         result(false, "no parameter " .. e.a)
+      end
+   else
+      result(false, "unknown event " .. tostring(e.cmd))
+   end
+end
+
+local function check_condition(c)
+   if c.what == "disarmed" then
+      return was_armed and not arming:is_armed()
+   elseif c.what == "wp" then
+      return mission:get_current_nav_index() >= c.value
+   elseif c.what == "distance" then
+      return max_dist > c.value
+   elseif c.what == "mode" then
+      return vehicle:get_mode() == c.value
+   end
+   return false
+end
+
+local function update()
+   local t = (millis() - start_ms):tofloat() * 0.001
+
+   while next_event <= #events and events[next_event].t <= t and not finished do
+      run_event(events[next_event])
+      next_event = next_event + 1
+   end
+
+   -- overrides time out, so keep refreshing them
+   for chan, pwm in pairs(overrides) do
+      rc:get_channel(chan):set_override(pwm)
+   end
+
+   -- keep trying to arm until the pre-arm checks pass
+   if arm_pending then
+      if arming:is_armed() or arming:arm() then
+         arm_pending = false
+      end
+   end
+   if arming:is_armed() then
+      was_armed = true
+   end
+
+   local loc = ahrs:get_location()
+   local home = ahrs:get_home()
+   if loc and home then
+      max_dist = math.max(max_dist, loc:get_distance(home))
+   end
+
+   for _, c in ipairs(fail_conditions) do
+      if not finished and check_condition(c) then
+         result(false, c.what)
+      end
+   end
+   -- all pass conditions must have been met, each is latched
+   local passed = #pass_conditions > 0
+   for _, c in ipairs(pass_conditions) do
+      if not c.met and check_condition(c) then
+         c.met = true
+      end
+      passed = passed and c.met
+   end
+   if not finished and passed then
+      result(true, pass_conditions[#pass_conditions].what)
+   end
+   if not finished and t > timeout_s then
+      result(false, "timeout")
+   end
+
+   if finished then
+      return
+   end
+   return update, UPDATE_MS
+end
+
+local function init()
+   start_ms = millis()
+   read_scenario("scenario.txt")
+   if mission_file then
+      load_mission(mission_file)
+   end
+   return update, UPDATE_MS
+end
+
+return init, 1000
@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+
+'''
+Run SITL scenarios in batch, as fast as the CPU allows
+
+Each scenario file describes a mission, timed RC inputs, mode changes
+and parameter changes (used to inject failures), plus the conditions
+for it to pass or fail; see batch/copter_mission_wind.scn for the
+format.  Every scenario gets its own headless SITL instance in its own
+directory with serial0 disconnected, so nothing throttles the
+simulation waiting for a GCS.  The scenario is driven from inside the
+vehicle by batch/scenario_runner.lua, and as all of its timing is in
+simulated time the result does not depend on the speedup achieved.
+
+One instance is run per core by default.  Results are printed and
+optionally written as CSV and JSON.
+
+Example:
+  ./waf configure --board sitl && ./waf copter
+  ./Tools/autotest/batch_sitl.py Tools/autotest/batch/*.scn --csv results.csv
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import concurrent.futures
+import csv
+import json
+import os
+import queue
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+BATCH_DIR = os.path.join(os.path.dirname(os.path.realpath(__file__)), "batch")
+RUNNER_SCRIPT = os.path.join(BATCH_DIR, "scenario_runner.lua")
+
+
+class Scenario(object):
+    '''the parts of a scenario file needed to start SITL'''
+    def __init__(self, filepath):
+        self.filepath = os.path.abspath(filepath)
+        self.name = os.path.splitext(os.path.basename(filepath))[0]
+        self.model = "quad"
+        self.home = "-35.363261,149.165230,584,353"
+        self.speedup = None
+        self.params = []
+        self.mission = None
+        # the scenario as passed to the Lua driver, with paths rewritten
+        self.lines = []
+
+        with open(self.filepath) as f:
+            for line in f:
+                words = line.split()
+                if len(words) == 0 or words[0].startswith("#"):
+                    self.lines.append(line)
+                    continue
+                if words[0] == "model":
+                    self.model = words[1]
+                elif words[0] == "home":
+                    self.home = words[1]
+                elif words[0] == "speedup":
+                    self.speedup = float(words[1])
+                elif words[0] == "param":
+                    self.params.append((words[1], words[2]))
+                elif words[0] == "mission":
+                    self.mission = os.path.join(os.path.dirname(self.filepath), words[1])
+                    self.lines.append("mission %s\n" % os.path.basename(self.mission))
+                else:
+                    self.lines.append(line)
+
+
+class BatchSITL(object):
+    def __init__(self, binary, defaults, speedup, timeout, keep):
+        self.binary = os.path.abspath(binary)
+        self.defaults = [os.path.abspath(x) for x in defaults.split(",")] if defaults else []
+        self.speedup = speedup
+        self.timeout = timeout
+        self.keep = keep
+
+    def progress(self, message):
+        print("PROGRESS: %s" % (message,))
+
+    def prepare(self, scenario, dirpath):
+        '''populate the working directory for one scenario'''
+        os.makedirs(os.path.join(dirpath, "scripts"))
+        shutil.copy(RUNNER_SCRIPT, os.path.join(dirpath, "scripts"))
+        if scenario.mission is not None:
+            shutil.copy(scenario.mission, dirpath)
+        with open(os.path.join(dirpath, "scenario.txt"), "w") as f:
+            f.write("".join(scenario.lines))
+        # scripting must be enabled before the first boot, so it goes
+        # in a defaults file with the scenario's own parameters
+        scenario_defaults = os.path.join(dirpath, "scenario.parm")
+        with open(scenario_defaults, "w") as f:
+            f.write("SCR_ENABLE 1\n")
+            f.write("SCR_HEAP_SIZE 200000\n")
+            f.write("LOG_DISARMED 0\n")
+            for (name, value) in scenario.params:
+                f.write("%s %s\n" % (name, value))
+        return self.defaults + [scenario_defaults]
+
+    def run_one(self, scenario, index, topdir):
+        '''run one scenario on a free instance number'''
+        # instance numbers set the TCP ports used by SITL, so reuse them
+        # rather than counting up to the number of scenarios
+        instance = self.instances.get()
+        try:
+            return self.run_instance(scenario, index, instance, topdir)
+        finally:
+            self.instances.put(instance)
+
+    def run_instance(self, scenario, index, instance, topdir):
+        '''run one scenario to completion or timeout, return a result dict'''
+        dirpath = os.path.join(topdir, "%u-%s" % (index, scenario.name))
+        defaults = self.prepare(scenario, dirpath)
+        speedup = scenario.speedup if scenario.speedup is not None else self.speedup
+        cmd = [
+            self.binary,
+            "-w",
+            "--model", scenario.model,
+            "--speedup", str(speedup),
+            "--instance", str(instance),
+            "--home", scenario.home,
+            "--serial0", "none",
+            "--defaults", ",".join(defaults),
+        ]
+        result_path = os.path.join(dirpath, "result.txt")
+        ret = {
+            "scenario": scenario.name,
+            "result": "FAIL",
+            "reason": "no result",
+            "sim_time": 0.0,
+            "max_dist": 0.0,
+            "wall_time": 0.0,
+            "speedup": 0.0,
+        }
+        start = time.time()
+        with open(os.path.join(dirpath, "sitl.log"), "w") as log:
+            p = subprocess.Popen(cmd,
+                                 cwd=dirpath,
+                                 stdin=subprocess.DEVNULL,
+                                 stdout=log,
+                                 stderr=subprocess.STDOUT,
+                                 close_fds=True)
+            try:
+                while not os.path.exists(result_path):
+                    if p.poll() is not None:
+                        ret["reason"] = "SITL exited with %d" % p.returncode
+                        break
+                    if time.time() - start > self.timeout:
+                        ret["reason"] = "wall clock timeout"
+                        break
+                    time.sleep(0.1)
+            finally:
+                p.kill()
+                p.wait()
+        ret["wall_time"] = time.time() - start
+
+        if os.path.exists(result_path):
+            with open(result_path) as f:
+                words = f.read().split(None, 3)
+            if len(words) == 4:
+                ret["result"] = words[0]
+                ret["sim_time"] = float(words[1])
+                ret["max_dist"] = float(words[2])
+                ret["reason"] = words[3].strip()
+                ret["speedup"] = ret["sim_time"] / ret["wall_time"]
+        if not self.keep and ret["result"] == "PASS":
+            shutil.rmtree(dirpath, ignore_errors=True)
+        else:
+            ret["dir"] = dirpath
+        return ret
+
+    def run(self, scenario_files, jobs):
+        scenarios = [Scenario(x) for x in scenario_files]
+        topdir = tempfile.mkdtemp(prefix="batch-sitl-")
+        self.progress("Running %u scenarios, %u at a time, in %s" % (len(scenarios), jobs, topdir))
+        self.instances = queue.Queue()
+        for i in range(jobs):
+            self.instances.put(i)
+        start = time.time()
+        results = []
+        with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as executor:
+            futures = [executor.submit(self.run_one, s, i, topdir) for (i, s) in enumerate(scenarios)]
+            for future in concurrent.futures.as_completed(futures):
+                r = future.result()
+                self.progress("%s: %s (%s) sim=%.0fs wall=%.1fs speedup=%.1f" %
+                              (r["scenario"], r["result"], r["reason"], r["sim_time"], r["wall_time"], r["speedup"]))
+                results.append(r)
+        elapsed = time.time() - start
+
+        results.sort(key=lambda r: r["scenario"])
+        passed = len([r for r in results if r["result"] == "PASS"])
+        print("")
+        print("%-32s %6s %10s %10s %8s  %s" % ("scenario", "result", "sim-time", "wall-time", "speedup", "reason"))
+        for r in results:
+            print("%-32s %6s %10.1f %10.1f %8.1f  %s" %
+                  (r["scenario"], r["result"], r["sim_time"], r["wall_time"], r["speedup"], r["reason"]))
+        print("")
+        print("%u/%u passed in %.1fs, %.0f scenarios/hour" %
+              (passed, len(results), elapsed, 3600.0 * len(results) / elapsed))
+        if passed != len(results) and not self.keep:
+            print("Working directories of failed scenarios kept in %s" % topdir)
+        elif not self.keep:
+            shutil.rmtree(topdir, ignore_errors=True)
+        return results
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("scenarios", nargs="+", help="scenario files to run")
+    parser.add_argument("--binary", default="build/sitl/bin/arducopter", help="SITL binary to run")
+    parser.add_argument("--defaults", default="Tools/autotest/default_params/copter.parm",
+                        help="comma separated list of defaults files")
+    parser.add_argument("--speedup", type=float, default=1000,
+                        help="requested speedup; high values run as fast as the CPU allows")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count(), help="number of scenarios run at once")
+    parser.add_argument("--timeout", type=float, default=600, help="wall clock timeout per scenario in seconds")
+    parser.add_argument("--csv", default=None, help="write results to this CSV file")
+    parser.add_argument("--json", default=None, help="write results to this JSON file")
+    parser.add_argument("--keep", action="store_true", help="keep the working directories of all scenarios")
+    args = parser.parse_args()
+
+    results = BatchSITL(
+        binary=args.binary,
+        defaults=args.defaults,
+        speedup=args.speedup,
+        timeout=args.timeout,
+        keep=args.keep,
+    ).run(args.scenarios, args.jobs)
+
+    fields = ["scenario", "result", "reason", "sim_time", "max_dist", "wall_time", "speedup"]
+    if args.csv is not None:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+            writer.writeheader()
+            writer.writerows(results)
+    if args.json is not None:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+
+    if len([r for r in results if r["result"] != "PASS"]) > 0:
+        sys.exit(1)
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+
+'''
+Measure how many SITL vehicles a machine can run at a given speedup
+
+Starts an increasing number of headless SITL instances, each with its
+own MAV_SYSID.  The MAVLink output of each group of instances is
+multiplexed onto a single UDP port, so no per-vehicle TCP connection
+or MAVProxy is needed.  Each instance reports the speedup it actually
+achieves; from that we print the aggregate simulated seconds per wall
+clock second per core, i.e. vehicles per core at real time.
+
+Example:
+  ./waf configure --board sitl && ./waf copter
+  ./Tools/autotest/swarm_scaling.py --counts 1,10,50,100 --speedup 10
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import os
+import re
+import select
+import shutil
+import socket
+import subprocess
+import tempfile
+import time
+
+
+class SwarmScaling(object):
+    def __init__(self, binary, model, defaults, home, speedup, duration, group_size, base_port):
+        self.binary = os.path.abspath(binary)
+        self.model = model
+        self.defaults = [os.path.abspath(x) for x in defaults.split(",")] if defaults else []
+        self.home = home
+        self.speedup = speedup
+        self.duration = duration
+        self.group_size = group_size
+        self.base_port = base_port
+
+    def progress(self, message):
+        print("PROGRESS: %s" % (message,))
+
+    def start_instance(self, instance, topdir):
+        '''start one SITL instance in its own directory'''
+        dirpath = os.path.join(topdir, "i%u" % instance)
+        os.makedirs(dirpath)
+        port = self.base_port + instance // self.group_size
+        cmd = [
+            self.binary,
+            "-w",
+            "--model", self.model,
+            "--speedup", str(self.speedup),
+            "--speedup-report",
+            "--instance", str(instance),
+            "--sysid", str(instance + 1),
+            "--home", self.home,
+            "--serial0", "udpclient:127.0.0.1:%u" % port,
+        ]
+        if self.defaults:
+            cmd.extend(["--defaults", ",".join(self.defaults)])
+        return subprocess.Popen(cmd,
+                                cwd=dirpath,
+                                stdin=subprocess.DEVNULL,
+                                stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT,
+                                close_fds=True)
+
+    def run_count(self, count):
+        '''run count instances for the configured duration, return per-instance achieved speedup'''
+        topdir = tempfile.mkdtemp(prefix="swarm-scaling-")
+        ngroups = (count + self.group_size - 1) // self.group_size
+        socks = []
+        for i in range(ngroups):
+            s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            s.bind(("127.0.0.1", self.base_port + i))
+            s.setblocking(False)
+            socks.append(s)
+
+        procs = [self.start_instance(i, topdir) for i in range(count)]
+        achieved = {}
+        packets = 0
+        speedup_re = re.compile(r"SITL(\d+): speedup ([\d.]+)/")
+        fd_to_proc = {p.stdout.fileno(): p for p in procs}
+        start_cpu = os.times()
+        deadline = time.time() + self.duration
+        try:
+            while time.time() < deadline:
+                readable, _, _ = select.select(list(fd_to_proc.keys()) + socks, [], [], 0.5)
+                for r in readable:
+                    if r in socks:
+                        # drain the multiplexed MAVLink traffic so the senders never block
+                        try:
+                            while True:
+                                r.recv(65536)
+                                packets += 1
+                        except BlockingIOError:
+                            pass
+                        continue
+                    line = fd_to_proc[r].stdout.readline()
+                    if not line:
+                        del fd_to_proc[r]
+                        continue
+                    m = speedup_re.search(line.decode("utf-8", errors="replace"))
+                    if m is not None:
+                        achieved[int(m.group(1))] = float(m.group(2))
+        finally:
+            for p in procs:
+                p.kill()
+            for p in procs:
+                p.wait()
+            # child CPU times are only accounted once they have been waited for
+            end_cpu = os.times()
+            for s in socks:
+                s.close()
+            shutil.rmtree(topdir, ignore_errors=True)
+
+        cpu_s = (end_cpu.children_user + end_cpu.children_system -
+                 start_cpu.children_user - start_cpu.children_system)
+        return achieved, packets, cpu_s
+
+    def run(self, counts):
+        ncores = os.cpu_count()
+        results = []
+        for count in counts:
+            self.progress("Running %u instances at speedup %.1f for %us" % (count, self.speedup, self.duration))
+            achieved, packets, cpu_s = self.run_count(count)
+            if len(achieved) < count:
+                self.progress("Only %u/%u instances reported a speedup; increase --duration" %
+                              (len(achieved), count))
+            cpu_util = 100.0 * cpu_s / (self.duration * ncores)
+            if len(achieved) == 0:
+                results.append((count, 0, 0, 0, cpu_util, packets))
+                continue
+            mean = sum(achieved.values()) / len(achieved)
+            worst = min(achieved.values())
+            # simulated vehicle-seconds per wall-second per core
+            per_core = sum(achieved.values()) / ncores
+            results.append((count, mean, worst, per_core, cpu_util, packets))
+
+        print("")
+        print("%8s %10s %10s %16s %8s %10s" % ("vehicles", "mean", "worst", "vehicles/core", "cpu%", "mav-pkts"))
+        for (count, mean, worst, per_core, cpu_util, packets) in results:
+            print("%8u %10.2f %10.2f %16.2f %8.1f %10u" % (count, mean, worst, per_core, cpu_util, packets))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", default="build/sitl/bin/arducopter", help="SITL binary to run")
+    parser.add_argument("--model", default="quad", help="simulation model")
+    parser.add_argument("--defaults", default="Tools/autotest/default_params/copter.parm",
+                        help="comma separated list of defaults files")
+    parser.add_argument("--home", default="-35.363261,149.165230,584,353", help="start location")
+    parser.add_argument("--speedup", type=float, default=10, help="requested speedup of every instance")
+    parser.add_argument("--duration", type=int, default=75,
+                        help="wall clock seconds to run each count for; instances report every 30s")
+    parser.add_argument("--counts", default="1,5,10,25,50", help="comma separated instance counts to measure")
+    parser.add_argument("--group-size", type=int, default=25,
+                        help="number of instances sharing one UDP MAVLink port")
+    parser.add_argument("--base-port", type=int, default=15550, help="first UDP port for MAVLink groups")
+    args = parser.parse_args()
+
+    SwarmScaling(
+        binary=args.binary,
+        model=args.model,
+        defaults=args.defaults,
+        home=args.home,
+        speedup=args.speedup,
+        duration=args.duration,
+        group_size=args.group_size,
+        base_port=args.base_port,
+    ).run([int(x) for x in args.counts.split(",")])
@@ -219,6 +219,7 @@ void AC_Avoid::adjust_velocity(Vector3f &desired_vel_cms, bool &backing_up, floa
         // Store velocity needed to back away from physical obstacles
         Vector3f backup_vel_proximity;
         adjust_velocity_proximity(kP, accel_cmss_limited, desired_vel_cms, backup_vel_proximity, kP_z,accel_cmss_z, dt);
+        adjust_velocity_pointcloud(kP, accel_cmss_limited, desired_vel_cms, kP_z, accel_cmss_z, dt);
         find_max_quadrant_velocity_3D(backup_vel_proximity, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel, back_vel_up, back_vel_down);
     }
     
@@ -1331,6 +1332,49 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 #endif // HAL_PROXIMITY_ENABLED
 }
 
+/*
+ * Adjusts the desired velocity for the nearest proximity point cloud obstacle along the direction of travel
+ */
+void AC_Avoid::adjust_velocity_pointcloud(float kP, float accel_cmss, Vector3f &desired_vel_cms, float kP_z, float accel_cmss_z, float dt)
+{
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    if (desired_vel_cms.is_zero()) {
+        // nothing to limit
+        return;
+    }
+
+    AP_Proximity *proximity = AP::proximity();
+    if (!proximity) {
+        return;
+    }
+
+    Vector3f current_pos;
+    if (!AP::ahrs().get_relative_position_NED_origin_float(current_pos)) {
+        return;
+    }
+
+    // point cloud is NED in meters, desired velocity is NEU in cm/s
+    const Vector3f vel_ned{desired_vel_cms.x, desired_vel_cms.y, -desired_vel_cms.z};
+    const float speed_cms = vel_ned.length();
+    const float margin_cm = MAX(_margin * 100.0f, 0.0f);
+
+    // only obstacles we could reach before stopping matter, the search
+    // tube is widened by a voxel so near misses are still caught
+    const float look_ahead_m = (margin_cm + get_stopping_distance(kP, accel_cmss, speed_cms)) * 0.01f + AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M;
+    const float radius_m = margin_cm * 0.01f + AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M;
+    float dist_m;
+    Vector3f obstacle_ned;
+    if (!proximity->pointcloud.closest_along(current_pos, vel_ned / speed_cms, look_ahead_m, radius_m, dist_m, obstacle_ned)) {
+        return;
+    }
+
+    // vector to the obstacle in NEU cm, same frame as the velocity
+    const Vector3f rel_ned = obstacle_ned - current_pos;
+    const Vector3f obstacle_neu_cm{rel_ned.x * 100.0f, rel_ned.y * 100.0f, -rel_ned.z * 100.0f};
+    limit_velocity_3D(kP, accel_cmss, desired_vel_cms, obstacle_neu_cm, margin_cm, kP_z, accel_cmss_z, dt);
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
+}
+
 /*
  * Adjusts the desired velocity for the polygon fence.
  */
@@ -147,6 +147,11 @@ private:
      */
     void adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &desired_vel_cms, Vector3f &backup_vel, float kP_z, float accel_cmss_z, float dt);
 
+    /*
+     * Adjusts the desired velocity for the nearest proximity point cloud obstacle along the direction of travel
+     */
+    void adjust_velocity_pointcloud(float kP, float accel_cmss, Vector3f &desired_vel_cms, float kP_z, float accel_cmss_z, float dt);
+
     /*
      * Adjusts the desired velocity given an array of boundary points
      * The boundary must be in Earth Frame
@@ -164,22 +164,9 @@ void AP_OADatabase::queue_push(const Vector3f &pos, const uint32_t timestamp_ms,
     }
 
     // check if this obstacle needs to be rejected from DB because of low altitude near home
-#if APM_BUILD_COPTER_OR_HELI
-    if (!is_zero(_min_alt)) { 
-        Vector3f current_pos;
-        if (!AP::ahrs().get_relative_position_NED_home(current_pos)) {
-            // we do not know where the vehicle is
-            return;
-        }
-        if (current_pos.xy().length() < AP_OADATABASE_DISTANCE_FROM_HOME) {
-            // vehicle is within a small radius of home 
-            if (-current_pos.z < _min_alt) {
-                // vehicle is below the minimum alt
-                return;
-            }
-        }
+    if (reject_near_home()) {
+        return;
     }
-#endif
 
     // Apply min radius parameter
     radius = MAX(_radius_min, radius);
@@ -199,6 +186,54 @@ void AP_OADatabase::queue_push(const Vector3f &pos, const uint32_t timestamp_ms,
     }
 }
 
+// Push several objects measured from vehicle_pos at the same time, taking the queue lock once. All positions are offsets in meters from the EKF origin
+void AP_OADatabase::queue_push(const Vector3f *pos, uint16_t count, const Vector3f &vehicle_pos, const uint32_t timestamp_ms, const OA_DbItem::Source source)
+{
+    if (!healthy() || count == 0) {
+        return;
+    }
+
+    if (reject_near_home()) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_queue.sem);
+    for (uint16_t i = 0; i < count; i++) {
+        const float distance = (pos[i] - vehicle_pos).length();
+        const float radius = MAX(_radius_min, distance * dist_to_radius_scalar);
+
+        // ignore objects that outside of the max distance
+        if (is_positive(_dist_max) && (distance - radius) > _dist_max) {
+            continue;
+        }
+
+        const OA_DbItem item = {pos[i], timestamp_ms, radius, 0, 0, AP_OADatabase::OA_DbItemImportance::Normal, source};
+        _queue.items->push(item);
+    }
+}
+
+// returns true if pushed obstacles should be rejected because the vehicle is low and close to home
+bool AP_OADatabase::reject_near_home() const
+{
+#if APM_BUILD_COPTER_OR_HELI
+    if (!is_zero(_min_alt)) {
+        Vector3f current_pos;
+        if (!AP::ahrs().get_relative_position_NED_home(current_pos)) {
+            // we do not know where the vehicle is
+            return true;
+        }
+        if (current_pos.xy().length() < AP_OADATABASE_DISTANCE_FROM_HOME) {
+            // vehicle is within a small radius of home
+            if (-current_pos.z < _min_alt) {
+                // vehicle is below the minimum alt
+                return true;
+            }
+        }
+    }
+#endif
+    return false;
+}
+
 void AP_OADatabase::init_queue()
 {
     _queue.size = _queue_size_param;
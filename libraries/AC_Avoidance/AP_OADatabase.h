@@ -51,6 +51,8 @@ public:
     // Push an object into the database. Pos is the offset in meters from the EKF origin, measurement timestamp in ms, distance in meters, optional radius in meters
     void queue_push(const Vector3f &pos, const uint32_t timestamp_ms, const float distance, float radius, const OA_DbItem::Source source, const uint32_t id = 0);
     void queue_push(const Vector3f &pos, const uint32_t timestamp_ms, const float distance, const OA_DbItem::Source source, const uint32_t id = 0);
+    // Push several objects measured from vehicle_pos at the same time, taking the queue lock once. All positions are offsets in meters from the EKF origin
+    void queue_push(const Vector3f *pos, uint16_t count, const Vector3f &vehicle_pos, const uint32_t timestamp_ms, const OA_DbItem::Source source);
 
     // returns true if database is healthy
     bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr); }
@@ -78,6 +80,9 @@ private:
     // database item management
     void database_item_add(const OA_DbItem &item);
     void database_item_refresh(OA_DbItem &current_item, const OA_DbItem &new_item) const;
+
+    // returns true if pushed obstacles should be rejected because the vehicle is low and close to home
+    bool reject_near_home() const;
     void database_item_remove(const uint16_t index);
     void database_items_remove_all_expired();
 
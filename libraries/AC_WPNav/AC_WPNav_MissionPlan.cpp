@@ -0,0 +1,405 @@
+#include "AC_WPNav_MissionPlan.h"
+
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Logger/AP_Logger.h>
+#include "AC_WPNav.h"
+
+// mission commands read per call to update()
+#define MISSION_PLAN_COMMANDS_PER_UPDATE 20
+
+// compile part of the mission, should be called at a low rate
+void AC_WPNav_MissionPlan::update(const AC_WPNav &wp_nav)
+{
+    const Limits limits {
+        wp_nav.get_default_speed_NE_cms(),
+        wp_nav.get_default_speed_up_cms(),
+        wp_nav.get_default_speed_down_cms(),
+        wp_nav.get_wp_acceleration_cmss(),
+        wp_nav.get_accel_U_cmss(),
+        wp_nav.get_corner_acceleration_cmss(),
+        wp_nav.get_wp_radius_cm(),
+    };
+
+    // positions are planned relative to the EKF origin
+    Location origin;
+    if (!AP::ahrs().get_origin(origin)) {
+        return;
+    }
+
+    if (_restart_needed || _change_ms != _mission.last_change_time_ms() || memcmp(&limits, &_limits, sizeof(limits)) != 0) {
+        _restart_needed = false;
+        _change_ms = _mission.last_change_time_ms();
+        _limits = limits;
+        restart();
+    }
+
+    if (_state != State::COMPILING) {
+        return;
+    }
+
+    const uint32_t start_us = AP_HAL::micros();
+    const uint16_t num_commands = _mission.num_commands();
+    for (uint8_t i = 0; i < MISSION_PLAN_COMMANDS_PER_UPDATE; i++) {
+        AP_Mission::Mission_Command cmd;
+        if (_read_index >= num_commands || !_mission.read_cmd_from_storage(_read_index, cmd)) {
+            finish();
+            break;
+        }
+        _read_index++;
+        if (!add_command(cmd)) {
+            finish();
+            break;
+        }
+    }
+    _compile_us += AP_HAL::micros() - start_us;
+
+#if HAL_LOGGING_ENABLED
+    if (_state == State::READY) {
+        write_log(0, _time_s);
+    }
+#endif
+}
+
+// discard the plan and free its memory, it is compiled again from
+// the start on the next update()
+void AC_WPNav_MissionPlan::reset()
+{
+    if (_restart_needed) {
+        return;
+    }
+    delete[] _legs;
+    _legs = nullptr;
+    _legs_size = 0;
+    _num_legs = 0;
+    _state = State::IDLE;
+    _restart_needed = true;
+}
+
+// restart compiling from the start of the mission
+void AC_WPNav_MissionPlan::restart()
+{
+    _num_legs = 0;
+    _read_index = 0;
+    _have_prev_pos = false;
+    _stopped = true;
+    _length_cm = 0;
+    _time_s = 0;
+    _compile_us = 0;
+    _speed_ne_cms = _limits.speed_ne_cms;
+    _speed_up_cms = _limits.speed_up_cms;
+    _speed_down_cms = _limits.speed_down_cms;
+    _state = State::IDLE;
+
+    if (!_mission.present()) {
+        return;
+    }
+
+    // each command adds at most one leg
+    const uint16_t legs_needed = MIN(_mission.num_commands(), uint16_t(AC_WPNAV_MISSION_PLAN_LEGS_MAX));
+    if (_legs_size < legs_needed) {
+        delete[] _legs;
+        _legs = NEW_NOTHROW Leg[legs_needed];
+        _legs_size = (_legs != nullptr) ? legs_needed : 0;
+    }
+    if (_legs == nullptr) {
+        return;
+    }
+
+    _state = State::COMPILING;
+}
+
+// position of a command location in cm from the EKF origin, using
+// the previous destination for a missing position or altitude the
+// way the vehicle does. returns false if it can not be planned
+bool AC_WPNav_MissionPlan::get_position_NEU_cm(const Location &loc, Vector3f &pos_neu) const
+{
+    // terrain following depends on terrain data along the way
+    if (loc.get_alt_frame() == Location::AltFrame::ABOVE_TERRAIN) {
+        return false;
+    }
+    if (!loc.get_vector_from_origin_NEU_cm(pos_neu)) {
+        return false;
+    }
+    if (loc.lat == 0 && loc.lng == 0) {
+        if (!_have_prev_pos) {
+            return false;
+        }
+        pos_neu.x = _prev_pos_neu.x;
+        pos_neu.y = _prev_pos_neu.y;
+    }
+    if (loc.alt == 0) {
+        if (!_have_prev_pos) {
+            return false;
+        }
+        pos_neu.z = _prev_pos_neu.z;
+    }
+    return true;
+}
+
+// add the destination of a mission command to the plan.
+// returns false if the plan can not be continued past this command
+bool AC_WPNav_MissionPlan::add_command(const AP_Mission::Mission_Command &cmd)
+{
+    Vector3f pos_neu;
+
+    if (cmd.index == 0) {
+        // home, the plan starts from here if it is set
+        if (get_position_NEU_cm(cmd.content.location, pos_neu)) {
+            _prev_pos_neu = pos_neu;
+            _have_prev_pos = true;
+        }
+        return true;
+    }
+
+    switch (cmd.id) {
+    case MAV_CMD_NAV_WAYPOINT:
+    case MAV_CMD_NAV_SPLINE_WAYPOINT:
+        // splines are planned along their chord.  p1 is the delay in seconds
+        if (!get_position_NEU_cm(cmd.content.location, pos_neu)) {
+            return false;
+        }
+        return add_leg(cmd.index, pos_neu, cmd.p1 > 0, cmd.p1);
+
+    case MAV_CMD_NAV_TAKEOFF:
+    case MAV_CMD_NAV_LOITER_TIME:
+        // stop at the destination, loiter time is held in p1
+        if (!get_position_NEU_cm(cmd.content.location, pos_neu)) {
+            return false;
+        }
+        return add_leg(cmd.index, pos_neu, true, (cmd.id == MAV_CMD_NAV_LOITER_TIME) ? cmd.p1 : 0);
+
+    case MAV_CMD_NAV_LAND:
+        // fly to the landing point, the descent is not planned
+        if (get_position_NEU_cm(cmd.content.location, pos_neu)) {
+            pos_neu.z = _prev_pos_neu.z;
+            add_leg(cmd.index, pos_neu, true, 0);
+        }
+        return false;
+
+    case MAV_CMD_DO_CHANGE_SPEED:
+        if (cmd.content.speed.target_ms > 0) {
+            switch (cmd.content.speed.speed_type) {
+            case SPEED_TYPE_CLIMB_SPEED:
+                _speed_up_cms = cmd.content.speed.target_ms * 100.0f;
+                break;
+            case SPEED_TYPE_DESCENT_SPEED:
+                _speed_down_cms = cmd.content.speed.target_ms * 100.0f;
+                break;
+            case SPEED_TYPE_AIRSPEED:
+            case SPEED_TYPE_GROUNDSPEED:
+                _speed_ne_cms = cmd.content.speed.target_ms * 100.0f;
+                break;
+            }
+        }
+        return true;
+
+    case MAV_CMD_DO_JUMP:
+    case MAV_CMD_DO_JUMP_TAG:
+        // following a jump would need the jump counters
+        return false;
+
+    default:
+        // any other navigation command ends the plan
+        return !AP_Mission::is_nav_cmd(cmd);
+    }
+}
+
+// add a leg from the previous destination to dest_neu, stopping at
+// the end of it if stop is true.
+// returns false if the plan can not be continued past this leg
+bool AC_WPNav_MissionPlan::add_leg(uint16_t cmd_index, const Vector3f &dest_neu, bool stop, float delay_s)
+{
+    if (!_have_prev_pos) {
+        // the first destination is where the plan starts
+        _prev_pos_neu = dest_neu;
+        _have_prev_pos = true;
+        _stopped = true;
+        return true;
+    }
+    if (_num_legs >= _legs_size) {
+        return false;
+    }
+
+    Leg &leg = _legs[_num_legs];
+    Vector3f dir = dest_neu - _prev_pos_neu;
+    leg.cmd_index = cmd_index;
+    leg.length_cm = dir.length();
+    leg.delay_s = delay_s;
+
+    if (is_positive(leg.length_cm)) {
+        dir /= leg.length_cm;
+        leg.speed_cms = kinematic_limit(dir, _speed_ne_cms, _speed_up_cms, _speed_down_cms);
+        leg.accel_cmss = kinematic_limit(dir, _limits.accel_ne_cmss, _limits.accel_u_cmss, _limits.accel_u_cmss);
+        if (!is_positive(leg.speed_cms) || !is_positive(leg.accel_cmss)) {
+            return false;
+        }
+    } else {
+        // the vehicle stops at a repeated waypoint
+        dir = _prev_dir;
+        leg.speed_cms = 0;
+        leg.accel_cmss = _limits.accel_ne_cmss;
+        stop = true;
+    }
+    leg.exit_speed_cms = stop ? 0 : leg.speed_cms;
+
+    // limit the speed through the previous waypoint to the speed the
+    // corner can be flown at within the waypoint radius.  A turn of
+    // angle t flown as an arc that passes radius_cm from the waypoint
+    // has a radius of radius_cm * cos(t/2) / (1 - cos(t/2))
+    if (_num_legs > 0 && !_stopped) {
+        Leg &prev = _legs[_num_legs-1];
+        const float cos_half_turn = safe_sqrt(0.5f * (1.0f + constrain_float(_prev_dir * dir, -1.0f, 1.0f)));
+        float corner_speed_cms = leg.speed_cms;
+        if (1.0f - cos_half_turn > FLT_EPSILON) {
+            const float turn_radius_cm = _limits.radius_cm * cos_half_turn / (1.0f - cos_half_turn);
+            corner_speed_cms = MIN(corner_speed_cms, safe_sqrt(_limits.accel_corner_cmss * turn_radius_cm));
+        }
+        prev.exit_speed_cms = MIN(prev.exit_speed_cms, corner_speed_cms);
+    }
+
+    _prev_pos_neu = dest_neu;
+    _prev_dir = dir;
+    _stopped = stop;
+    _num_legs++;
+    return true;
+}
+
+// make exit speeds consistent and calculate times once all legs are added
+void AC_WPNav_MissionPlan::finish()
+{
+    _state = State::READY;
+    if (_num_legs == 0) {
+        return;
+    }
+
+    // the plan ends stopped
+    _legs[_num_legs-1].exit_speed_cms = 0;
+
+    // no leg may leave faster than the next leg can brake from
+    for (int16_t i = _num_legs - 2; i >= 0; i--) {
+        const Leg &next = _legs[i+1];
+        _legs[i].exit_speed_cms = MIN(_legs[i].exit_speed_cms, safe_sqrt(sq(next.exit_speed_cms) + 2.0f * next.accel_cmss * next.length_cm));
+    }
+
+    // or faster than it can accelerate to from its entry speed
+    float entry_speed_cms = 0;
+    for (uint16_t i = 0; i < _num_legs; i++) {
+        Leg &leg = _legs[i];
+        leg.exit_speed_cms = MIN(leg.exit_speed_cms, safe_sqrt(sq(entry_speed_cms) + 2.0f * leg.accel_cmss * leg.length_cm));
+        entry_speed_cms = leg.exit_speed_cms;
+        _length_cm += leg.length_cm;
+    }
+
+    // accumulate times from the end of the plan
+    _time_s = 0;
+    for (int16_t i = _num_legs - 1; i >= 0; i--) {
+        Leg &leg = _legs[i];
+        _time_s += leg.delay_s;
+        leg.time_to_end_s = _time_s;
+        _time_s += leg_time_s(leg, (i > 0) ? _legs[i-1].exit_speed_cms : 0, leg.exit_speed_cms);
+    }
+}
+
+// time to fly a leg entering at speed v0 and leaving at v1
+float AC_WPNav_MissionPlan::leg_time_s(const Leg &leg, float v0, float v1)
+{
+    if (!is_positive(leg.length_cm)) {
+        return 0;
+    }
+    const float a = leg.accel_cmss;
+    const float vmax = leg.speed_cms;
+
+    // distances to accelerate to and brake from cruise speed
+    const float accel_dist_cm = (sq(vmax) - sq(v0)) / (2.0f * a);
+    const float decel_dist_cm = (sq(vmax) - sq(v1)) / (2.0f * a);
+    if (accel_dist_cm + decel_dist_cm <= leg.length_cm) {
+        return (2.0f * vmax - v0 - v1) / a + (leg.length_cm - accel_dist_cm - decel_dist_cm) / vmax;
+    }
+
+    // too short to reach cruise speed
+    const float vpeak = safe_sqrt(0.5f * (2.0f * a * leg.length_cm + sq(v0) + sq(v1)));
+    return (2.0f * vpeak - v0 - v1) / a;
+}
+
+// index of the leg ending at cmd_index, -1 if none
+int16_t AC_WPNav_MissionPlan::find_leg(uint16_t cmd_index) const
+{
+    // legs are in mission order
+    int16_t low = 0;
+    int16_t high = int16_t(_num_legs) - 1;
+    while (low <= high) {
+        const int16_t mid = (low + high) / 2;
+        if (_legs[mid].cmd_index == cmd_index) {
+            return mid;
+        }
+        if (_legs[mid].cmd_index < cmd_index) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// estimated time in seconds to complete the plan from a point
+// dist_to_dest_cm before the end of the leg ending at cmd_index.
+// returns false if the plan is not ready or does not contain the leg
+bool AC_WPNav_MissionPlan::get_time_remaining_s(uint16_t cmd_index, float dist_to_dest_cm, float &time_s) const
+{
+    if (_state != State::READY) {
+        return false;
+    }
+    const int16_t i = find_leg(cmd_index);
+    if (i < 0) {
+        return false;
+    }
+    const Leg &leg = _legs[i];
+    float leg_fraction = 0;
+    if (is_positive(leg.length_cm)) {
+        leg_fraction = constrain_float(dist_to_dest_cm / leg.length_cm, 0.0f, 1.0f);
+    }
+    time_s = leg.time_to_end_s + leg_fraction * leg_time_s(leg, (i > 0) ? _legs[i-1].exit_speed_cms : 0, leg.exit_speed_cms);
+    return true;
+}
+
+#if HAL_LOGGING_ENABLED
+// log the plan and the time remaining from the leg ending at cmd_index
+void AC_WPNav_MissionPlan::log_time_remaining(uint16_t cmd_index, float dist_to_dest_cm) const
+{
+    float time_remaining_s;
+    if (get_time_remaining_s(cmd_index, dist_to_dest_cm, time_remaining_s)) {
+        write_log(cmd_index, time_remaining_s);
+    }
+}
+
+void AC_WPNav_MissionPlan::write_log(uint16_t cmd_index, float time_remaining_s) const
+{
+// @LoggerMessage: MPLN
+// @Description: Whole mission time to complete estimate
+// @Field: TimeUS: Time since system startup
+// @Field: Idx: mission command the time remaining is measured from, 0 when the plan is compiled
+// @Field: Legs: number of legs in the plan
+// @Field: Len: total length of the plan
+// @Field: Tot: total time to fly the plan
+// @Field: Rem: time remaining to the end of the plan
+// @Field: CUs: time spent compiling the plan
+    AP::logger().WriteStreaming(
+        "MPLN",
+        "TimeUS,Idx,Legs,Len,Tot,Rem,CUs",
+        "s--msss",
+        "F--000F",
+        "QHHfffI",
+        AP_HAL::micros64(),
+        cmd_index,
+        _num_legs,
+        _length_cm * 0.01f,
+        _time_s,
+        time_remaining_s,
+        _compile_us);
+}
+#endif // HAL_LOGGING_ENABLED
+
+#endif // AC_WPNAV_MISSION_PLAN_ENABLED
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "AC_WPNav_config.h"
+
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Mission/AP_Mission.h>
+
+class AC_WPNav;
+
+/*
+  Whole mission time to complete estimator.
+
+  The loaded mission is compiled in the background into a list of
+  straight legs between consecutive waypoints. Each leg is given a
+  cruise speed from the waypoint speed limits, an exit speed limited by
+  the corner with the following leg, and the exit speeds are then made
+  consistent over the whole mission with a backward and a forward pass
+  so no leg is planned to arrive faster than the legs after it can
+  brake. The result gives the time to complete the mission from any
+  point along it.
+
+  The plan is only used for the estimate. AC_WPNav still builds its
+  SCurve and spline legs as each waypoint becomes active and blends the
+  corners itself, so the flown trajectory does not depend on it.
+
+  Compiling is time sliced so a large mission costs a bounded number of
+  command reads per call, and it restarts whenever the mission or the
+  waypoint navigation limits change. Callers should only update the
+  plan while it is needed and reset() it otherwise, so no memory is
+  held for it the rest of the time. The plan covers the mission up to
+  the first command it can not follow without flying it (DO_JUMP,
+  terrain relative altitudes, loiter, land, RTL etc).
+ */
+class AC_WPNav_MissionPlan
+{
+public:
+    AC_WPNav_MissionPlan(AP_Mission &mission) :
+        _mission(mission)
+    {}
+
+    CLASS_NO_COPY(AC_WPNav_MissionPlan);
+
+    // compile part of the mission, should be called at a low rate
+    void update(const AC_WPNav &wp_nav);
+
+    // discard the plan and free its memory, it is compiled again from
+    // the start on the next update()
+    void reset();
+
+    // true once the whole mission has been compiled
+    bool ready() const { return _state == State::READY; }
+
+    // estimated time in seconds to complete the plan from a point
+    // dist_to_dest_cm before the end of the leg ending at cmd_index.
+    // returns false if the plan is not ready or does not contain the leg
+    bool get_time_remaining_s(uint16_t cmd_index, float dist_to_dest_cm, float &time_s) const;
+
+#if HAL_LOGGING_ENABLED
+    // log the plan and the time remaining from the leg ending at cmd_index
+    void log_time_remaining(uint16_t cmd_index, float dist_to_dest_cm) const;
+#endif
+
+private:
+
+    friend class AC_WPNav_MissionPlanTest;
+
+    enum class State : uint8_t {
+        IDLE,       // nothing to compile
+        COMPILING,  // reading mission commands
+        READY,      // plan complete
+    };
+
+    struct Leg {
+        uint16_t cmd_index;     // mission command at the end of this leg
+        float length_cm;        // straight line length
+        float speed_cms;        // cruise speed limit along the leg
+        float accel_cmss;       // acceleration limit along the leg
+        float exit_speed_cms;   // speed at the end of the leg
+        float delay_s;          // time stopped at the end of the leg
+        float time_to_end_s;    // time from the end of this leg, including its delay, to the end of the plan
+    };
+
+    // waypoint navigation limits the plan was compiled with
+    struct Limits {
+        float speed_ne_cms;
+        float speed_up_cms;
+        float speed_down_cms;
+        float accel_ne_cmss;
+        float accel_u_cmss;
+        float accel_corner_cmss;
+        float radius_cm;
+    };
+
+    // restart compiling from the start of the mission
+    void restart();
+
+    // add the destination of a mission command to the plan.
+    // returns false if the plan can not be continued past this command
+    bool add_command(const AP_Mission::Mission_Command &cmd);
+
+    // position of a command location in cm from the EKF origin, using
+    // the previous destination for a missing position or altitude the
+    // way the vehicle does. returns false if it can not be planned
+    bool get_position_NEU_cm(const Location &loc, Vector3f &pos_neu) const;
+
+    // add a leg from the previous destination to dest_neu, stopping at
+    // the end of it if stop is true.
+    // returns false if the plan can not be continued past this leg
+    bool add_leg(uint16_t cmd_index, const Vector3f &dest_neu, bool stop, float delay_s);
+
+    // make exit speeds consistent and calculate times once all legs are added
+    void finish();
+
+    // time to fly a leg entering at speed v0 and leaving at v1
+    static float leg_time_s(const Leg &leg, float v0, float v1);
+
+    // index of the leg ending at cmd_index, -1 if none
+    int16_t find_leg(uint16_t cmd_index) const;
+
+#if HAL_LOGGING_ENABLED
+    void write_log(uint16_t cmd_index, float time_remaining_s) const;
+#endif
+
+    AP_Mission &_mission;
+
+    Leg *_legs = nullptr;       // compiled legs in mission order, allocated on first use
+    uint16_t _legs_size;        // size of the _legs array
+    uint16_t _num_legs;         // number of compiled legs
+
+    State _state = State::IDLE;
+    bool _restart_needed = true; // compile from the start on the next update
+    uint16_t _read_index;       // next mission command to read
+    uint32_t _change_ms;        // mission change time the plan was compiled from
+    Limits _limits;             // limits the plan was compiled with
+    float _speed_ne_cms;        // horizontal speed after the DO_CHANGE_SPEED commands read so far
+    float _speed_up_cms;        // climb speed after the DO_CHANGE_SPEED commands read so far
+    float _speed_down_cms;      // descent speed after the DO_CHANGE_SPEED commands read so far
+
+    Vector3f _prev_pos_neu;     // end of the previous leg, cm from the EKF origin
+    Vector3f _prev_dir;         // unit direction of the previous leg
+    bool _have_prev_pos;        // true if _prev_pos_neu is valid
+    bool _stopped;              // true if the vehicle stops at the end of the previous leg
+
+    float _length_cm;           // total length of the plan
+    float _time_s;              // total time of the plan
+    uint32_t _compile_us;       // time spent compiling
+};
+
+#endif // AC_WPNAV_MISSION_PLAN_ENABLED
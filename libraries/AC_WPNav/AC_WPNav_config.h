@@ -5,3 +5,14 @@
 #ifndef AC_WPNAV_OA_ENABLED
 #define AC_WPNAV_OA_ENABLED AP_OAPATHPLANNER_ENABLED
 #endif
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Mission/AP_Mission_config.h>
+
+#ifndef AC_WPNAV_MISSION_PLAN_ENABLED
+#define AC_WPNAV_MISSION_PLAN_ENABLED (AP_MISSION_ENABLED && HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
+
+#ifndef AC_WPNAV_MISSION_PLAN_LEGS_MAX
+#define AC_WPNAV_MISSION_PLAN_LEGS_MAX 500  // most legs compiled from a mission
+#endif
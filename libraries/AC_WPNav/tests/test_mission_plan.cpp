@@ -0,0 +1,158 @@
+#include <AP_gtest.h>
+
+#include <AC_WPNav/AC_WPNav_MissionPlan.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AC_WPNAV_MISSION_PLAN_ENABLED
+
+static AP_Mission mission{
+    AP_Mission::mission_cmd_fn_t(),
+    AP_Mission::mission_cmd_fn_t(),
+    AP_Mission::mission_complete_fn_t()};
+
+/*
+  the plan is built leg by leg here rather than read from mission
+  storage, so no EKF origin or stored mission is needed
+ */
+class AC_WPNav_MissionPlanTest : public ::testing::Test {
+protected:
+    AC_WPNav_MissionPlan plan{mission};
+    typedef AC_WPNav_MissionPlan::Leg Leg;
+
+    static const uint16_t LEGS_MAX = 10;
+
+    void SetUp() override {
+        plan._limits = {
+            1000,   // speed_ne_cms
+            250,    // speed_up_cms
+            150,    // speed_down_cms
+            250,    // accel_ne_cmss
+            100,    // accel_u_cmss
+            500,    // accel_corner_cmss
+            200,    // radius_cm
+        };
+        plan._legs = NEW_NOTHROW Leg[LEGS_MAX];
+        plan._legs_size = LEGS_MAX;
+        plan._num_legs = 0;
+        plan._have_prev_pos = false;
+        plan._stopped = true;
+        plan._length_cm = 0;
+        plan._speed_ne_cms = plan._limits.speed_ne_cms;
+        plan._speed_up_cms = plan._limits.speed_up_cms;
+        plan._speed_down_cms = plan._limits.speed_down_cms;
+        plan._state = AC_WPNav_MissionPlan::State::COMPILING;
+        plan._restart_needed = false;
+    }
+
+    void TearDown() override {
+        plan.reset();
+    }
+
+    void waypoint(uint16_t index, float north_cm, float east_cm) {
+        ASSERT_TRUE(plan.add_leg(index, Vector3f{north_cm, east_cm, 1000}, false, 0));
+    }
+
+    void change_speed(uint16_t index, float speed_ms) {
+        AP_Mission::Mission_Command cmd {};
+        cmd.index = index;
+        cmd.id = MAV_CMD_DO_CHANGE_SPEED;
+        cmd.content.speed.speed_type = SPEED_TYPE_GROUNDSPEED;
+        cmd.content.speed.target_ms = speed_ms;
+        ASSERT_TRUE(plan.add_command(cmd));
+    }
+
+    void finish() { plan.finish(); }
+
+    uint16_t num_legs() const { return plan._num_legs; }
+    const Leg &leg(uint16_t i) const { return plan._legs[i]; }
+    float total_time_s() const { return plan._time_s; }
+
+    static float leg_time_s(float length_cm, float speed_cms, float accel_cmss, float v0, float v1) {
+        Leg leg {};
+        leg.length_cm = length_cm;
+        leg.speed_cms = speed_cms;
+        leg.accel_cmss = accel_cmss;
+        return AC_WPNav_MissionPlan::leg_time_s(leg, v0, v1);
+    }
+    static float leg_time_s(const Leg &leg, float v0, float v1) {
+        return AC_WPNav_MissionPlan::leg_time_s(leg, v0, v1);
+    }
+};
+
+TEST_F(AC_WPNav_MissionPlanTest, LegTime)
+{
+    // 100m at 10m/s: 4s each way to accelerate and brake over 20m, 6s cruising
+    EXPECT_FLOAT_EQ(14.0f, leg_time_s(10000, 1000, 250, 0, 0));
+
+    // 10m never reaches cruise speed, peaks at 5m/s halfway
+    EXPECT_FLOAT_EQ(4.0f, leg_time_s(1000, 1000, 250, 0, 0));
+
+    // entering at cruise speed and braking to 5m/s over 15m
+    EXPECT_FLOAT_EQ(10.5f, leg_time_s(10000, 1000, 250, 1000, 500));
+
+    // braking all the way
+    EXPECT_FLOAT_EQ(2.0f, leg_time_s(500, 1000, 250, 500, 0));
+
+    // a repeated waypoint takes no time to fly
+    EXPECT_FLOAT_EQ(0.0f, leg_time_s(0, 0, 250, 0, 0));
+}
+
+TEST_F(AC_WPNav_MissionPlanTest, CornersAndSpeedChange)
+{
+    // a 100m square corner, slowed to 5m/s for the second corner and a
+    // short straight stretch to the end
+    waypoint(1, 0, 0);
+    waypoint(2, 10000, 0);
+    waypoint(3, 10000, 10000);
+    change_speed(4, 5);
+    waypoint(5, 0, 10000);
+    waypoint(6, -200, 10000);
+    finish();
+
+    ASSERT_TRUE(plan.ready());
+    ASSERT_EQ(4U, num_legs());
+
+    // the turn radius through a 90 degree corner passing radius_cm from the waypoint
+    const float cos_half_turn = cosf(radians(45));
+    const float corner_speed_cms = sqrtf(500 * 200 * cos_half_turn / (1 - cos_half_turn));
+    ASSERT_LT(corner_speed_cms, 500);
+
+    EXPECT_FLOAT_EQ(1000, leg(0).speed_cms);
+    EXPECT_FLOAT_EQ(1000, leg(1).speed_cms);
+    EXPECT_FLOAT_EQ(500, leg(2).speed_cms);
+    EXPECT_FLOAT_EQ(500, leg(3).speed_cms);
+
+    // both corners are flown at the corner speed
+    EXPECT_FLOAT_EQ(corner_speed_cms, leg(0).exit_speed_cms);
+    EXPECT_FLOAT_EQ(corner_speed_cms, leg(1).exit_speed_cms);
+    // there is only room to brake from sqrt(2 * 250 * 200) before the last 2m
+    EXPECT_FLOAT_EQ(sqrtf(2 * 250 * 200), leg(2).exit_speed_cms);
+    EXPECT_FLOAT_EQ(0, leg(3).exit_speed_cms);
+
+    // times accumulate from the end of the plan
+    const float t3 = leg_time_s(leg(3), leg(2).exit_speed_cms, 0);
+    const float t2 = leg_time_s(leg(2), leg(1).exit_speed_cms, leg(2).exit_speed_cms);
+    const float t1 = leg_time_s(leg(1), leg(0).exit_speed_cms, leg(1).exit_speed_cms);
+    const float t0 = leg_time_s(leg(0), 0, leg(0).exit_speed_cms);
+    EXPECT_FLOAT_EQ(0, leg(3).time_to_end_s);
+    EXPECT_FLOAT_EQ(t3, leg(2).time_to_end_s);
+    EXPECT_FLOAT_EQ(t3 + t2, leg(1).time_to_end_s);
+    EXPECT_FLOAT_EQ(t3 + t2 + t1, leg(0).time_to_end_s);
+    EXPECT_FLOAT_EQ(t3 + t2 + t1 + t0, total_time_s());
+
+    // the last 2m are flown braking from the speed the leg before left at
+    EXPECT_FLOAT_EQ(sqrtf(2 * 250 * 200) / 250, t3);
+
+    // half way along the leg ending at waypoint 3
+    float time_s;
+    ASSERT_TRUE(plan.get_time_remaining_s(3, 5000, time_s));
+    EXPECT_FLOAT_EQ(t3 + t2 + 0.5f * t1, time_s);
+
+    // the speed change is not a leg
+    EXPECT_FALSE(plan.get_time_remaining_s(4, 0, time_s));
+}
+
+#endif // AC_WPNAV_MISSION_PLAN_ENABLED
+
+AP_GTEST_MAIN()
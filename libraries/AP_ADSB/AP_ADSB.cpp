@@ -212,6 +212,13 @@ void AP_ADSB::init(void)
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ADSB: Unable to initialize ADSB vehicle list");
             return;
         }
+        if (!in_state.icao_index.init(in_state.list_size_param)) {
+            delete[] in_state.vehicle_list;
+            in_state.vehicle_list = nullptr;
+            _init_failed = true;
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ADSB: Unable to initialize ADSB vehicle list");
+            return;
+        }
         in_state.list_size_allocated = in_state.list_size_param;
     }
 
@@ -451,7 +458,7 @@ void AP_ADSB::determine_furthest_aircraft(void)
         if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
             continue;
         }
-        const float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
+        const float distance = _my_loc.get_distance_fast(get_location(in_state.vehicle_list[index]));
         if (max_distance < distance || index == 0) {
             max_distance = distance;
             max_distance_index = index;
@@ -492,8 +499,10 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         in_state.furthest_vehicle_distance = 0;
         in_state.furthest_vehicle_index = 0;
     }
+    in_state.icao_index.remove(in_state.vehicle_list[index].info.ICAO_address);
     if (index != (in_state.vehicle_count-1)) {
         in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+        in_state.icao_index.set(in_state.vehicle_list[index].info.ICAO_address, index);
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
     memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -501,19 +510,18 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
 }
 
 /*
- * Search _vehicle_list for the given vehicle. A match
- * depends on ICAO_address. Returns true if match found
+ * Search _vehicle_list for the given vehicle using the ICAO
+ * address index. Returns true if match found
  * and index is populated. otherwise, return false.
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
-            return true;
-        }
+    uint16_t i;
+    if (!in_state.icao_index.find(vehicle.info.ICAO_address, i) || i >= in_state.vehicle_count) {
+        return false;
     }
-    return false;
+    *index = i;
+    return true;
 }
 
 /*
@@ -529,7 +537,7 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
     uint16_t index = in_state.list_size_allocated + 1; // initialize with invalid index
     const Location vehicle_loc = AP_ADSB::get_location(vehicle);
     const bool my_loc_is_zero = _my_loc.is_zero();
-    const float my_loc_distance_to_vehicle = _my_loc.get_distance(vehicle_loc);
+    const float my_loc_distance_to_vehicle = _my_loc.get_distance_fast(vehicle_loc);
     const bool is_special = is_special_vehicle(vehicle.info.ICAO_address);
     const bool out_of_range = in_state.list_radius > 0 && !my_loc_is_zero && my_loc_distance_to_vehicle > in_state.list_radius && !is_special;
     const bool out_of_range_alt = in_state.list_altitude > 0 && !my_loc_is_zero && abs(vehicle_loc.alt - _my_loc.alt) > in_state.list_altitude*100 && !is_special;
@@ -610,7 +618,12 @@ void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
         // out of range
         return;
     }
+    if (index < in_state.vehicle_count) {
+        // forget the vehicle being replaced, it may be a different one
+        in_state.icao_index.remove(in_state.vehicle_list[index].info.ICAO_address);
+    }
     in_state.vehicle_list[index] = vehicle;
+    in_state.icao_index.set(vehicle.info.ICAO_address, index);
 
 #if HAL_LOGGING_ENABLED
     write_log(vehicle);
@@ -25,6 +25,7 @@
 
 #if HAL_ADSB_ENABLED
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/AP_KeyIndex.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/Location.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
@@ -269,6 +270,7 @@ private:
         uint16_t    list_size_allocated;
         adsb_vehicle_t *vehicle_list;
         uint16_t    vehicle_count;
+        AP_KeyIndex icao_index;     // ICAO address to vehicle_list index
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
@@ -380,34 +380,43 @@ void AP_AIS::buffer_shift(uint8_t i)
 // find vessel index in existing list, if not then return new index if possible, returns true if index is valid
 bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint32_t lon)
 {
+    if (_mmsi_index.capacity() < _list.max_items() && !rebuild_mmsi_index()) {
+        return false;
+    }
+
     const uint16_t list_size = _list.max_items();
 
-    uint16_t empty = 0;
-    bool found_empty = false;
+    if (mmsi == 0) {
+        // zero also marks unused list items so it is not indexed,
+        // take the first item holding it
+        for (uint16_t i = 0; i < list_size; i++) {
+            if (_list[i].info.MMSI == 0) {
+                index = i;
+                return true;
+            }
+        }
+    } else if (_mmsi_index.find(mmsi, index)) {
+        return true;
+    }
+
     for (uint16_t i = 0; i < list_size; i++) {
-        if (_list[i].info.MMSI == mmsi) {
+        if (_list[i].last_update_ms == 0) {
+            // got through the list without a match, use the first empty item
             index = i;
+            set_list_mmsi(index, mmsi);
             return true;
         }
-        if (_list[i].last_update_ms == 0 && !found_empty) {
-            found_empty = true;
-            empty = i;
-        }
-    }
-
-    // got through the list without a match
-    if (found_empty) {
-        index = empty;
-        _list[index].info.MMSI = mmsi;
-        return true;
     }
 
     // no space in the list
     if (list_size < _max_list) {
         // if we can try and expand
         if (_list.expand(1)) {
+            if (!rebuild_mmsi_index()) {
+                return false;
+            }
             index = list_size;
-            _list[index].info.MMSI = mmsi;
+            set_list_mmsi(index, mmsi);
             return true;
         }
     }
@@ -431,12 +440,12 @@ bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint
             // Remove vessel with invalid location
             index = i;
             clear_list_item(index);
-            _list[index].info.MMSI = mmsi;
+            set_list_mmsi(index, mmsi);
             return true;
         }
         loc.lat = _list[i].info.lat;
         loc.lng = _list[i].info.lon;
-        dist = loc.get_distance(current_loc);
+        dist = loc.get_distance_fast(current_loc);
         if (dist > max_dist) {
             max_dist = dist;
             index = i;
@@ -446,11 +455,11 @@ bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint
     // find the current distance
     loc.lat = lat;
     loc.lng = lon;
-    dist = loc.get_distance(current_loc);
+    dist = loc.get_distance_fast(current_loc);
 
     if (dist < max_dist) {
         clear_list_item(index);
-        _list[index].info.MMSI = mmsi;
+        set_list_mmsi(index, mmsi);
         return true;
     }
 
@@ -460,10 +469,40 @@ bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint
 void AP_AIS::clear_list_item(uint16_t index)
 {
     if (index < _list.max_items()) {
+        set_list_mmsi(index, 0);
         memset(&_list[index],0,sizeof(ais_vehicle_t));
     }
 }
 
+// assign an MMSI to a list item, keeping _mmsi_index in step
+void AP_AIS::set_list_mmsi(uint16_t index, uint32_t mmsi)
+{
+    uint16_t old_index;
+    const uint32_t old_mmsi = _list[index].info.MMSI;
+    if (old_mmsi != 0 && _mmsi_index.find(old_mmsi, old_index) && old_index == index) {
+        _mmsi_index.remove(old_mmsi);
+    }
+    _list[index].info.MMSI = mmsi;
+    if (mmsi != 0) {
+        _mmsi_index.set(mmsi, index);
+    }
+}
+
+// resize _mmsi_index to the list and re-index it, returns false on allocation failure
+bool AP_AIS::rebuild_mmsi_index()
+{
+    const uint16_t list_size = _list.max_items();
+    if (!_mmsi_index.init(list_size)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < list_size; i++) {
+        if (_list[i].info.MMSI != 0) {
+            _mmsi_index.set(_list[i].info.MMSI, i);
+        }
+    }
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for decoding AIVDM payload messages
 
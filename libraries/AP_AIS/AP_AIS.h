@@ -23,6 +23,7 @@
 
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/AP_ExpandingArray.h>
+#include <AP_Common/AP_KeyIndex.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
 #define AIVDM_BUFFER_SIZE 10
@@ -90,6 +91,9 @@ private:
     // list of the vessels that are being tracked
     AP_ExpandingArray<ais_vehicle_t> _list {8};
 
+    // MMSI to _list index, sized to match the list
+    AP_KeyIndex _mmsi_index;
+
     AP_HAL::UARTDriver *_uart;
 
     uint16_t _send_index; // index of the last vessel send over mavlink
@@ -107,6 +111,12 @@ private:
     bool get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat = 0, uint32_t lon = 0) WARN_IF_UNUSED;
     void clear_list_item(uint16_t index);
 
+    // assign an MMSI to a list item, keeping _mmsi_index in step
+    void set_list_mmsi(uint16_t index, uint32_t mmsi);
+
+    // resize _mmsi_index to the list and re-index it, returns false on allocation failure
+    bool rebuild_mmsi_index() WARN_IF_UNUSED;
+
     // decode the payload
     bool payload_decode(const char *payload) WARN_IF_UNUSED;
 
@@ -281,23 +281,19 @@ void AP_Avoidance::get_adsb_samples()
     }
 }
 
-float closest_approach_xy(const Location &my_loc,
-                          const Vector3f &my_vel,
-                          const Location &obstacle_loc,
-                          const Vector3f &obstacle_vel,
-                          const uint8_t time_horizon)
+// returns the closest an obstacle at delta_pos_ne from us, moving at
+// delta_vel_ne relative to us, will get in the horizontal plane (in metres)
+static float closest_approach_ne(const Vector2f &delta_pos_ne,
+                                 const Vector2f &delta_vel_ne,
+                                 const float time_horizon)
 {
-
-    Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
-    const Vector2f delta_pos_ne = obstacle_loc.get_distance_NE(my_loc);
-
     Vector2f line_segment_ne = delta_vel_ne * time_horizon;
 
     float ret = Vector2<float>::closest_distance_between_radial_and_point
         (line_segment_ne,
          delta_pos_ne);
 
-    debug("   time_horizon: (%d)", time_horizon);
+    debug("   time_horizon: (%f)", time_horizon);
     debug("   delta pos: (y=%f,x=%f)", delta_pos_ne[0], delta_pos_ne[1]);
     debug("   delta vel: (y=%f,x=%f)", delta_vel_ne[0], delta_vel_ne[1]);
     debug("   line segment: (y=%f,x=%f)", line_segment_ne[0], line_segment_ne[1]);
@@ -306,12 +302,23 @@ float closest_approach_xy(const Location &my_loc,
     return ret;
 }
 
+float closest_approach_xy(const Location &my_loc,
+                          const Vector3f &my_vel,
+                          const Location &obstacle_loc,
+                          const Vector3f &obstacle_vel,
+                          const float time_horizon)
+{
+    const Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
+    const Vector2f delta_pos_ne = obstacle_loc.get_distance_NE_fast(my_loc);
+    return closest_approach_ne(delta_pos_ne, delta_vel_ne, time_horizon);
+}
+
 // returns the closest these objects will get in the body z axis (in metres)
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
                          const Location &obstacle_loc,
                          const Vector3f &obstacle_vel,
-                         const uint8_t time_horizon)
+                         const float time_horizon)
 {
 
     float delta_vel_d = obstacle_vel[2] - my_vel[2];
@@ -326,7 +333,7 @@ float closest_approach_z(const Location &my_loc,
         ret = fabsf(delta_pos_d - delta_vel_d * time_horizon);
     }
 
-    debug("   time_horizon: (%d)", time_horizon);
+    debug("   time_horizon: (%f)", time_horizon);
     debug("   delta pos: (%f) metres", delta_pos_d*0.01f);
     debug("   delta vel: (%f) m/s", delta_vel_d);
     debug("   closest: (%f) metres", ret*0.01f);
@@ -345,24 +352,43 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
-    if (closest_xy < _fail_distance_xy) {
-        obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
+    const float fail_time_horizon = float(_fail_time_horizon) + obstacle_age/1000;
+    const float warn_time_horizon = float(_warn_time_horizon) + obstacle_age/1000;
+
+    const Vector2f delta_pos_ne = obstacle_loc.get_distance_NE_fast(my_loc);
+    const Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
+
+    // range gate: within either time horizon the obstacle can close on
+    // us by at most its relative speed times that horizon. If that
+    // still leaves it outside both the fail and warn distances it can
+    // not be a threat, and only the warn horizon closest approach that
+    // is reported for non-threats is calculated
+    const float min_possible_xy = delta_pos_ne.length() -
+                                  delta_vel_ne.length() * MAX(fabsf(fail_time_horizon), fabsf(warn_time_horizon));
+
+    float closest_xy;
+    if (min_possible_xy >= MAX(float(_fail_distance_xy), _warn_distance_xy.get())) {
+        closest_xy = closest_approach_ne(delta_pos_ne, delta_vel_ne, warn_time_horizon);
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
-        if (closest_xy < _warn_distance_xy) {
-            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
+        closest_xy = closest_approach_ne(delta_pos_ne, delta_vel_ne, fail_time_horizon);
+        if (closest_xy < _fail_distance_xy) {
+            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
+        } else {
+            closest_xy = closest_approach_ne(delta_pos_ne, delta_vel_ne, warn_time_horizon);
+            if (closest_xy < _warn_distance_xy) {
+                obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
+            }
         }
     }
 
     // check for vertical separation; our threat level is the minimum
     // of vertical and horizontal threat levels
-    float closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+    float closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, warn_time_horizon);
     if (obstacle.threat_level != MAV_COLLISION_THREAT_LEVEL_NONE) {
         if (closest_z > _warn_distance_z) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
         } else {
-            closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+            closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, fail_time_horizon);
             if (closest_z > _fail_distance_z) {
                 obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
             }
@@ -378,13 +404,12 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = my_loc.get_distance(obstacle_loc);
+    float current_distance = my_loc.get_distance_fast(obstacle_loc);
     obstacle.distance_to_closest_approach = current_distance - closest_xy;
-    Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
     obstacle.time_to_closest_approach = 0.0f;
     if (!is_zero(obstacle.distance_to_closest_approach) &&
-        ! is_zero(net_velocity_ne.length())) {
-        obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / net_velocity_ne.length();
+        ! is_zero(delta_vel_ne.length())) {
+        obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / delta_vel_ne.length();
     }
 }
 
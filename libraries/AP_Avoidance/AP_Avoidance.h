@@ -150,6 +150,9 @@ protected:
 
 private:
 
+    // evaluates obstacles directly, with and without the range gate
+    friend class AP_Avoidance_Benchmark;
+
     void send_collision_all(const AP_Avoidance::Obstacle &threat, MAV_COLLISION_ACTION behaviour) const;
 
     // constants
@@ -220,13 +223,13 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &my_vel,
                           const Location &obstacle_loc,
                           const Vector3f &obstacle_vel,
-                          uint8_t time_horizon);
+                          float time_horizon);
 
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
                          const Location &obstacle_loc,
                          const Vector3f &obstacle_vel,
-                         uint8_t time_horizon);
+                         float time_horizon);
 
 
 namespace AP {
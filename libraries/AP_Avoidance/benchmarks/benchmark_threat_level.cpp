@@ -0,0 +1,149 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Avoidance/AP_Avoidance.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_ADSB_AVOIDANCE_ENABLED
+
+// 500 obstacles placed the way SIM_ADSB places its synthetic traffic,
+// normally distributed over SIM_ADSB_RADIUS around the vehicle at
+// SIM_ADSB_ALT, evaluated once per pass as check_for_threats() does
+
+static const uint16_t num_obstacles = 500;
+static const float adsb_radius_m = 10000;
+static const float adsb_altitude_m = 1000;
+
+static AP_ADSB adsb;
+
+class AP_Avoidance_Benchmark : public AP_Avoidance {
+public:
+    using AP_Avoidance::AP_Avoidance;
+
+    void update_threat_level(const Location &my_loc, const Vector3f &my_vel, Obstacle &obstacle) {
+        AP_Avoidance::update_threat_level(my_loc, my_vel, obstacle);
+    }
+
+    // update_threat_level() without the range gate, both time horizons
+    // are searched for every obstacle
+    void update_threat_level_ungated(const Location &my_loc, const Vector3f &my_vel, Obstacle &obstacle) {
+        const Location &obstacle_loc = obstacle._location;
+        const Vector3f &obstacle_vel = obstacle._velocity;
+
+        obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
+
+        const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
+        const float fail_time_horizon = float(_fail_time_horizon) + obstacle_age/1000;
+        const float warn_time_horizon = float(_warn_time_horizon) + obstacle_age/1000;
+
+        float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, fail_time_horizon);
+        if (closest_xy < _fail_distance_xy) {
+            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
+        } else {
+            closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, warn_time_horizon);
+            if (closest_xy < _warn_distance_xy) {
+                obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
+            }
+        }
+
+        float closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, warn_time_horizon);
+        if (obstacle.threat_level != MAV_COLLISION_THREAT_LEVEL_NONE) {
+            if (closest_z > _warn_distance_z) {
+                obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
+            } else {
+                closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, fail_time_horizon);
+                if (closest_z > _fail_distance_z) {
+                    obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
+                }
+            }
+        }
+
+        obstacle.closest_approach_xy = closest_xy;
+        obstacle.closest_approach_z = closest_z;
+        const Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
+        obstacle.distance_to_closest_approach = my_loc.get_distance_fast(obstacle_loc) - closest_xy;
+        obstacle.time_to_closest_approach = 0.0f;
+        if (!is_zero(obstacle.distance_to_closest_approach) &&
+            !is_zero(net_velocity_ne.length())) {
+            obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / net_velocity_ne.length();
+        }
+    }
+
+protected:
+    MAV_COLLISION_ACTION handle_avoidance(const Obstacle *obstacle, MAV_COLLISION_ACTION requested_action) override {
+        return requested_action;
+    }
+    void handle_recovery(RecoveryAction recovery_action) override {}
+};
+
+static AP_Avoidance_Benchmark avoidance{adsb};
+
+static const Location vehicle{-35362938, 149165085, 10000, Location::AltFrame::ABSOLUTE};
+static const Vector3f vehicle_vel{10, 5, 0};
+
+static float rand_normal(float mean, float stddev)
+{
+    // Box-Muller, as SIM_ADSB's Aircraft::rand_normal
+    const float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    const float u2 = rand() / (RAND_MAX + 1.0f);
+    return mean + stddev * sqrtf(-2 * logf(u1)) * cosf(M_2PI * u2);
+}
+
+static AP_Avoidance::Obstacle *make_obstacles(void)
+{
+    AP_Avoidance::Obstacle *obstacles = new AP_Avoidance::Obstacle[num_obstacles];
+    srand(1);
+    for (uint16_t i = 0; i < num_obstacles; i++) {
+        AP_Avoidance::Obstacle &obstacle = obstacles[i];
+        obstacle = AP_Avoidance::Obstacle {};
+        obstacle.src = MAV_COLLISION_SRC_ADSB;
+        obstacle.src_id = i;
+        obstacle.timestamp_ms = AP_HAL::millis();
+        obstacle._location = vehicle;
+        obstacle._location.offset(rand_normal(0, adsb_radius_m), rand_normal(0, adsb_radius_m));
+        obstacle._location.set_alt_cm(adsb_altitude_m * 100, Location::AltFrame::ABSOLUTE);
+        // SIM_ADSB triples the speed of targets more than 500m away
+        const Vector2f offset_ne = vehicle.get_distance_NE(obstacle._location);
+        const float speed_scale = (offset_ne.length() > 500) ? 3 : 1;
+        obstacle._velocity = Vector3f{rand_normal(5, 20) * speed_scale,
+                                      rand_normal(5, 20) * speed_scale,
+                                      rand_normal(-3, 3)};
+    }
+    return obstacles;
+}
+
+static void BM_ThreatLevelRangeGate(benchmark::State& state)
+{
+    AP_Avoidance::Obstacle *obstacles = make_obstacles();
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < num_obstacles; i++) {
+            avoidance.update_threat_level(vehicle, vehicle_vel, obstacles[i]);
+        }
+        gbenchmark_escape(obstacles);
+    }
+    state.SetItemsProcessed(state.iterations() * num_obstacles);
+    delete[] obstacles;
+}
+
+static void BM_ThreatLevelNoRangeGate(benchmark::State& state)
+{
+    AP_Avoidance::Obstacle *obstacles = make_obstacles();
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < num_obstacles; i++) {
+            avoidance.update_threat_level_ungated(vehicle, vehicle_vel, obstacles[i]);
+        }
+        gbenchmark_escape(obstacles);
+    }
+    state.SetItemsProcessed(state.iterations() * num_obstacles);
+    delete[] obstacles;
+}
+
+BENCHMARK(BM_ThreatLevelRangeGate);
+BENCHMARK(BM_ThreatLevelNoRangeGate);
+
+#endif // AP_ADSB_AVOIDANCE_ENABLED
+
+BENCHMARK_MAIN();
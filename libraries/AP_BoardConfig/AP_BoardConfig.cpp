@@ -429,6 +429,57 @@ const AP_Param::GroupInfo AP_BoardConfig::var_info[] = {
     // index 30 used by SER6_RTSCTS
     // index 31 used by SER7_RTSCTS
     // index 32 used by SER8_RTSCTS
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // @Param: CPU_MAIN
+    // @DisplayName: CPUs for main loop
+    // @Description: CPUs the vehicle main loop may run on. 0 lets them run on any CPU the process is allowed. Giving the main loop a core of its own keeps other threads from delaying the attitude controllers.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_MAIN", 33, AP_BoardConfig, cpu_affinity.main, 0),
+
+    // @Param: CPU_TIMER
+    // @DisplayName: CPUs for timer threads
+    // @Description: CPUs the timer, CAN and RC output threads may run on. 0 lets them run on any CPU the process is allowed. Keeping these off the main loop core stops the 1kHz timer and CAN traffic from preempting it.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_TIMER", 34, AP_BoardConfig, cpu_affinity.timer, 0),
+
+    // @Param: CPU_SENS
+    // @DisplayName: CPUs for sensor bus threads
+    // @Description: CPUs the SPI and I2C bus threads that sample IMUs, barometers and compasses may run on. 0 lets them run on any CPU the process is allowed. A dedicated core for these keeps IMU sampling regular, which the gyro filters and FFT rely on.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_SENS", 35, AP_BoardConfig, cpu_affinity.sensors, 0),
+
+    // @Param: CPU_UART
+    // @DisplayName: CPUs for serial threads
+    // @Description: CPUs the serial port and network threads may run on. 0 lets them run on any CPU the process is allowed. Moving telemetry and network traffic to a spare core stops bursts of it from disturbing the flight control threads.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_UART", 36, AP_BoardConfig, cpu_affinity.uart, 0),
+
+    // @Param: CPU_RCIN
+    // @DisplayName: CPUs for RC input thread
+    // @Description: CPUs the RC input thread may run on. 0 lets them run on any CPU the process is allowed. Pinning it away from busy cores keeps pulse and serial RC decoding from dropping frames.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_RCIN", 37, AP_BoardConfig, cpu_affinity.rcin, 0),
+
+    // @Param: CPU_IO
+    // @DisplayName: CPUs for IO threads
+    // @Description: CPUs the IO, storage and scripting threads may run on. 0 lets them run on any CPU the process is allowed. These do slow work such as logging, parameter saves and Lua scripts, so keeping them off the main loop and sensor cores stops them stealing time from flight control.
+    // @Bitmask: 0:CPU0,1:CPU1,2:CPU2,3:CPU3,4:CPU4,5:CPU5,6:CPU6,7:CPU7
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CPU_IO", 38, AP_BoardConfig, cpu_affinity.io, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -280,6 +280,9 @@ private:
     void board_setup_uart(void);
     void board_setup_sbus(void);
     void board_setup(void);
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    void board_setup_affinity(void);
+#endif
 
     // common method to throw errors
     static void throw_error(const char *err_str, const char *fmt, va_list arg) NORETURN;
@@ -324,6 +327,18 @@ private:
     AP_Int8 _sdcard_slowdown;
 #endif
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // CPU masks for groups of threads, see BRD_CPU_*
+    struct {
+        AP_Int8 main;
+        AP_Int8 timer;
+        AP_Int8 sensors;
+        AP_Int8 uart;
+        AP_Int8 rcin;
+        AP_Int8 io;
+    } cpu_affinity;
+#endif
+
     AP_Int16 _boot_delay_ms;
 
     AP_Int32 _options;
@@ -456,7 +456,40 @@ void AP_BoardConfig::board_setup()
 #if AP_FEATURE_BOARD_DETECT
     board_setup_drivers();
 #endif
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    board_setup_affinity();
+#endif
+}
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+/*
+  pin groups of threads to the CPUs given by the BRD_CPU_* parameters
+ */
+void AP_BoardConfig::board_setup_affinity(void)
+{
+    typedef AP_HAL::Scheduler S;
+    const struct {
+        const AP_Int8 &mask;
+        S::priority_base bases[4];
+        uint8_t num_bases;
+    } groups[] = {
+        { cpu_affinity.main,    { S::PRIORITY_MAIN, S::PRIORITY_BOOST }, 2 },
+        { cpu_affinity.timer,   { S::PRIORITY_TIMER, S::PRIORITY_CAN, S::PRIORITY_RCOUT, S::PRIORITY_LED }, 4 },
+        { cpu_affinity.sensors, { S::PRIORITY_SPI, S::PRIORITY_I2C }, 2 },
+        { cpu_affinity.uart,    { S::PRIORITY_UART, S::PRIORITY_NET }, 2 },
+        { cpu_affinity.rcin,    { S::PRIORITY_RCIN }, 1 },
+        { cpu_affinity.io,      { S::PRIORITY_IO, S::PRIORITY_STORAGE, S::PRIORITY_SCRIPTING }, 3 },
+    };
+    for (const auto &g : groups) {
+        if (g.mask == 0) {
+            continue;
+        }
+        for (uint8_t i = 0; i < g.num_bases; i++) {
+            hal.scheduler->set_thread_affinity(g.bases[i], uint8_t(g.mask.get()));
+        }
+    }
 }
+#endif
 
 
 #ifdef HAL_CHIBIOS_ARCH_FMUV6
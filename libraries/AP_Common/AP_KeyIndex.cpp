@@ -0,0 +1,136 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_KeyIndex.h"
+
+#include <AP_InternalError/AP_InternalError.h>
+
+AP_KeyIndex::~AP_KeyIndex()
+{
+    delete[] _slots;
+}
+
+// allocate space for max_items keys, dropping any existing entries.
+// returns false on allocation failure
+bool AP_KeyIndex::init(uint16_t max_items)
+{
+    delete[] _slots;
+    _slots = nullptr;
+    _mask = 0;
+    _max_items = 0;
+    _count = 0;
+
+    // keep the table at most half full
+    uint32_t size = 8;
+    while (size < 2U * max_items) {
+        size *= 2;
+    }
+    if (size > 32768U) {
+        return false;
+    }
+
+    _slots = NEW_NOTHROW Slot[size];
+    if (_slots == nullptr) {
+        return false;
+    }
+    _mask = size - 1;
+    _max_items = max_items;
+    clear();
+    return true;
+}
+
+// slot holding key, or the empty slot ending its probe sequence
+uint16_t AP_KeyIndex::probe(uint32_t key) const
+{
+    // the table is never full so this always terminates
+    uint16_t i = home(key);
+    while (_slots[i].pos != EMPTY_POS && _slots[i].key != key) {
+        i = (i + 1) & _mask;
+    }
+    return i;
+}
+
+// find the list position stored for key
+bool AP_KeyIndex::find(uint32_t key, uint16_t &pos) const
+{
+    if (_slots == nullptr) {
+        return false;
+    }
+    const Slot &slot = _slots[probe(key)];
+    if (slot.pos == EMPTY_POS) {
+        return false;
+    }
+    pos = slot.pos;
+    return true;
+}
+
+// store pos for key, replacing any existing position.
+// returns false if the index is full or not initialised
+bool AP_KeyIndex::set(uint32_t key, uint16_t pos)
+{
+    if (_slots == nullptr || pos == EMPTY_POS) {
+        return false;
+    }
+    Slot &slot = _slots[probe(key)];
+    if (slot.pos == EMPTY_POS) {
+        if (_count >= _max_items) {
+            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
+            return false;
+        }
+        slot.key = key;
+        _count++;
+    }
+    slot.pos = pos;
+    return true;
+}
+
+// forget key, does nothing if it is not in the index
+void AP_KeyIndex::remove(uint32_t key)
+{
+    if (_slots == nullptr) {
+        return;
+    }
+    uint16_t hole = probe(key);
+    if (_slots[hole].pos == EMPTY_POS) {
+        return;
+    }
+    _count--;
+
+    // shift back any later entry in the run whose home slot is at or
+    // before the hole, so no probe sequence crosses an empty slot
+    uint16_t i = hole;
+    while (true) {
+        i = (i + 1) & _mask;
+        if (_slots[i].pos == EMPTY_POS) {
+            break;
+        }
+        const uint16_t h = home(_slots[i].key);
+        // distance from the home slot to i, and from the hole to i
+        if (((i - h) & _mask) >= ((i - hole) & _mask)) {
+            _slots[hole] = _slots[i];
+            hole = i;
+        }
+    }
+    _slots[hole].pos = EMPTY_POS;
+}
+
+// forget all keys
+void AP_KeyIndex::clear()
+{
+    for (uint32_t i = 0; _slots != nullptr && i <= _mask; i++) {
+        _slots[i].pos = EMPTY_POS;
+    }
+    _count = 0;
+}
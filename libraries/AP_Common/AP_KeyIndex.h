@@ -0,0 +1,82 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+
+/*
+  Fixed size index from a 32 bit key (ICAO address, MMSI, ...) to the
+  position of the item holding it in a list owned by the caller, so
+  finding a target no longer means scanning the whole list.
+
+  The table is open addressed with linear probing and is sized to at
+  least twice the number of items so probe sequences stay short.
+  Removal shifts later entries back rather than leaving tombstones, so
+  lookups never slow down as targets come and go.
+
+  The index does not own the list, the caller must keep it in step
+  with every change to the list.
+ */
+class AP_KeyIndex
+{
+public:
+    AP_KeyIndex() {}
+    ~AP_KeyIndex();
+
+    CLASS_NO_COPY(AP_KeyIndex);
+
+    // allocate space for max_items keys, dropping any existing entries.
+    // returns false on allocation failure
+    bool init(uint16_t max_items);
+
+    // number of keys the index was initialised for
+    uint16_t capacity() const { return _max_items; }
+
+    // find the list position stored for key
+    bool find(uint32_t key, uint16_t &pos) const;
+
+    // store pos for key, replacing any existing position.
+    // returns false if the index is full or not initialised
+    bool set(uint32_t key, uint16_t pos);
+
+    // forget key, does nothing if it is not in the index
+    void remove(uint32_t key);
+
+    // forget all keys
+    void clear();
+
+private:
+
+    struct Slot {
+        uint32_t key;
+        uint16_t pos;           // EMPTY_POS if the slot is unused
+    };
+
+    static const uint16_t EMPTY_POS = UINT16_MAX;
+
+    // home slot of a key
+    uint16_t home(uint32_t key) const {
+        // Fibonacci hashing spreads sequential keys across the table
+        return ((key * 2654435769U) >> 16) & _mask;
+    }
+
+    // slot holding key, or the empty slot ending its probe sequence
+    uint16_t probe(uint32_t key) const;
+
+    Slot *_slots = nullptr;
+    uint16_t _mask = 0;           // table size - 1, the table size is a power of two
+    uint16_t _max_items = 0;
+    uint16_t _count = 0;
+};
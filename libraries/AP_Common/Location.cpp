@@ -520,6 +520,77 @@ ftype Location::get_bearing(const Location &loc2) const
     return bearing;
 }
 
+// cos() of each whole degree of latitude, for longitude_scale_fast()
+static const float cos_lat_deg[91] {
+    1.0f, 0.999847695f, 0.999390827f, 0.998629535f, 0.997564050f, 0.996194698f,
+    0.994521895f, 0.992546152f, 0.990268069f, 0.987688341f, 0.984807753f, 0.981627183f,
+    0.978147601f, 0.974370065f, 0.970295726f, 0.965925826f, 0.961261696f, 0.956304756f,
+    0.951056516f, 0.945518576f, 0.939692621f, 0.933580426f, 0.927183855f, 0.920504853f,
+    0.913545458f, 0.906307787f, 0.898794046f, 0.891006524f, 0.882947593f, 0.874619707f,
+    0.866025404f, 0.857167301f, 0.848048096f, 0.838670568f, 0.829037573f, 0.819152044f,
+    0.809016994f, 0.798635510f, 0.788010754f, 0.777145961f, 0.766044443f, 0.754709580f,
+    0.743144825f, 0.731353702f, 0.719339800f, 0.707106781f, 0.694658370f, 0.681998360f,
+    0.669130606f, 0.656059029f, 0.642787610f, 0.629320391f, 0.615661475f, 0.601815023f,
+    0.587785252f, 0.573576436f, 0.559192903f, 0.544639035f, 0.529919264f, 0.515038075f,
+    0.500000000f, 0.484809620f, 0.469471563f, 0.453990500f, 0.438371147f, 0.422618262f,
+    0.406736643f, 0.390731128f, 0.374606593f, 0.358367950f, 0.342020143f, 0.325568154f,
+    0.309016994f, 0.292371705f, 0.275637356f, 0.258819045f, 0.241921896f, 0.224951054f,
+    0.207911691f, 0.190808995f, 0.173648178f, 0.156434465f, 0.139173101f, 0.121869343f,
+    0.104528463f, 0.087155743f, 0.069756474f, 0.052335956f, 0.034899497f, 0.017452406f,
+    0.0f,
+};
+
+ftype Location::longitude_scale_fast(int32_t lat)
+{
+    // split the latitude into the nearest whole degree and a remainder
+    // d of at most half a degree, then
+    //   cos(deg + d) = cos(deg)cos(d) - sin(deg)sin(d)
+    // with cos(d) and sin(d) to second order.  The truncation error is
+    // below d^3/6 = 1.1e-7, plus float rounding
+    const uint32_t abs_lat = MIN(uint32_t(labs(lat)), 900000000U);
+    const uint8_t deg = (abs_lat + 5000000U) / 10000000U;
+    const float d = (int32_t(abs_lat) - int32_t(deg) * 10000000) * float(1.0e-7 * DEG_TO_RAD);
+    const float scale = cos_lat_deg[deg] * (1.0f - 0.5f * d * d) - cos_lat_deg[90 - deg] * d;
+    return MAX(scale, 0.01f);
+}
+
+// return horizontal distance in meters between two locations
+ftype Location::get_distance_fast(const Location &loc2) const
+{
+    ftype dlat = (ftype)(loc2.lat - lat);
+    ftype dlng = ((ftype)diff_longitude(loc2.lng,lng)) * longitude_scale_fast((lat+loc2.lat)/2);
+    return norm(dlat, dlng) * LOCATION_SCALING_FACTOR;
+}
+
+// return the distance in meters in North/East plane as a N/E vector to loc2
+Vector2f Location::get_distance_NE_fast(const Location &loc2) const
+{
+    return Vector2f((loc2.lat - lat) * LOCATION_SCALING_FACTOR,
+                    diff_longitude(loc2.lng,lng) * LOCATION_SCALING_FACTOR * longitude_scale_fast((loc2.lat+lat)/2));
+}
+
+// return the bearing in radians, from 0 to 2*Pi
+ftype Location::get_bearing_fast(const Location &loc2) const
+{
+    const int32_t off_x = diff_longitude(loc2.lng,lng);
+    const int32_t off_y = (loc2.lat - lat) / longitude_scale_fast((lat+loc2.lat)/2);
+    ftype bearing = (M_PI*0.5) + atan2f_fast(-off_y, off_x);
+    if (bearing < 0) {
+        bearing += 2*M_PI;
+    }
+    return bearing;
+}
+
+// extrapolate latitude/longitude given distances (in meters) north and east
+void Location::offset_fast(ftype ofs_north, ftype ofs_east)
+{
+    const int32_t dlat = ofs_north * LOCATION_SCALING_FACTOR_INV;
+    const int64_t dlng = (ofs_east * LOCATION_SCALING_FACTOR_INV) / longitude_scale_fast(lat+dlat/2);
+    lat += dlat;
+    lat = limit_lattitude(lat);
+    lng = wrap_longitude(dlng+lng);
+}
+
 /*
   return true if lat and lng match. Ignores altitude and options
  */
@@ -144,6 +144,18 @@ public:
         return int32_t(rad_to_cd(get_bearing(loc2)) + 0.5);
     }
 
+    // fast forms of the functions above for code that evaluates many
+    // locations per loop. longitude_scale_fast() is table driven and
+    // within 3e-7 of longitude_scale(), which keeps distances within
+    // 0.3mm per km of the exact form. get_bearing_fast() is within
+    // 2.5e-6 radians of get_bearing() apart from the rounding to
+    // whole 1e-7 degree units that both share
+    static ftype longitude_scale_fast(int32_t lat);
+    ftype get_distance_fast(const Location &loc2) const;
+    Vector2f get_distance_NE_fast(const Location &loc2) const;
+    ftype get_bearing_fast(const Location &loc2) const;
+    void offset_fast(ftype ofs_north, ftype ofs_east);
+
     // check if lat and lng match. Ignore altitude and options
     bool same_latlon_as(const Location &loc2) const;
 
@@ -0,0 +1,103 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_KeyIndex.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// state.range(0) ADSB targets with ICAO addresses drawn the way SIM_ADSB
+// makes them, each reporting once per pass. The list is looked up by
+// ICAO for every report, first by the old linear search and then
+// through AP_KeyIndex
+
+static uint32_t *make_icaos(uint16_t count)
+{
+    uint32_t *icao = new uint32_t[count];
+    srand(1);
+    for (uint16_t i = 0; i < count; i++) {
+        bool dup;
+        do {
+            icao[i] = rand() % 10000;
+            dup = false;
+            for (uint16_t j = 0; j < i; j++) {
+                dup |= icao[j] == icao[i];
+            }
+        } while (dup);
+    }
+    return icao;
+}
+
+static void BM_ICAOLinearSearch(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    uint32_t *list = make_icaos(count);
+
+    while (state.KeepRunning()) {
+        // reports arrive in a different order to the list
+        for (uint16_t r = 0; r < count; r++) {
+            const uint32_t icao = list[(r * 7) % count];
+            uint16_t pos = 0;
+            for (uint16_t i = 0; i < count; i++) {
+                if (list[i] == icao) {
+                    pos = i;
+                    break;
+                }
+            }
+            gbenchmark_escape(&pos);
+        }
+    }
+    delete[] list;
+}
+
+static void BM_ICAOKeyIndex(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    uint32_t *list = make_icaos(count);
+    AP_KeyIndex index;
+    index.init(count);
+    for (uint16_t i = 0; i < count; i++) {
+        index.set(list[i], i);
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t r = 0; r < count; r++) {
+            const uint32_t icao = list[(r * 7) % count];
+            uint16_t pos = 0;
+            index.find(icao, pos);
+            gbenchmark_escape(&pos);
+        }
+    }
+    delete[] list;
+}
+
+// targets timing out and new ones arriving, deleting by moving the
+// last list item into the hole as AP_ADSB does
+static void BM_ICAOKeyIndexChurn(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    uint32_t *list = make_icaos(count);
+    AP_KeyIndex index;
+    index.init(count);
+    for (uint16_t i = 0; i < count; i++) {
+        index.set(list[i], i);
+    }
+
+    uint32_t next_icao = 10000;
+    while (state.KeepRunning()) {
+        for (uint16_t r = 0; r < count; r++) {
+            const uint16_t pos = (r * 7) % count;
+            index.remove(list[pos]);
+            list[pos] = list[count-1];
+            index.set(list[pos], pos);
+            list[count-1] = next_icao++ & 0xFFFFFF;
+            index.set(list[count-1], count-1);
+        }
+    }
+    delete[] list;
+}
+
+BENCHMARK(BM_ICAOLinearSearch)->Arg(25)->Arg(500);
+BENCHMARK(BM_ICAOKeyIndex)->Arg(25)->Arg(500);
+BENCHMARK(BM_ICAOKeyIndexChurn)->Arg(500);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,150 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// state.range(0) targets spread over 20km around a vehicle, evaluated
+// the way ADSB and avoidance do it every update
+
+static Location *make_targets(const Location &vehicle, uint16_t count)
+{
+    Location *targets = new Location[count];
+    for (uint16_t i = 0; i < count; i++) {
+        targets[i] = vehicle;
+        targets[i].offset_bearing((i * 137) % 360, 100.0f + i * (20000.0f / count));
+    }
+    return targets;
+}
+
+static const Location vehicle{-35362938, 149165085, 58400, Location::AltFrame::ABSOLUTE};
+
+static void BM_LocationDistance(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        ftype furthest = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            furthest = MAX(furthest, vehicle.get_distance(targets[i]));
+        }
+        gbenchmark_escape(&furthest);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationDistanceFast(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        ftype furthest = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            furthest = MAX(furthest, vehicle.get_distance_fast(targets[i]));
+        }
+        gbenchmark_escape(&furthest);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationDistanceNE(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        Vector2f sum;
+        for (uint16_t i = 0; i < count; i++) {
+            sum += targets[i].get_distance_NE(vehicle);
+        }
+        gbenchmark_escape(&sum);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationDistanceNEFast(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        Vector2f sum;
+        for (uint16_t i = 0; i < count; i++) {
+            sum += targets[i].get_distance_NE_fast(vehicle);
+        }
+        gbenchmark_escape(&sum);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationBearing(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        ftype sum = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            sum += vehicle.get_bearing(targets[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationBearingFast(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        ftype sum = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            sum += vehicle.get_bearing_fast(targets[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            targets[i].offset(0.5f, -0.25f);
+        }
+        gbenchmark_escape(targets);
+    }
+    delete[] targets;
+}
+
+static void BM_LocationOffsetFast(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Location *targets = make_targets(vehicle, count);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            targets[i].offset_fast(0.5f, -0.25f);
+        }
+        gbenchmark_escape(targets);
+    }
+    delete[] targets;
+}
+
+BENCHMARK(BM_LocationDistance)->Arg(64);
+BENCHMARK(BM_LocationDistanceFast)->Arg(64);
+BENCHMARK(BM_LocationDistanceNE)->Arg(64);
+BENCHMARK(BM_LocationDistanceNEFast)->Arg(64);
+BENCHMARK(BM_LocationBearing)->Arg(64);
+BENCHMARK(BM_LocationBearingFast)->Arg(64);
+BENCHMARK(BM_LocationOffset)->Arg(64);
+BENCHMARK(BM_LocationOffsetFast)->Arg(64);
+
+BENCHMARK_MAIN();
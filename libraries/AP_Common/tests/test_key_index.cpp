@@ -0,0 +1,95 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_Common/AP_KeyIndex.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(KeyIndex, Basic)
+{
+    AP_KeyIndex index;
+    uint16_t pos;
+
+    // not initialised
+    EXPECT_FALSE(index.set(1, 0));
+    EXPECT_FALSE(index.find(1, pos));
+
+    ASSERT_TRUE(index.init(4));
+    EXPECT_EQ(4, index.capacity());
+    EXPECT_TRUE(index.set(0xABCDEF, 2));
+    EXPECT_TRUE(index.find(0xABCDEF, pos));
+    EXPECT_EQ(2, pos);
+
+    // replace the position of an existing key
+    EXPECT_TRUE(index.set(0xABCDEF, 3));
+    EXPECT_TRUE(index.find(0xABCDEF, pos));
+    EXPECT_EQ(3, pos);
+
+    index.remove(0xABCDEF);
+    EXPECT_FALSE(index.find(0xABCDEF, pos));
+    index.remove(0xABCDEF);
+
+    // fill it
+    for (uint16_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(index.set(1000 + i, i));
+    }
+    index.clear();
+    EXPECT_FALSE(index.find(1000, pos));
+}
+
+// maintain a list the way AP_ADSB does, deleting by moving the last
+// item into the hole, and check the index against a linear search
+TEST(KeyIndex, MatchesLinearSearch)
+{
+    const uint16_t list_max = 500;
+    uint32_t list[list_max];
+    uint16_t count = 0;
+
+    AP_KeyIndex index;
+    ASSERT_TRUE(index.init(list_max));
+
+    uint32_t seed = 1;
+    for (uint32_t n = 0; n < 50000; n++) {
+        seed = seed * 1664525U + 1013904223U;
+        // few distinct keys so the same ones are updated and deleted often,
+        // multiples of 64 collide in the low bits
+        const uint32_t key = ((seed >> 8) % 2000) * 64;
+
+        int32_t found = -1;
+        for (uint16_t i = 0; i < count; i++) {
+            if (list[i] == key) {
+                found = i;
+                break;
+            }
+        }
+        uint16_t pos;
+        ASSERT_EQ(found >= 0, index.find(key, pos));
+        if (found >= 0) {
+            ASSERT_EQ(found, pos);
+        }
+
+        if (found >= 0 && (seed & 1)) {
+            // delete it
+            index.remove(key);
+            list[found] = list[count-1];
+            count--;
+            if (found != count) {
+                index.set(list[found], found);
+            }
+        } else if (found < 0 && count < list_max) {
+            list[count] = key;
+            EXPECT_TRUE(index.set(key, count));
+            count++;
+        }
+    }
+
+    // every key in the list can still be found
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t pos;
+        EXPECT_TRUE(index.find(list[i], pos));
+        EXPECT_EQ(i, pos);
+    }
+}
+
+AP_GTEST_MAIN()
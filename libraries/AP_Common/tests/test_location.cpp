@@ -322,6 +322,36 @@ TEST(Location, Distance)
 
 }
 
+// the fast forms stay within their documented error of the exact forms
+TEST(Location, FastDistance)
+{
+    for (int32_t lat = -900000000; lat <= 900000000; lat += 1234567) {
+        EXPECT_NEAR(Location::longitude_scale(lat), Location::longitude_scale_fast(lat), 3e-7);
+    }
+
+    const Location test_home{-35362938, 149165085, 100, Location::AltFrame::ABSOLUTE};
+    for (uint16_t i = 0; i < 360; i += 7) {
+        for (float dist = 1; dist < 100000; dist *= 3.7) {
+            Location test_loc = test_home;
+            test_loc.offset_bearing(i, dist);
+            EXPECT_NEAR(test_home.get_distance(test_loc), test_home.get_distance_fast(test_loc), 1e-6 * dist + 1e-4);
+            const Vector2f ne = test_home.get_distance_NE(test_loc);
+            const Vector2f ne_fast = test_home.get_distance_NE_fast(test_loc);
+            EXPECT_NEAR(ne.x, ne_fast.x, 1e-6 * dist + 1e-4);
+            EXPECT_NEAR(ne.y, ne_fast.y, 1e-6 * dist + 1e-4);
+            // both bearings round the offset to whole 1e-7 degree units
+            EXPECT_NEAR(0, wrap_PI(test_home.get_bearing(test_loc) - test_home.get_bearing_fast(test_loc)), 2.5e-6 + 0.02 / dist);
+
+            Location fast_loc = test_home;
+            test_loc = test_home;
+            test_loc.offset(ne.x, ne.y);
+            fast_loc.offset_fast(ne.x, ne.y);
+            EXPECT_NEAR(test_loc.lat, fast_loc.lat, 1);
+            EXPECT_NEAR(test_loc.lng, fast_loc.lng, 1 + 1e-6 * dist);
+        }
+    }
+}
+
 TEST(Location, Sanitize)
 {
     // we will sanitize test_loc with test_default_loc
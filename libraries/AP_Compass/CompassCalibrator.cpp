@@ -69,6 +69,7 @@
 #include <AP_GPS/AP_GPS.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_InternalError/AP_InternalError.h>
+#include <AP_Logger/AP_Logger.h>
 
 #define FIELD_RADIUS_MIN 150
 #define FIELD_RADIUS_MAX 950
@@ -211,8 +212,7 @@ void CompassCalibrator::update()
             if (_fit_step == 0) {
                 calc_initial_offset();
             }
-            run_sphere_fit();
-            _fit_step++;
+            run_timed_fit(false);
         }
     } else if (_status == Status::RUNNING_STEP_TWO) {
         if (_fit_step >= 35) {
@@ -221,16 +221,48 @@ void CompassCalibrator::update()
             } else {
                 set_status(Status::FAILED);
             }
-        } else if (_fit_step < 15) {
-            run_sphere_fit();
-            _fit_step++;
         } else {
-            run_ellipsoid_fit();
-            _fit_step++;
+            run_timed_fit(_fit_step >= 15);
         }
     }
 }
 
+// run one sphere or ellipsoid fit iteration and record how long it took
+void CompassCalibrator::run_timed_fit(bool ellipsoid)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    if (ellipsoid) {
+        run_ellipsoid_fit();
+    } else {
+        run_sphere_fit();
+    }
+    _fit_time_us = AP_HAL::micros() - start_us;
+
+#if HAL_LOGGING_ENABLED
+// @LoggerMessage: MCF
+// @Description: Compass calibration fit iteration
+// @Field: TimeUS: Time since system startup
+// @Field: I: compass instance
+// @Field: Stat: calibration status
+// @Field: Step: fit iteration
+// @Field: N: number of samples fitted
+// @Field: Fit: RMS residual after this iteration
+// @Field: Lam: damping factor for the next iteration
+// @Field: FitUS: time taken by this iteration
+    AP::logger().Write("MCF", "TimeUS,I,Stat,Step,N,Fit,Lam,FitUS", "s#-----s", "F------F", "QBBHHffI",
+                       AP_HAL::micros64(),
+                       _compass_idx,
+                       uint8_t(_status),
+                       _fit_step,
+                       _samples_collected,
+                       sqrtf(_fitness),
+                       ellipsoid ? _ellipsoid_lambda : _sphere_lambda,
+                       _fit_time_us);
+#endif
+
+    _fit_step++;
+}
+
 void CompassCalibrator::pull_sample()
 {
     CompassSample mag_sample;
@@ -247,7 +279,8 @@ void CompassCalibrator::pull_sample()
     }
     if (_running() && _samples_collected < COMPASS_CAL_NUM_SAMPLES && accept_sample(mag_sample.get())) {
         update_completion_mask(mag_sample.get());
-        _sample_buffer[_samples_collected] = mag_sample;
+        store_sample(_samples_collected, mag_sample);
+        _sample_sum += mag_sample.get();
         _samples_collected++;
     }
 }
@@ -292,7 +325,7 @@ void CompassCalibrator::update_completion_mask()
 {
     memset(_completion_mask, 0, sizeof(_completion_mask));
     for (int i = 0; i < _samples_collected; i++) {
-        update_completion_mask(_sample_buffer[i].get());
+        update_completion_mask(Vector3f(_sample_cache->x[i], _sample_cache->y[i], _sample_cache->z[i]));
     }
 }
 
@@ -371,6 +404,8 @@ void CompassCalibrator::reset_state()
 {
     _samples_collected = 0;
     _samples_thinned = 0;
+    _sample_sum.zero();
+    _fit_time_us = 0;
     _params.radius = 200;
     _params.offset.zero();
     _params.diag = Vector3f(1.0f,1.0f,1.0f);
@@ -391,10 +426,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
         case Status::NOT_STARTED:
             reset_state();
             _status = Status::NOT_STARTED;
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_samples();
             return true;
 
         case Status::WAITING_TO_START:
@@ -416,7 +448,10 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
             if (_sample_buffer == nullptr) {
                 _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
             }
-            if (_sample_buffer != nullptr) {
+            if (_sample_cache == nullptr) {
+                _sample_cache = (SampleCache*)calloc(1, sizeof(SampleCache));
+            }
+            if (_sample_buffer != nullptr && _sample_cache != nullptr) {
                 initialize_fit();
                 _status = Status::RUNNING_STEP_ONE;
                 return true;
@@ -437,10 +472,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return false;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_samples();
 
             _status = Status::SUCCESS;
             return true;
@@ -464,10 +496,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return true;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_samples();
 
             _status = status;
             return true;
@@ -506,15 +535,16 @@ void CompassCalibrator::thin_samples()
     // this is so that adjacent samples don't get sequentially eliminated
     for (uint16_t i=_samples_collected-1; i>=1; i--) {
         uint16_t j = get_random16() % (i+1);
-        CompassSample temp = _sample_buffer[i];
-        _sample_buffer[i] = _sample_buffer[j];
-        _sample_buffer[j] = temp;
+        const CompassSample temp = _sample_buffer[i];
+        store_sample(i, _sample_buffer[j]);
+        store_sample(j, temp);
     }
 
     // remove any samples that are close together
     for (uint16_t i=0; i < _samples_collected; i++) {
         if (!accept_sample(_sample_buffer[i], i)) {
-            _sample_buffer[i] = _sample_buffer[_samples_collected-1];
+            _sample_sum -= _sample_buffer[i].get();
+            store_sample(i, _sample_buffer[_samples_collected-1]);
             _samples_collected--;
             _samples_thinned++;
         }
@@ -545,16 +575,19 @@ bool CompassCalibrator::accept_sample(const Vector3f& sample, uint16_t skip_inde
     static const float a = (4.0f * M_PI / (3.0f * faces)) + M_PI / 3.0f;
     static const float theta = 0.5f * acosf(cosf(a) / (1.0f - cosf(a)));
 
-    if (_sample_buffer == nullptr) {
+    if (_sample_cache == nullptr) {
         return false;
     }
 
-    float min_distance = _params.radius * 2*sinf(theta/2);
+    // compare squared distances against the cached samples
+    const float min_distance_sq = sq(_params.radius * 2*sinf(theta/2));
 
     for (uint16_t i = 0; i<_samples_collected; i++) {
         if (i != skip_index) {
-            float distance = (sample - _sample_buffer[i].get()).length();
-            if (distance < min_distance) {
+            const float distance_sq = sq(sample.x - _sample_cache->x[i],
+                                         sample.y - _sample_cache->y[i],
+                                         sample.z - _sample_cache->z[i]);
+            if (distance_sq < min_distance_sq) {
                 return false;
             }
         }
@@ -567,65 +600,131 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
     return accept_sample(sample.get(), skip_index);
 }
 
-float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
+// calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
+float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) const
 {
-    Matrix3f softiron(
+    if (_sample_cache == nullptr || _samples_collected == 0) {
+        return 1.0e30f;
+    }
+    const Matrix3f softiron(
         params.diag.x    , params.offdiag.x , params.offdiag.y,
         params.offdiag.x , params.diag.y    , params.offdiag.z,
         params.offdiag.y , params.offdiag.z , params.diag.z
     );
-    return params.radius - (softiron*(sample+params.offset)).length();
+    float sum = 0.0f;
+    for (uint16_t i=0; i < _samples_collected; i++) {
+        const Vector3f sample(_sample_cache->x[i], _sample_cache->y[i], _sample_cache->z[i]);
+        sum += sq(params.radius - (softiron*(sample+params.offset)).length());
+    }
+    sum /= _samples_collected;
+    return sum;
 }
 
-// calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
-float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) const
+// calc the fitness of two sets of parameters in a single pass over the samples
+void CompassCalibrator::calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fit1, float &fit2) const
 {
-    if (_sample_buffer == nullptr || _samples_collected == 0) {
-        return 1.0e30f;
+    if (_sample_cache == nullptr || _samples_collected == 0) {
+        fit1 = fit2 = 1.0e30f;
+        return;
     }
-    float sum = 0.0f;
+    const Matrix3f softiron1(
+        params1.diag.x    , params1.offdiag.x , params1.offdiag.y,
+        params1.offdiag.x , params1.diag.y    , params1.offdiag.z,
+        params1.offdiag.y , params1.offdiag.z , params1.diag.z
+    );
+    const Matrix3f softiron2(
+        params2.diag.x    , params2.offdiag.x , params2.offdiag.y,
+        params2.offdiag.x , params2.diag.y    , params2.offdiag.z,
+        params2.offdiag.y , params2.offdiag.z , params2.diag.z
+    );
+    float sum1 = 0.0f;
+    float sum2 = 0.0f;
     for (uint16_t i=0; i < _samples_collected; i++) {
-        Vector3f sample = _sample_buffer[i].get();
-        float resid = calc_residual(sample, params);
-        sum += sq(resid);
+        const Vector3f sample(_sample_cache->x[i], _sample_cache->y[i], _sample_cache->z[i]);
+        sum1 += sq(params1.radius - (softiron1*(sample+params1.offset)).length());
+        sum2 += sq(params2.radius - (softiron2*(sample+params2.offset)).length());
     }
-    sum /= _samples_collected;
-    return sum;
+    fit1 = sum1 / _samples_collected;
+    fit2 = sum2 / _samples_collected;
 }
 
 // calculate initial offsets by simply taking the average values of the samples
 void CompassCalibrator::calc_initial_offset()
 {
-    // Set initial offset to the average value of the samples
-    _params.offset.zero();
-    for (uint16_t k = 0; k < _samples_collected; k++) {
-        _params.offset -= _sample_buffer[k].get();
-    }
-    _params.offset /= _samples_collected;
+    // Set initial offset to the average value of the samples, the sum
+    // is kept up to date as samples are added to the buffer
+    _params.offset = -_sample_sum / _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+/*
+  accumulate the normal equations J^T.J and J^T.residual for all
+  samples in a single pass over the sample cache. The residual and the
+  jacobian share the soft iron corrected sample, so each sample is
+  corrected once per pass. N is COMPASS_CAL_NUM_SPHERE_PARAMS for the
+  sphere fit (radius, offsets) or COMPASS_CAL_NUM_ELLIPSOID_PARAMS for
+  the ellipsoid fit (offsets, diagonals, off diagonals)
+ */
+template <uint8_t N>
+void CompassCalibrator::calc_normal_equations(const param_t& params, float *JTJ, float *JTFI) const
 {
+    static_assert(N == COMPASS_CAL_NUM_SPHERE_PARAMS || N == COMPASS_CAL_NUM_ELLIPSOID_PARAMS, "unknown fit");
+
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0: partial derivative (radius wrt fitness fn) fn operated on sample
-    ret[0] = 1.0f;
-    // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    memset(JTJ, 0, N*N*sizeof(float));
+    memset(JTFI, 0, N*sizeof(float));
+
+    for (uint16_t k = 0; k < _samples_collected; k++) {
+        const float x = _sample_cache->x[k] + offset.x;
+        const float y = _sample_cache->y[k] + offset.y;
+        const float z = _sample_cache->z[k] + offset.z;
+
+        // soft iron corrected sample
+        const float A = (diag.x    * x) + (offdiag.x * y) + (offdiag.y * z);
+        const float B = (offdiag.x * x) + (diag.y    * y) + (offdiag.z * z);
+        const float C = (offdiag.y * x) + (offdiag.z * y) + (diag.z    * z);
+        const float length = norm(A, B, C);
+        const float residual = params.radius - length;
+
+        // partial derivatives of the residual, in the order of
+        // get_sphere_params() or get_ellipsoid_params()
+        float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        uint8_t n = 0;
+        if (N == COMPASS_CAL_NUM_SPHERE_PARAMS) {
+            // radius
+            jacob[n++] = 1.0f;
+        }
+        // offsets
+        jacob[n++] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
+        jacob[n++] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
+        jacob[n++] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+        if (N == COMPASS_CAL_NUM_ELLIPSOID_PARAMS) {
+            // diagonals
+            jacob[n++] = -1.0f * (x * A)/length;
+            jacob[n++] = -1.0f * (y * B)/length;
+            jacob[n++] = -1.0f * (z * C)/length;
+            // off diagonals
+            jacob[n++] = -1.0f * ((y * A) + (x * B))/length;
+            jacob[n++] = -1.0f * ((z * A) + (x * C))/length;
+            jacob[n++] = -1.0f * ((z * B) + (y * C))/length;
+        }
+
+        // J^T.J is symmetric, only the upper triangle is accumulated
+        for (uint8_t i = 0; i < N; i++) {
+            for (uint8_t j = i; j < N; j++) {
+                JTJ[i*N+j] += jacob[i] * jacob[j];
+            }
+            JTFI[i] += jacob[i] * residual;
+        }
+    }
+
+    for (uint8_t i = 1; i < N; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*N+j] = JTJ[j*N+i];
+        }
+    }
 }
 
 // run sphere fit to calculate diagonals and offdiagonals
@@ -643,28 +742,13 @@ void CompassCalibrator::run_sphere_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
+    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
+    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS];
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations<COMPASS_CAL_NUM_SPHERE_PARAMS>(fit1_params, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    //a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -690,8 +774,7 @@ void CompassCalibrator::run_sphere_fit()
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -715,36 +798,6 @@ void CompassCalibrator::run_sphere_fit()
     }
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
-{
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
-    // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
-    // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
-}
-
 void CompassCalibrator::run_ellipsoid_fit()
 {
     if (_sample_buffer == nullptr) {
@@ -759,28 +812,13 @@ void CompassCalibrator::run_ellipsoid_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations<COMPASS_CAL_NUM_ELLIPSOID_PARAMS>(fit1_params, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    //a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -806,8 +844,7 @@ void CompassCalibrator::run_ellipsoid_fit()
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -832,6 +869,25 @@ void CompassCalibrator::run_ellipsoid_fit()
 }
 
 
+// store a sample in the buffer and its decompressed copy in the cache
+void CompassCalibrator::store_sample(uint16_t i, const CompassSample &sample)
+{
+    _sample_buffer[i] = sample;
+    const Vector3f v = sample.get();
+    _sample_cache->x[i] = v.x;
+    _sample_cache->y[i] = v.y;
+    _sample_cache->z[i] = v.z;
+}
+
+// free the sample buffer and cache
+void CompassCalibrator::free_samples()
+{
+    free(_sample_buffer);
+    _sample_buffer = nullptr;
+    free(_sample_cache);
+    _sample_cache = nullptr;
+}
+
 //////////////////////////////////////////////////////////
 //////////// CompassSample public interface //////////////
 //////////////////////////////////////////////////////////
@@ -1050,11 +1106,15 @@ bool CompassCalibrator::calculate_orientation(void)
     _params.offset = rot_offsets;
 
     // rotate the samples for the new orientation
+    _sample_sum.zero();
     for (uint32_t i=0; i<_samples_collected; i++) {
         Vector3f s = _sample_buffer[i].get();
         s.rotate_inverse(_orientation);
         s.rotate(besti);
-        _sample_buffer[i].set(s);
+        CompassSample sample = _sample_buffer[i];
+        sample.set(s);
+        store_sample(i, sample);
+        _sample_sum += sample.get();
     }
 
     _orientation = besti;
@@ -146,6 +146,21 @@ private:
         int16_t z;
     };
 
+    // decompressed copy of the sample buffer with one array per axis, so
+    // the fits stream through contiguous floats instead of unpacking
+    // every sample on every pass
+    struct SampleCache {
+        float x[COMPASS_CAL_NUM_SAMPLES];
+        float y[COMPASS_CAL_NUM_SAMPLES];
+        float z[COMPASS_CAL_NUM_SAMPLES];
+    };
+
+    // store a sample in the buffer and its decompressed copy in the cache
+    void store_sample(uint16_t i, const CompassSample &sample);
+
+    // free the sample buffer and cache
+    void free_samples();
+
     // set status including any required initialisation
     bool set_status(Status status);
 
@@ -171,24 +186,30 @@ private:
     // thins out samples between step one and step two
     void thin_samples();
 
-    // calc the fitness of a single sample vs a set of parameters (offsets, diagonals, off diagonals)
-    float calc_residual(const Vector3f& sample, const param_t& params) const;
-
     // calc the fitness of the parameters (offsets, diagonals, off diagonals) vs all the samples collected
     // returns 1.0e30f if the sample buffer is empty
     float calc_mean_squared_residuals(const param_t& params) const;
 
+    // calc the fitness of two sets of parameters in a single pass over the samples
+    void calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fit1, float &fit2) const;
+
+    // accumulate J^T.J and J^T.residual over all samples in a single
+    // pass. N selects the sphere or ellipsoid parameters
+    template <uint8_t N>
+    void calc_normal_equations(const param_t& params, float *JTJ, float *JTFI) const;
+
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
     // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_sphere_fit();
 
     // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_ellipsoid_fit();
 
+    // run one sphere or ellipsoid fit iteration and record how long it took
+    void run_timed_fit(bool ellipsoid);
+
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
 
@@ -224,6 +245,8 @@ private:
     uint8_t _attempt;                       // number of attempts have been made to calibrate
     completion_mask_t _completion_mask;     // bitmask of directions in which we have samples
     CompassSample *_sample_buffer;          // buffer of sensor values
+    SampleCache *_sample_cache;             // decompressed copy of _sample_buffer used by the fits
+    Vector3f _sample_sum;                   // sum of the samples in the buffer, used for the initial offset
     uint16_t _samples_collected;            // number of samples in buffer
     uint16_t _samples_thinned;              // number of samples removed by the thin_samples() call (called before step 2 begins)
 
@@ -234,6 +257,7 @@ private:
     float _initial_fitness;                 // fitness before latest "fit" was attempted (used to determine if fit was an improvement)
     float _sphere_lambda;                   // sphere fit's lambda
     float _ellipsoid_lambda;                // ellipsoid fit's lambda
+    uint32_t _fit_time_us;                  // duration of the latest fit iteration
 
     // variables for orientation checking
     enum Rotation _orientation;             // latest detected orientation
@@ -21,6 +21,7 @@
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_Common/AP_FWVersion.h>
 #include <AP_ExternalControl/AP_ExternalControl_config.h>
+#include <AP_Logger/AP_Logger.h>
 
 #if AP_DDS_ARM_SERVER_ENABLED
 #include "ardupilot_msgs/srv/ArmMotors.h"
@@ -52,43 +53,7 @@
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-#if AP_DDS_TIME_PUB_ENABLED
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = AP_DDS_DELAY_TIME_TOPIC_MS;
-#endif // AP_DDS_TIME_PUB_ENABLED
-#if AP_DDS_BATTERY_STATE_PUB_ENABLED
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS;
-#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
-#if AP_DDS_IMU_PUB_ENABLED
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = AP_DDS_DELAY_IMU_TOPIC_MS;
-#endif // AP_DDS_IMU_PUB_ENABLED
-#if AP_DDS_LOCAL_POSE_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS;
-#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
-#if AP_DDS_LOCAL_VEL_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS;
-#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
-#if AP_DDS_AIRSPEED_PUB_ENABLED
-static constexpr uint16_t DELAY_AIRSPEED_TOPIC_MS = AP_DDS_DELAY_AIRSPEED_TOPIC_MS;
-#endif // AP_DDS_AIRSPEED_PUB_ENABLED
-#if AP_DDS_RC_PUB_ENABLED
-static constexpr uint16_t DELAY_RC_TOPIC_MS = AP_DDS_DELAY_RC_TOPIC_MS;
-#endif // AP_DDS_RC_PUB_ENABLED
-#if AP_DDS_GEOPOSE_PUB_ENABLED
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = AP_DDS_DELAY_GEO_POSE_TOPIC_MS;
-#endif // AP_DDS_GEOPOSE_PUB_ENABLED
-#if AP_DDS_GOAL_PUB_ENABLED
-static constexpr uint16_t DELAY_GOAL_TOPIC_MS = AP_DDS_DELAY_GOAL_TOPIC_MS ;
-#endif // AP_DDS_GOAL_PUB_ENABLED
-#if AP_DDS_CLOCK_PUB_ENABLED
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS =AP_DDS_DELAY_CLOCK_TOPIC_MS;
-#endif // AP_DDS_CLOCK_PUB_ENABLED
-#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS;
-#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 static constexpr uint16_t DELAY_PING_MS = 500;
-#if AP_DDS_STATUS_PUB_ENABLED
-static constexpr uint16_t DELAY_STATUS_TOPIC_MS = AP_DDS_DELAY_STATUS_TOPIC_MS;
-#endif // AP_DDS_STATUS_PUB_ENABLED
 
 // Define the subscriber data members, which are static class scope.
 // If these are created on the stack in the subscriber,
@@ -169,6 +134,126 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
     // @User: Standard
     AP_GROUPINFO("_MAX_RETRY", 6, AP_DDS_Client, ping_max_retry, 10),
 
+#if AP_DDS_TIME_PUB_ENABLED
+    // @Param: _RATE_TIME
+    // @DisplayName: DDS Time rate
+    // @Description: Rate of the time topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TIME", 7, AP_DDS_Client, time_rate_hz, 1000 / AP_DDS_DELAY_TIME_TOPIC_MS),
+#endif
+
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    // @Param: _RATE_BATT
+    // @DisplayName: DDS Battery state rate
+    // @Description: Rate of the battery state topic, for each battery. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_BATT", 8, AP_DDS_Client, battery_state_rate_hz, 1000 / AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS),
+#endif
+
+#if AP_DDS_IMU_PUB_ENABLED
+    // @Param: _RATE_IMU
+    // @DisplayName: DDS IMU rate
+    // @Description: Rate of the IMU topic. Only new IMU samples are published. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_IMU", 9, AP_DDS_Client, imu_rate_hz, 1000 / AP_DDS_DELAY_IMU_TOPIC_MS),
+#endif
+
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    // @Param: _RATE_LPOSE
+    // @DisplayName: DDS Local pose rate
+    // @Description: Rate of the local pose topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_LPOSE", 10, AP_DDS_Client, local_pose_rate_hz, 1000 / AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS),
+#endif
+
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    // @Param: _RATE_LVEL
+    // @DisplayName: DDS Local velocity rate
+    // @Description: Rate of the local velocity topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_LVEL", 11, AP_DDS_Client, local_velocity_rate_hz, 1000 / AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS),
+#endif
+
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    // @Param: _RATE_ASPD
+    // @DisplayName: DDS Airspeed rate
+    // @Description: Rate of the airspeed topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ASPD", 12, AP_DDS_Client, airspeed_rate_hz, 1000 / AP_DDS_DELAY_AIRSPEED_TOPIC_MS),
+#endif
+
+#if AP_DDS_RC_PUB_ENABLED
+    // @Param: _RATE_RC
+    // @DisplayName: DDS RC rate
+    // @Description: Rate of the RC topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_RC", 13, AP_DDS_Client, rc_rate_hz, 1000 / AP_DDS_DELAY_RC_TOPIC_MS),
+#endif
+
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    // @Param: _RATE_GEOPOSE
+    // @DisplayName: DDS Geo pose rate
+    // @Description: Rate of the geo pose topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GEOPOSE", 14, AP_DDS_Client, geo_pose_rate_hz, 1000 / AP_DDS_DELAY_GEO_POSE_TOPIC_MS),
+#endif
+
+#if AP_DDS_CLOCK_PUB_ENABLED
+    // @Param: _RATE_CLOCK
+    // @DisplayName: DDS Clock rate
+    // @Description: Rate of the clock topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_CLOCK", 15, AP_DDS_Client, clock_rate_hz, 1000 / AP_DDS_DELAY_CLOCK_TOPIC_MS),
+#endif
+
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    // @Param: _RATE_ORIGIN
+    // @DisplayName: DDS GPS global origin rate
+    // @Description: Rate of the GPS global origin topic. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ORIGIN", 16, AP_DDS_Client, gps_global_origin_rate_hz, 1000 / AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS),
+#endif
+
+#if AP_DDS_GOAL_PUB_ENABLED
+    // @Param: _RATE_GOAL
+    // @DisplayName: DDS Goal rate
+    // @Description: Rate of checking the goal topic, which is only published when the goal changes. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GOAL", 17, AP_DDS_Client, goal_rate_hz, 1000 / AP_DDS_DELAY_GOAL_TOPIC_MS),
+#endif
+
+#if AP_DDS_STATUS_PUB_ENABLED
+    // @Param: _RATE_STATUS
+    // @DisplayName: DDS Status rate
+    // @Description: Rate of checking the status topic, which is only published when the status changes. Set to 0 to disable. Can be changed in flight
+    // @Units: Hz
+    // @Range: 0 400
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_STATUS", 18, AP_DDS_Client, status_rate_hz, 1000 / AP_DDS_DELAY_STATUS_TOPIC_MS),
+#endif
+
     AP_GROUPEND
 };
 
@@ -1724,111 +1809,195 @@ void AP_DDS_Client::write_status_topic()
 }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
+/*
+  check if a topic published at rate_hz is due. Time is split into
+  periods of 1/rate_hz since boot and a topic is due once in each, so
+  the average rate is exact even when the period is not a whole number
+  of ms. After a stall it is published once rather than bursting to
+  catch up
+ */
+bool AP_DDS_Client::topic_due(uint64_t &last_ms, int16_t rate_hz, uint64_t now_ms)
+{
+    if (rate_hz <= 0) {
+        return false;
+    }
+    if ((now_ms * rate_hz) / 1000U == (last_ms * rate_hz) / 1000U) {
+        return false;
+    }
+    last_ms = now_ms;
+    return true;
+}
+
+void AP_DDS_Client::note_published(uint8_t topic_index, uint32_t since_us)
+{
+    if (!connected || topic_index >= ARRAY_SIZE(pub_stats)) {
+        return;
+    }
+    auto &st = pub_stats[topic_index];
+    const uint32_t latency_us = AP_HAL::micros() - since_us;
+    st.count++;
+    st.latency_sum_us += latency_us;
+    st.latency_max_us = MAX(st.latency_max_us, latency_us);
+}
+
+/*
+  log the rate and latency of each published topic
+ */
+void AP_DDS_Client::log_pub_stats(uint64_t now_ms)
+{
+    const uint32_t dt_ms = now_ms - last_pub_stats_ms;
+    if (dt_ms < 1000) {
+        return;
+    }
+    last_pub_stats_ms = now_ms;
+#if HAL_LOGGING_ENABLED
+    for (uint8_t i = 0; i < ARRAY_SIZE(pub_stats); i++) {
+        auto &st = pub_stats[i];
+        if (st.count == 0) {
+            continue;
+        }
+        // @LoggerMessage: DDSP
+        // @Description: DDS topic publish statistics
+        // @Field: TimeUS: Time since system startup
+        // @Field: Id: topic index
+        // @Field: Rate: publish rate
+        // @Field: Lat: average time from data sample or publish start to the output stream
+        // @Field: MaxLat: maximum latency
+        AP::logger().Write("DDSP", "TimeUS,Id,Rate,Lat,MaxLat",
+                           "s#zss", "F--FF", "QBfII",
+                           AP_HAL::micros64(),
+                           i,
+                           st.count * 1000.0f / dt_ms,
+                           st.latency_sum_us / st.count,
+                           st.latency_max_us);
+    }
+#endif
+    memset(pub_stats, 0, sizeof(pub_stats));
+}
+
 void AP_DDS_Client::update()
 {
+    static_assert(ARRAY_SIZE(topics) <= MAX_TOPICS, "MAX_TOPICS too small");
+
     WITH_SEMAPHORE(csem);
     const auto cur_time_ms = AP_HAL::millis64();
+    const uint32_t start_us = AP_HAL::micros();
+
+    /*
+      topics are only serialized into the output stream here. The
+      stream is flushed once for all of them by uxr_run_session_time()
+      at the end
+     */
 
 #if AP_DDS_TIME_PUB_ENABLED
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    if (topic_due(last_time_time_ms, time_rate_hz, cur_time_ms)) {
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
         write_time_topic();
+        note_published(to_underlying(TopicIndex::TIME_PUB), start_us);
     }
 #endif // AP_DDS_TIME_PUB_ENABLED
 #if AP_DDS_NAVSATFIX_PUB_ENABLED
     for (uint8_t gps_instance = 0; gps_instance < GPS_MAX_INSTANCES; gps_instance++) {
         if (update_topic(nav_sat_fix_topic, gps_instance)) {
             write_nav_sat_fix_topic();
+            note_published(to_underlying(TopicIndex::NAV_SAT_FIX_PUB), start_us);
         }
     }
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
+    if (topic_due(last_battery_state_time_ms, battery_state_rate_hz, cur_time_ms)) {
         for (uint8_t battery_instance = 0; battery_instance < AP_BATT_MONITOR_MAX_INSTANCES; battery_instance++) {
             update_topic(battery_state_topic, battery_instance);
             if (battery_state_topic.present) {
                 write_battery_state_topic();
+                note_published(to_underlying(TopicIndex::BATTERY_STATE_PUB), start_us);
             }
         }
-        last_battery_state_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
+    if (topic_due(last_local_pose_time_ms, local_pose_rate_hz, cur_time_ms)) {
         update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
         write_local_pose_topic();
+        note_published(to_underlying(TopicIndex::LOCAL_POSE_PUB), start_us);
     }
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
+    if (topic_due(last_local_velocity_time_ms, local_velocity_rate_hz, cur_time_ms)) {
         update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
         write_tx_local_velocity_topic();
+        note_published(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), start_us);
     }
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 #if AP_DDS_AIRSPEED_PUB_ENABLED
-    if (cur_time_ms - last_airspeed_time_ms > DELAY_AIRSPEED_TOPIC_MS) {
-        last_airspeed_time_ms = cur_time_ms;
+    if (topic_due(last_airspeed_time_ms, airspeed_rate_hz, cur_time_ms)) {
         if (update_topic(tx_local_airspeed_topic)) {
             write_tx_local_airspeed_topic();
+            note_published(to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB), start_us);
         }
     }
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_RC_PUB_ENABLED
-    if (cur_time_ms - last_rc_time_ms > DELAY_RC_TOPIC_MS) {
-        last_rc_time_ms = cur_time_ms;
+    if (topic_due(last_rc_time_ms, rc_rate_hz, cur_time_ms)) {
         if (update_topic(tx_local_rc_topic)) {
             write_tx_local_rc_topic();
+            note_published(to_underlying(TopicIndex::LOCAL_RC_PUB), start_us);
         }
     }
 #endif // AP_DDS_RC_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
-        update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
-        write_imu_topic();
+    {
+        // only publish IMU data we have not sent before
+        const uint32_t imu_sample_us = AP::ins().get_last_update_usec();
+        if (imu_sample_us != last_imu_sample_us &&
+            topic_due(last_imu_time_ms, imu_rate_hz, cur_time_ms)) {
+            last_imu_sample_us = imu_sample_us;
+            update_topic(imu_topic);
+            write_imu_topic();
+            note_published(to_underlying(TopicIndex::IMU_PUB), imu_sample_us);
+        }
     }
 #endif // AP_DDS_IMU_PUB_ENABLED
 #if AP_DDS_GEOPOSE_PUB_ENABLED
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
+    if (topic_due(last_geo_pose_time_ms, geo_pose_rate_hz, cur_time_ms)) {
         update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
         write_geo_pose_topic();
+        note_published(to_underlying(TopicIndex::GEOPOSE_PUB), start_us);
     }
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 #if AP_DDS_CLOCK_PUB_ENABLED
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
+    if (topic_due(last_clock_time_ms, clock_rate_hz, cur_time_ms)) {
         update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
         write_clock_topic();
+        note_published(to_underlying(TopicIndex::CLOCK_PUB), start_us);
     }
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
+    if (topic_due(last_gps_global_origin_time_ms, gps_global_origin_rate_hz, cur_time_ms)) {
         update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
         write_gps_global_origin_topic();
+        note_published(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), start_us);
     }
 #endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 #if AP_DDS_GOAL_PUB_ENABLED
-    if (cur_time_ms - last_goal_time_ms > DELAY_GOAL_TOPIC_MS) {
+    if (topic_due(last_goal_time_ms, goal_rate_hz, cur_time_ms)) {
         if (update_topic_goal(goal_topic)) {
             write_goal_topic();
+            note_published(to_underlying(TopicIndex::GOAL_PUB), start_us);
         }
-        last_goal_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_GOAL_PUB_ENABLED
 #if AP_DDS_STATUS_PUB_ENABLED
-    if (cur_time_ms - last_status_check_time_ms > DELAY_STATUS_TOPIC_MS) {
+    if (topic_due(last_status_check_time_ms, status_rate_hz, cur_time_ms)) {
         if (update_topic(status_topic)) {
             write_status_topic();
+            note_published(to_underlying(TopicIndex::STATUS_PUB), start_us);
         }
-        last_status_check_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
+    log_pub_stats(cur_time_ms);
+
     status_ok = uxr_run_session_time(&session, 1);
 }
 
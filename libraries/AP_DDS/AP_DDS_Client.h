@@ -104,6 +104,8 @@ private:
     builtin_interfaces_msg_Time time_topic;
     // The last ms timestamp AP_DDS wrote a Time message
     uint64_t last_time_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 time_rate_hz;
     //! @brief Serialize the current time state and publish to the IO stream(s)
     void write_time_topic();
     static void update_topic(builtin_interfaces_msg_Time& msg);
@@ -113,6 +115,8 @@ private:
     geographic_msgs_msg_GeoPointStamped gps_global_origin_topic;
     // The last ms timestamp AP_DDS wrote a gps global origin message
     uint64_t last_gps_global_origin_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 gps_global_origin_rate_hz;
     //! @brief Serialize the current gps global origin and publish to the IO stream(s)
     void write_gps_global_origin_topic();
     static void update_topic(geographic_msgs_msg_GeoPointStamped& msg);
@@ -122,6 +126,8 @@ private:
     geographic_msgs_msg_GeoPointStamped goal_topic;
     // The last ms timestamp AP_DDS wrote a goal message
     uint64_t last_goal_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 goal_rate_hz;
     //! @brief Serialize the current goal and publish to the IO stream(s)
     void write_goal_topic();
     bool update_topic_goal(geographic_msgs_msg_GeoPointStamped& msg);
@@ -132,6 +138,8 @@ private:
     geographic_msgs_msg_GeoPoseStamped geo_pose_topic;
     // The last ms timestamp AP_DDS wrote a GeoPose message
     uint64_t last_geo_pose_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 geo_pose_rate_hz;
     //! @brief Serialize the current geo_pose and publish to the IO stream(s)
     void write_geo_pose_topic();
     static void update_topic(geographic_msgs_msg_GeoPoseStamped& msg);
@@ -141,6 +149,8 @@ private:
     geometry_msgs_msg_PoseStamped local_pose_topic;
     // The last ms timestamp AP_DDS wrote a Local Pose message
     uint64_t last_local_pose_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 local_pose_rate_hz;
     //! @brief Serialize the current local_pose and publish to the IO stream(s)
     void write_local_pose_topic();
     static void update_topic(geometry_msgs_msg_PoseStamped& msg);
@@ -150,6 +160,8 @@ private:
     geometry_msgs_msg_TwistStamped tx_local_velocity_topic;
     // The last ms timestamp AP_DDS wrote a Local Velocity message
     uint64_t last_local_velocity_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 local_velocity_rate_hz;
     //! @brief Serialize the current local velocity and publish to the IO stream(s)
     void write_tx_local_velocity_topic();
     static void update_topic(geometry_msgs_msg_TwistStamped& msg);
@@ -159,6 +171,8 @@ private:
     ardupilot_msgs_msg_Airspeed tx_local_airspeed_topic;
     // The last ms timestamp AP_DDS wrote a airspeed message
     uint64_t last_airspeed_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 airspeed_rate_hz;
     //! @brief Serialize the current local airspeed and publish to the IO stream(s)
     void write_tx_local_airspeed_topic();
     static bool update_topic(ardupilot_msgs_msg_Airspeed& msg);
@@ -168,6 +182,8 @@ private:
     ardupilot_msgs_msg_Rc tx_local_rc_topic;
     // The last ms timestamp AP_DDS wrote a rc message
     uint64_t last_rc_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 rc_rate_hz;
     //! @brief Serialize the current local rc and publish to the IO stream(s)
     void write_tx_local_rc_topic();
     static bool update_topic(ardupilot_msgs_msg_Rc& msg);
@@ -177,6 +193,8 @@ private:
     sensor_msgs_msg_BatteryState battery_state_topic;
     // The last ms timestamp AP_DDS wrote a BatteryState message
     uint64_t last_battery_state_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 battery_state_rate_hz;
     //! @brief Serialize the current nav_sat_fix state and publish it to the IO stream(s)
     void write_battery_state_topic();
     static void update_topic(sensor_msgs_msg_BatteryState& msg, const uint8_t instance);
@@ -195,6 +213,10 @@ private:
     sensor_msgs_msg_Imu imu_topic;
     // The last ms timestamp AP_DDS wrote an IMU message
     uint64_t last_imu_time_ms;
+    // sample time of the IMU data last published, to only send new data
+    uint32_t last_imu_sample_us;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 imu_rate_hz;
     static void update_topic(sensor_msgs_msg_Imu& msg);
     //! @brief Serialize the current IMU data and publish to the IO stream(s)
     void write_imu_topic();
@@ -204,6 +226,8 @@ private:
     rosgraph_msgs_msg_Clock clock_topic;
     // The last ms timestamp AP_DDS wrote a Clock message
     uint64_t last_clock_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 clock_rate_hz;
     //! @brief Serialize the current clock and publish to the IO stream(s)
     void write_clock_topic();
     static void update_topic(rosgraph_msgs_msg_Clock& msg);
@@ -214,6 +238,8 @@ private:
     bool update_topic(ardupilot_msgs_msg_Status& msg);
     // The last ms timestamp AP_DDS wrote/checked a status message
     uint64_t last_status_check_time_ms;
+    // publish rate in Hz, 0 to disable
+    AP_Int16 status_rate_hz;
     // last status values;
     ardupilot_msgs_msg_Status last_status_msg_;
     //! @brief Serialize the current status and publish to the IO stream(s)
@@ -308,6 +334,26 @@ private:
     // client key we present
     static constexpr uint32_t key = 0xAAAABBBB;
 
+    //! @brief Check if a topic published at rate_hz is due
+    //! @param last_ms Time the topic was last due, updated when due
+    //! @return True if the topic should be published now
+    static bool topic_due(uint64_t &last_ms, int16_t rate_hz, uint64_t now_ms);
+
+    //! @brief Publish statistics for each topic, logged once a second
+    struct PubStats {
+        uint16_t count;
+        uint32_t latency_sum_us;
+        uint32_t latency_max_us;
+    };
+    static constexpr uint8_t MAX_TOPICS = 32;
+    PubStats pub_stats[MAX_TOPICS];
+    uint64_t last_pub_stats_ms;
+
+    //! @brief Record a publish of a topic
+    //! @param since_us Time the data was sampled or the publish started
+    void note_published(uint8_t topic_index, uint32_t since_us);
+    void log_pub_stats(uint64_t now_ms);
+
 
 public:
     ~AP_DDS_Client();
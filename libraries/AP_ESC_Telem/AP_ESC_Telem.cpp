@@ -85,6 +85,24 @@ uint8_t AP_ESC_Telem::get_motor_frequencies_hz(uint8_t nfreqs, float* freqs) con
 {
     uint8_t valid_escs = 0;
 
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+    RpmSnapshot snap;
+    if (get_rpm_snapshot(snap)) {
+        const uint32_t now_us = AP_HAL::micros();
+        // if we have ever received data on an ESC, mark it as valid but with no data
+        // this prevents large frequency shifts when ESCs disappear
+        for (uint32_t mask = snap.reported_mask; mask != 0 && valid_escs < nfreqs; mask &= mask - 1) {
+            float rpm;
+            if (snap.get_rpm(__builtin_ctz(mask), now_us, rpm)) {
+                freqs[valid_escs++] = rpm * (1.0f / 60.0f);
+            } else {
+                freqs[valid_escs++] = 0.0f;
+            }
+        }
+        return valid_escs;
+    }
+#endif
+
     // average the rpm of each motor as reported by BLHeli and convert to Hz
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS && valid_escs < nfreqs; i++) {
         float rpm;
@@ -605,6 +623,10 @@ void AP_ESC_Telem::update_rpm(const uint8_t esc_index, const float new_rpm, cons
     rpmdata.error_rate = error_rate;
     rpmdata.data_valid = true;
 
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+    publish_rpm(1U << esc_index);
+#endif
+
 #ifdef ESC_TELEM_DEBUG
     hal.console->printf("RPM: rate=%.1fhz, rpm=%f)\n", rpmdata.update_rate_hz, new_rpm);
 #endif
@@ -797,12 +819,16 @@ void AP_ESC_Telem::update()
     }
 #endif  // HAL_LOGGING_ENABLED
 
+    uint32_t invalidated_mask = 0;
     for (uint8_t i = 0; i < ESC_TELEM_MAX_ESCS; i++) {
         // copy the last_updated_us timestamp to avoid any race issues
         const uint32_t last_updated_us = _rpm_data[i].last_update_us;
         const uint32_t now_us = AP_HAL::micros();
         // Invalidate RPM data if not received for too long
         if (AP_HAL::timeout_expired(last_updated_us, now_us, ESC_RPM_DATA_TIMEOUT_US)) {
+            if (_rpm_data[i].data_valid) {
+                invalidated_mask |= 1U << i;
+            }
             _rpm_data[i].data_valid = false;
         }
         const uint32_t last_telem_data_ms = _telem_data[i].last_update_ms;
@@ -812,8 +838,99 @@ void AP_ESC_Telem::update()
             _telem_data[i].any_data_valid = false;
         }
     }
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+    if (invalidated_mask != 0) {
+        publish_rpm(invalidated_mask);
+    }
+#else
+    (void)invalidated_mask;
+#endif
+}
+
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+/*
+  publish a new RPM snapshot. Only the ESCs that changed, and those
+  changed by the previous publish, are copied, so the cost does not
+  grow with the number of motors
+ */
+void AP_ESC_Telem::publish_rpm(uint32_t esc_mask)
+{
+    WITH_SEMAPHORE(_rpm_snapshot_sem);
+
+    const uint32_t version = _rpm_snapshot_version.load(std::memory_order_relaxed);
+    const RpmSnapshot &front = _rpm_snapshot[version & 1U];
+    RpmSnapshot &back = _rpm_snapshot[(version + 1) & 1U];
+
+    // readers of the previous snapshot must see the version change
+    // before any of our writes to its buffer
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // bring the back buffer up to date with the front
+    for (uint32_t mask = _rpm_snapshot_stale_mask & ~esc_mask; mask != 0; mask &= mask - 1) {
+        const uint8_t i = __builtin_ctz(mask);
+        back.last_update_us[i] = front.last_update_us[i];
+        back.rpm[i] = front.rpm[i];
+        back.prev_rpm[i] = front.prev_rpm[i];
+        back.update_rate_hz[i] = front.update_rate_hz[i];
+    }
+
+    uint32_t valid_mask = front.valid_mask & ~esc_mask;
+    uint32_t reported_mask = front.reported_mask & ~esc_mask;
+    for (uint32_t mask = esc_mask; mask != 0; mask &= mask - 1) {
+        const uint8_t i = __builtin_ctz(mask);
+        const volatile AP_ESC_Telem_Backend::RpmData &rpmdata = _rpm_data[i];
+        float scale = 1.0f;
+#if AP_SCRIPTING_ENABLED
+        if ((1U<<i) & rpm_scale_mask) {
+            scale = rpm_scale_factor[i];
+        }
+#endif
+        back.last_update_us[i] = rpmdata.last_update_us;
+        back.rpm[i] = rpmdata.rpm * scale;
+        back.prev_rpm[i] = rpmdata.prev_rpm * scale;
+        back.update_rate_hz[i] = rpmdata.update_rate_hz;
+        if (rpmdata.data_valid) {
+            valid_mask |= 1U << i;
+        }
+        if (was_rpm_data_ever_reported(rpmdata)) {
+            reported_mask |= 1U << i;
+        }
+    }
+    back.valid_mask = valid_mask;
+    back.reported_mask = reported_mask;
+    back.version = version + 1;
+
+    _rpm_snapshot_stale_mask = esc_mask;
+    _rpm_snapshot_version.store(version + 1, std::memory_order_release);
+}
+
+bool AP_ESC_Telem::get_rpm_snapshot(RpmSnapshot &snap) const
+{
+    for (uint8_t tries = 0; tries < 3; tries++) {
+        const uint32_t version = _rpm_snapshot_version.load(std::memory_order_acquire);
+        snap = _rpm_snapshot[version & 1U];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_rpm_snapshot_version.load(std::memory_order_relaxed) == version) {
+            return true;
+        }
+    }
+    return false;
 }
 
+// get an individual ESC's slewed rpm from a snapshot, returns true on success
+bool AP_ESC_Telem::RpmSnapshot::get_rpm(uint8_t esc_index, uint32_t now_us, float& slewed_rpm) const
+{
+    if (esc_index >= ESC_TELEM_MAX_ESCS ||
+        (valid_mask & (1U << esc_index)) == 0 ||
+        is_zero(update_rate_hz[esc_index])) {
+        return false;
+    }
+    const float slew = MIN(1.0f, (now_us - last_update_us[esc_index]) * update_rate_hz[esc_index] * (1.0f / 1e6f));
+    slewed_rpm = prev_rpm[esc_index] + (rpm[esc_index] - prev_rpm[esc_index]) * slew;
+    return true;
+}
+#endif  // AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+
 // NOTE: This function should only be used to check timeouts other than 
 // ESC_RPM_DATA_TIMEOUT_US. Timeouts equal to ESC_RPM_DATA_TIMEOUT_US should
 // use RpmData::data_valid, which is cheaper and achieves the same result.
@@ -848,6 +965,9 @@ void AP_ESC_Telem::set_rpm_scale(const uint8_t esc_index, const float scale_fact
     if (esc_index < ESC_TELEM_MAX_ESCS) {
         rpm_scale_factor[esc_index] = scale_factor;
         rpm_scale_mask |= (1U<<esc_index);
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+        publish_rpm(1U << esc_index);
+#endif
     }
 }
 #endif
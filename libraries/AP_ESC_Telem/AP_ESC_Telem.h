@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Param/AP_Param.h>
 #include <SRV_Channel/SRV_Channel_config.h>
@@ -92,6 +94,30 @@ public:
     // return all of the motor frequencies in Hz for dynamic filtering
     uint8_t get_motor_frequencies_hz(uint8_t nfreqs, float* freqs) const;
 
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+    /*
+      the RPM state of every ESC at one instant. A new snapshot is
+      published on every RPM update, so a consumer such as a set of
+      per-motor notches sees all motors from the same moment
+     */
+    struct RpmSnapshot {
+        uint32_t version;           // incremented on every publish
+        uint32_t valid_mask;        // ESCs with RPM data within ESC_RPM_DATA_TIMEOUT_US
+        uint32_t reported_mask;     // ESCs that have ever reported RPM
+        uint32_t last_update_us[ESC_TELEM_MAX_ESCS];
+        float rpm[ESC_TELEM_MAX_ESCS];              // scaled rpm
+        float prev_rpm[ESC_TELEM_MAX_ESCS];         // scaled rpm
+        float update_rate_hz[ESC_TELEM_MAX_ESCS];
+
+        // get an individual ESC's slewed rpm as of now_us, as get_rpm() does
+        bool get_rpm(uint8_t esc_index, uint32_t now_us, float& rpm) const;
+    };
+
+    // copy the latest snapshot without locking, returns false if
+    // it was republished under us on every attempt
+    bool get_rpm_snapshot(RpmSnapshot &snap) const;
+#endif
+
     // get the number of ESCs that sent valid telemetry data in the last ESC_TELEM_DATA_TIMEOUT_MS
     uint8_t get_num_active_escs() const;
 
@@ -143,6 +169,20 @@ private:
     static uint16_t merge_edt2_stress(uint16_t old_stress, uint16_t new_stress);
 #endif
 
+#if AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+    // copy the RPM state of the ESCs in esc_mask into a new snapshot
+    void publish_rpm(uint32_t esc_mask);
+
+    // double buffered, readers use the one selected by the low bit of
+    // the version and retry if the version changed while copying
+    RpmSnapshot _rpm_snapshot[2];
+    std::atomic<uint32_t> _rpm_snapshot_version;
+    // ESCs changed by the last publish, stale in the other buffer
+    uint32_t _rpm_snapshot_stale_mask;
+    // publishers come from several backend threads
+    HAL_Semaphore _rpm_snapshot_sem;
+#endif
+
     // rpm data
     volatile AP_ESC_Telem_Backend::RpmData _rpm_data[ESC_TELEM_MAX_ESCS];
     // telemetry data
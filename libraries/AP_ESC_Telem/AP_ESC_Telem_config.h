@@ -7,6 +7,16 @@
 #define HAL_WITH_ESC_TELEM ((NUM_SERVO_CHANNELS > 0) && ((HAL_SUPPORT_RCOUT_SERIAL || HAL_MAX_CAN_PROTOCOL_DRIVERS)))
 #endif
 
+// lock-free copy of all ESC RPMs for loop rate consumers, not
+// needed on the IOMCU
+#ifndef AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED
+#ifdef IOMCU_FW
+#define AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED 0
+#else
+#define AP_ESC_TELEM_RPM_SNAPSHOT_ENABLED HAL_WITH_ESC_TELEM
+#endif
+#endif
+
 #ifndef AP_EXTENDED_ESC_TELEM_ENABLED
 #define AP_EXTENDED_ESC_TELEM_ENABLED HAL_ENABLE_DRONECAN_DRIVERS
 #endif
@@ -26,6 +26,10 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Scripting/AP_Scripting.h>
+#include <GCS_MAVLink/GCS.h>
+#include <AP_Networking/AP_Networking.h>
+#include <AP_RCProtocol/AP_RCProtocol.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,6 +44,22 @@ static const SysFileList sysfs_file_list[] = {
     {"memory.txt"},
     {"uarts.txt"},
     {"timers.txt"},
+    {"spi.txt"},
+#if AP_SCRIPTING_ENABLED
+    {"scripts.txt"},
+#endif
+#if HAL_GCS_ENABLED
+    {"routes.txt"},
+#endif
+#if AP_MAVLINK_FTP_ENABLED
+    {"ftp.txt"},
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    {"net_ports.txt"},
+#endif
+#if AP_RCPROTOCOL_ENABLED && AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    {"rcin.txt"},
+#endif
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
 #endif
@@ -120,6 +140,37 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+    if (strcmp(fname, "spi.txt") == 0 && hal.spi != nullptr) {
+        hal.spi->bus_info(*r.str);
+    }
+#if AP_SCRIPTING_ENABLED
+    if (strcmp(fname, "scripts.txt") == 0) {
+        AP_Scripting *scripting = AP_Scripting::get_singleton();
+        if (scripting != nullptr) {
+            scripting->scripts_info(*r.str);
+        }
+    }
+#endif
+#if HAL_GCS_ENABLED
+    if (strcmp(fname, "routes.txt") == 0) {
+        GCS_MAVLINK::routing_info(*r.str);
+    }
+#endif
+#if AP_MAVLINK_FTP_ENABLED
+    if (strcmp(fname, "ftp.txt") == 0) {
+        GCS_MAVLINK::ftp_info(*r.str);
+    }
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    if (strcmp(fname, "net_ports.txt") == 0) {
+        AP::network().ports_info(*r.str);
+    }
+#endif
+#if AP_RCPROTOCOL_ENABLED && AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    if (strcmp(fname, "rcin.txt") == 0) {
+        AP::RC().detection_info(*r.str);
+    }
+#endif
 #if HAL_CANMANAGER_ENABLED
     if (strcmp(fname, "can_log.txt") == 0) {
         AP::can().log_retrieve(*r.str);
@@ -879,7 +879,13 @@ void AP_GPS::update_instance(uint8_t instance)
     }
 
     // we have an active driver for this instance
+#if AP_GPS_PARSE_STATS_ENABLED
+    const uint32_t read_start_us = AP_HAL::micros();
+#endif
     bool result = drivers[instance]->read();
+#if AP_GPS_PARSE_STATS_ENABLED
+    update_parse_stats(instance, read_start_us);
+#endif
     uint32_t tnow = AP_HAL::millis();
 
     // if we did not get a message, and the idle timer of 2 seconds
@@ -1631,8 +1637,11 @@ bool AP_GPS::parse_rtcm_injection(mavlink_channel_t chan, const mavlink_gps_rtcm
         }
         GCS_SEND_TEXT(MAV_SEVERITY_INFO, "GPS: RTCM parsing for chan %u", unsigned(chan));
     }
-    for (uint16_t i=0; i<pkt.len; i++) {
-        if (rtcm.parsers[chan]->read(pkt.data[i])) {
+    uint16_t i = 0;
+    while (i < pkt.len) {
+        bool found;
+        i += rtcm.parsers[chan]->read(&pkt.data[i], pkt.len - i, found);
+        if (found) {
             // we have a full message, inject it
             const uint8_t *buf = nullptr;
             uint16_t len = rtcm.parsers[chan]->get_len(buf);
@@ -1947,6 +1956,46 @@ void AP_GPS::Write_GPS(uint8_t i)
 }
 #endif
 
+#if AP_GPS_PARSE_STATS_ENABLED
+/*
+  account for the CPU time of a driver read() call, logging the
+  totals for the instance once a second
+ */
+void AP_GPS::update_parse_stats(uint8_t instance, uint32_t start_us)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t dt_us = now_us - start_us;
+    auto &ps = parse_stats[instance];
+    ps.calls++;
+    ps.total_us += dt_us;
+    ps.max_us = MAX(ps.max_us, dt_us);
+
+    const uint32_t period_us = now_us - ps.start_us;
+    if (period_us < 1000000U) {
+        return;
+    }
+    if (ps.start_us != 0 && should_log()) {
+// @LoggerMessage: GPSP
+// @Description: GPS driver parsing CPU usage
+// @Field: TimeUS: Time since system startup
+// @Field: I: GPS instance number
+// @Field: Calls: number of driver read calls in the period
+// @Field: CPU: total time spent in driver read calls in the period
+// @Field: Max: longest driver read call in the period
+// @Field: Load: percentage of the period spent in driver read calls
+        AP::logger().Write("GPSP", "TimeUS,I,Calls,CPU,Max,Load", "s#-ss%", "F--FF-", "QBIIIf",
+                           AP_HAL::micros64(),
+                           instance,
+                           ps.calls,
+                           ps.total_us,
+                           ps.max_us,
+                           ps.total_us * 100.0f / period_us);
+    }
+    ps = {};
+    ps.start_us = now_us;
+}
+#endif
+
 bool AP_GPS::is_rtk_base(uint8_t instance) const
 {
     switch (get_type(instance)) {
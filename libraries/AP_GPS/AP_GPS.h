@@ -762,6 +762,17 @@ private:
 
     bool should_log() const;
 
+#if AP_GPS_PARSE_STATS_ENABLED
+    // per instance CPU time spent in driver read() calls
+    struct {
+        uint32_t start_us;
+        uint32_t calls;
+        uint32_t total_us;
+        uint32_t max_us;
+    } parse_stats[GPS_MAX_RECEIVERS];
+    void update_parse_stats(uint8_t instance, uint32_t start_us);
+#endif
+
     bool needs_uart(GPS_Type type) const;
 
 #if GPS_MAX_RECEIVERS > 1
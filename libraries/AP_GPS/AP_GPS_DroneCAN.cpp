@@ -556,8 +556,10 @@ void AP_GPS_DroneCAN::handle_moving_baseline_msg(const ardupilot_gnss_MovingBase
     if (rtcm3_parser == nullptr) {
         return;
     }
-    for (int i=0; i < msg.data.len; i++) {
-        rtcm3_parser->read(msg.data.data[i]);
+    uint32_t i = 0;
+    while (i < msg.data.len) {
+        bool found;
+        i += rtcm3_parser->read(&msg.data.data[i], msg.data.len - i, found);
     }
 }
 
@@ -58,20 +58,40 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
     bool parsed = false;
 
     send_config();
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
+    uint32_t numc = port->available();
+    while (numc > 0) {
+        // parse straight out of the UART buffer where the HAL allows,
+        // otherwise copy a block out
+        uint8_t buf[64];
+        const uint8_t *data;
+        uint32_t n = port->read_span(data);
+        const bool zero_copy = n > 0;
+        if (zero_copy) {
+            n = MIN(n, numc);
+        } else {
+            const ssize_t nread = port->read(buf, MIN(numc, sizeof(buf)));
+            if (nread <= 0) {
+                break;
+            }
+            data = buf;
+            n = nread;
+        }
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data((const uint8_t *)&c, 1);
+        log_data(data, n);
 #endif
-        if (_decode(c)) {
-            parsed = true;
+        for (uint32_t i=0; i<n; i++) {
+            if (_decode(data[i])) {
+                parsed = true;
+            }
+        }
+        if (zero_copy) {
+            port->read_span_advance(n);
         }
+        numc -= n;
     }
     return parsed;
 }
@@ -684,141 +684,229 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
+    const uint32_t numc = MIN(port->available(), 8192U);
+    uint32_t done = 0;
+    bool stop = false;
+    while (done < numc && !stop) {
+        // parse straight out of the UART buffer where the HAL allows
+        const uint8_t *data;
+        uint8_t byte;
+        uint32_t n = port->read_span(data);
+        const bool zero_copy = n > 0;
+        if (!zero_copy) {
+            if (!port->read(byte)) {
+                break;
+            }
+            data = &byte;
+            n = 1;
+        }
+        n = MIN(n, numc - done);
+        const uint32_t used = _parse_span(data, n, parsed, stop);
+        if (zero_copy) {
+            port->read_span_advance(used);
+        }
+        done += used;
+    }
+    return parsed;
+}
 
-        // read the next byte
-        uint8_t data;
-        if (!port->read(data)) {
-            break;
+/*
+  parse a block of received bytes, returning the number consumed.
+  Noise before a preamble and message payloads are handled as blocks,
+  the rest a byte at a time. Returns early after each complete
+  message, as handling it may reconfigure the port, and sets stop when
+  a RTCMv3 packet has been found that needs passing on first
+ */
+uint32_t
+AP_GPS_UBLOX::_parse_span(const uint8_t *data, uint32_t len, bool &parsed, bool &stop)
+{
+    uint32_t i = 0;
+    while (i < len) {
+        // bytes the state machine can take as a block without
+        // completing a message
+        uint32_t run = 1;
+        bool block = false;
+        if (_step == 0 && data[i] != PREAMBLE1) {
+            const uint8_t *p = (const uint8_t *)memchr(&data[i], PREAMBLE1, len - i);
+            run = p != nullptr ? uint32_t(p - &data[i]) : len - i;
+            block = true;
+        } else if (_step == 6) {
+            run = MIN(len - i, uint32_t(_payload_length - _payload_counter));
+            block = true;
         }
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
-#endif
 
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
-            if (rtcm3_parser->read(data)) {
+            bool found;
+            const uint32_t r = rtcm3_parser->read(&data[i], run, found);
+            if (found) {
                 // we've found a RTCMv3 packet. We stop parsing at
                 // this point and reset u-blox parse state. We need to
                 // stop parsing to give the higher level driver a
                 // chance to send the RTCMv3 packet to another (rover)
                 // GPS
+                if (block) {
+                    _parse_block(&data[i], r - 1);
+                }
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+                log_data(&data[i], r);
+#endif
                 _step = 0;
-                break;
+                stop = true;
+                return i + r;
             }
         }
 #endif
 
-	reset:
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
-                break;
-            }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            FALLTHROUGH;
-        case 0:
-            if(PREAMBLE1 == data)
-                _step++;
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+        log_data(&data[i], run);
+#endif
+        if (block) {
+            _parse_block(&data[i], run);
+            i += run;
+            continue;
+        }
+        if (_parse_byte(data[i++], parsed)) {
             break;
+        }
+    }
+    return i;
+}
 
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                       // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
+/*
+  take a block of bytes that can't complete a message: noise while
+  looking for a preamble, or part of a payload
+ */
+void
+AP_GPS_UBLOX::_parse_block(const uint8_t *data, uint32_t len)
+{
+    if (_step != 6 || len == 0) {
+        // noise, nothing to keep
+        return;
+    }
+    memcpy(&_buffer[_payload_counter], data, len);
+    _update_checksum(data, len, _ck_a, _ck_b);
+    _payload_counter += len;
+    if (_payload_counter == _payload_length) {
+        _step++;
+    }
+}
+
+/*
+  process one byte, returning true when a complete message has been
+  handled
+ */
+bool
+AP_GPS_UBLOX::_parse_byte(uint8_t data, bool &parsed)
+{
+	reset:
+    switch(_step) {
+
+    // Message preamble detection
+    //
+    // If we fail to match any of the expected bytes, we reset
+    // the state machine and re-consider the failed byte as
+    // the first byte of the preamble.  This improves our
+    // chances of recovering from a mismatch and makes it less
+    // likely that we will be fooled by the preamble appearing
+    // as data in some other message.
+    //
+    case 1:
+        if (PREAMBLE2 == data) {
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                     // payload length low byte
             break;
-        case 5:
+        }
+        _step = 0;
+        Debug("reset %u", __LINE__);
+        FALLTHROUGH;
+    case 0:
+        if(PREAMBLE1 == data)
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
+        break;
 
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > sizeof(_buffer)) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
-                _step = 0;
+    // Message header processing
+    //
+    // We sniff the class and message ID to decide whether we
+    // are going to gather the message bytes or just discard
+    // them.
+    //
+    // We always collect the length so that we can avoid being
+    // fooled by preamble bytes in messages.
+    //
+    case 2:
+        _step++;
+        _class = data;
+        _ck_b = _ck_a = data;                       // reset the checksum accumulators
+        break;
+    case 3:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _msg_id = data;
+        break;
+    case 4:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _payload_length = data;                     // payload length low byte
+        break;
+    case 5:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+
+        _payload_length += (uint16_t)(data<<8);
+        if (_payload_length > sizeof(_buffer)) {
+            Debug("large payload %u", (unsigned)_payload_length);
+            // assume any payload bigger then what we know about is noise
+            _payload_length = 0;
+            _step = 0;
 				goto reset;
-            }
-            _payload_counter = 0;                       // prepare to receive payload
-            if (_payload_length == 0) {
-                // bypass payload and go straight to checksum
-                _step++;
-            }
-            break;
-
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
+        }
+        _payload_counter = 0;                       // prepare to receive payload
+        if (_payload_length == 0) {
+            // bypass payload and go straight to checksum
+            _step++;
+        }
+        break;
 
-        // Checksum and message processing
-        //
-        case 7:
+    // Receive message data
+    //
+    case 6:
+        _ck_b += (_ck_a += data);                   // checksum byte
+        if (_payload_counter < sizeof(_buffer)) {
+            _buffer[_payload_counter] = data;
+        }
+        if (++_payload_counter == _payload_length)
             _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
+        break;
+
+    // Checksum and message processing
+    //
+    case 7:
+        _step++;
+        if (_ck_a != data) {
+            Debug("bad cka %x should be %x", data, _ck_a);
             _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
+				goto reset;
+        }
+        break;
+    case 8:
+        _step = 0;
+        if (_ck_b != data) {
+            Debug("bad ckb %x should be %x", data, _ck_b);
+            break;                                                  // bad checksum
+        }
 
 #if GPS_MOVING_BASELINE
-            if (rtcm3_parser) {
-                // this is a uBlox packet, discard any partial RTCMv3 state
-                rtcm3_parser->reset();
-            }
+        if (rtcm3_parser) {
+            // this is a uBlox packet, discard any partial RTCMv3 state
+            rtcm3_parser->reset();
+        }
 #endif
-            if (_parse_gps()) {
-                parsed = true;
-            }
-            break;
+        if (_parse_gps()) {
+            parsed = true;
         }
+        return true;
     }
-    return parsed;
+    return false;
 }
 
 // Private Methods /////////////////////////////////////////////////////////////
@@ -1871,13 +1959,22 @@ AP_GPS_UBLOX::set_pps_desired_freq(uint8_t freq)
  *  update checksum for a set of bytes
  */
 void
-AP_GPS_UBLOX::_update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+AP_GPS_UBLOX::_update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
 {
-    while (len--) {
-        ck_a += *data;
-        ck_b += ck_a;
-        data++;
+    /*
+      Fletcher-8 over a block. ck_b gains len copies of the starting
+      ck_a plus each byte weighted by the number of sums it takes part
+      in, so both sums can be formed independently of each other. Only
+      the low byte is kept, so 32 bit wraparound is harmless
+     */
+    uint32_t a = 0;
+    uint32_t b = 0;
+    for (uint16_t i=0; i<len; i++) {
+        a += data[i];
+        b += uint32_t(len - i) * data[i];
     }
+    ck_b += uint8_t(uint32_t(len) * ck_a + b);
+    ck_a += uint8_t(a);
 }
 
 
@@ -802,6 +802,9 @@ private:
 
     // Buffer parse & GPS state update
     bool        _parse_gps();
+    uint32_t    _parse_span(const uint8_t *data, uint32_t len, bool &parsed, bool &stop);
+    void        _parse_block(const uint8_t *data, uint32_t len);
+    bool        _parse_byte(uint8_t data, bool &parsed);
 
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix { AP_GPS::NO_FIX };
@@ -826,7 +829,7 @@ private:
     bool        _configure_valget(ConfigKey key);
     void        _configure_rate(void);
     void        _configure_sbas(bool enable);
-    void        _update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
+    void        _update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
     bool        _send_message(uint8_t msg_class, uint8_t msg_id, const void *msg, uint16_t size);
     void	send_next_rate_update(void);
     bool        _request_message_rate(uint8_t msg_class, uint8_t msg_id);
@@ -2,6 +2,7 @@
 
 #include <AP_HAL/AP_HAL_Boards.h>
 #include <GCS_MAVLink/GCS_config.h>
+#include <AP_Logger/AP_Logger_config.h>
 
 #ifndef AP_GPS_ENABLED
 #define AP_GPS_ENABLED 1
@@ -121,3 +122,7 @@
 #ifndef AP_GPS_GPS2_RTK_SENDING_ENABLED
 #define AP_GPS_GPS2_RTK_SENDING_ENABLED HAL_GCS_ENABLED && AP_GPS_ENABLED && GPS_MAX_RECEIVERS > 1 && (AP_GPS_SBF_ENABLED || AP_GPS_ERB_ENABLED)
 #endif
+
+#ifndef AP_GPS_PARSE_STATS_ENABLED
+#define AP_GPS_PARSE_STATS_ENABLED AP_GPS_ENABLED && HAL_LOGGING_ENABLED
+#endif
@@ -135,6 +135,47 @@ bool RTCM3_Parser::read(uint8_t byte)
     return false;
 }
 
+/*
+  read in a block of bytes. Gives the same result as calling read()
+  on each byte, but skips noise before a preamble and copies packet
+  bodies as blocks
+ */
+uint32_t RTCM3_Parser::read(const uint8_t *bytes, uint32_t len, bool &found)
+{
+    found = false;
+    uint32_t i = 0;
+    while (i < len) {
+        clear_packet();
+        if (pkt_bytes > 0 && pkt[0] != RTCMv3_PREAMBLE) {
+            resync();
+        }
+
+        if (pkt_bytes == 0) {
+            // discard up to the next preamble
+            const uint8_t *p = (const uint8_t *)memchr(&bytes[i], RTCMv3_PREAMBLE, len - i);
+            if (p == nullptr) {
+                return len;
+            }
+            i = p - bytes;
+        } else if (pkt_len != 0 && pkt_bytes < pkt_len + 6) {
+            // body and parity, up to the byte that completes the packet
+            const uint32_t n = MIN(MIN(len - i, uint32_t(pkt_len + 6 - pkt_bytes)),
+                                   uint32_t(sizeof(pkt) - pkt_bytes));
+            if (n > 1) {
+                memcpy(&pkt[pkt_bytes], &bytes[i], n - 1);
+                pkt_bytes += n - 1;
+                i += n - 1;
+            }
+        }
+
+        if (read(bytes[i++])) {
+            found = true;
+            break;
+        }
+    }
+    return i;
+}
+
 #ifdef RTCM_MAIN_TEST
 /*
   parsing test, taking a raw file captured from UART to u-blox F9
@@ -28,6 +28,10 @@ public:
     // process one byte, return true if packet found
     bool read(uint8_t b);
 
+    // process a block of bytes, stopping after a packet is found.
+    // Returns the number of bytes consumed
+    uint32_t read(const uint8_t *bytes, uint32_t len, bool &found);
+
     // reset internal state
     void reset(void);
 
@@ -0,0 +1,95 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/RTCM3_Parser.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  append a RTCMv3 frame with the given message ID and body length
+ */
+static uint32_t add_frame(uint8_t *buf, uint16_t id, uint16_t body_len, uint8_t seed)
+{
+    buf[0] = 0xD3;
+    buf[1] = body_len >> 8;
+    buf[2] = body_len & 0xFF;
+    for (uint16_t i=0; i<body_len; i++) {
+        buf[3+i] = seed + i*7;
+    }
+    buf[3] = id >> 4;
+    buf[4] = (id & 0xF) << 4;
+    const uint32_t crc = crc_crc24(buf, body_len+3);
+    buf[body_len+3] = crc >> 16;
+    buf[body_len+4] = crc >> 8;
+    buf[body_len+5] = crc;
+    return body_len + 6;
+}
+
+/*
+  a stream of frames of different sizes, separated by noise that
+  includes stray preambles and a corrupted frame
+ */
+static uint32_t make_stream(uint8_t *buf)
+{
+    uint32_t len = 0;
+    const uint8_t noise[] { 0x00, 0xD3, 0x12, 0xB5, 0x62, 0xD3, 0x00, 0x00, 0x55 };
+    for (uint8_t i=0; i<20; i++) {
+        memcpy(&buf[len], noise, 1 + i % sizeof(noise));
+        len += 1 + i % sizeof(noise);
+        const uint32_t flen = add_frame(&buf[len], 1005 + i, 19 + i * 23, i);
+        if (i == 7) {
+            // corrupt the body
+            buf[len + 10] ^= 0x5A;
+        }
+        len += flen;
+    }
+    return len;
+}
+
+TEST(RTCM3_Parser, BlockMatchesBytewise)
+{
+    static uint8_t stream[20000];
+    const uint32_t len = make_stream(stream);
+
+    // the packets found a byte at a time
+    RTCM3_Parser bytewise {};
+    uint16_t ids[20];
+    uint16_t lens[20];
+    uint8_t count = 0;
+    for (uint32_t i=0; i<len; i++) {
+        if (bytewise.read(stream[i])) {
+            const uint8_t *bytes;
+            ASSERT_LT(count, ARRAY_SIZE(ids));
+            lens[count] = bytewise.get_len(bytes);
+            ids[count] = bytewise.get_id();
+            count++;
+        }
+    }
+    // noise can hide a frame from the parser, but most get through
+    EXPECT_GT(count, 15);
+
+    // the same packets in blocks of a range of sizes
+    for (uint32_t block = 1; block < 700; block += 37) {
+        RTCM3_Parser parser {};
+        uint8_t found_count = 0;
+        uint32_t ofs = 0;
+        while (ofs < len) {
+            bool found;
+            const uint32_t n = MIN(block, len - ofs);
+            const uint32_t used = parser.read(&stream[ofs], n, found);
+            ASSERT_GT(used, 0U);
+            ASSERT_LE(used, n);
+            ofs += used;
+            if (found) {
+                const uint8_t *bytes;
+                ASSERT_LT(found_count, count);
+                EXPECT_EQ(parser.get_len(bytes), lens[found_count]);
+                EXPECT_EQ(parser.get_id(), ids[found_count]);
+                found_count++;
+            }
+        }
+        EXPECT_EQ(found_count, count);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -22,6 +22,8 @@
 #include "Device.h"
 #include "utility/OwnPtr.h"
 
+class ExpandingString;
+
 namespace AP_HAL {
 
 class SPIDevice : public Device {
@@ -58,6 +60,33 @@ public:
      *  when initialising microSD interfaces over SPI
     */
     virtual bool clock_pulse(uint32_t len) { return false; }
+
+    /*
+     * One transaction of a batch: @send_len bytes are sent and then
+     * @recv_len bytes are received, as for #transfer()
+     */
+    struct Transfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+    };
+
+    /*
+     * Perform @count independent transactions, each framed by its own
+     * chip select. Backends that can queue several transactions into
+     * one bus operation override this; the default issues them one
+     * at a time and stops at the first failure
+     */
+    virtual bool transfer_batch(const Transfer *transfers, uint8_t count) {
+        for (uint8_t i = 0; i < count; i++) {
+            const Transfer &t = transfers[i];
+            if (!transfer(t.send, t.send_len, t.recv, t.recv_len)) {
+                return false;
+            }
+        }
+        return count > 0;
+    }
     
     /* See Device::get_semaphore() */
     virtual Semaphore *get_semaphore() override = 0;
@@ -88,6 +117,9 @@ public:
     virtual const char *get_device_name(uint8_t idx) { return nullptr; }
 
     virtual void set_register_rw_callback(const char* name, AP_HAL::Device::RegisterRWCb cb) {}
+
+    // fetch per-bus transfer statistics, available via @SYS/spi.txt
+    virtual void bus_info(ExpandingString &str) {}
 };
 
 }
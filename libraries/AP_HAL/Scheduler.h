@@ -126,6 +126,14 @@ public:
         return false;
     }
 
+    /*
+      restrict the threads of a priority class to a set of CPUs, bit N
+      of cpu_mask being CPU N. A mask of 0 removes the restriction
+     */
+    virtual bool set_thread_affinity(priority_base base, uint32_t cpu_mask) {
+        return false;
+    }
+
 private:
 
     AP_HAL::Proc _delay_cb;
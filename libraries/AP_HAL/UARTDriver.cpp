@@ -75,6 +75,37 @@ ssize_t AP_HAL::UARTDriver::read_locked(uint8_t *buf, size_t count, uint32_t key
     return ret;
 }
 
+/*
+  return a contiguous block of received bytes without copying them
+*/
+uint32_t AP_HAL::UARTDriver::read_span(const uint8_t *&data)
+{
+    if (lock_read_key != 0) {
+        return 0;
+    }
+    return _read_span(data);
+}
+
+/*
+  consume n bytes of the last block returned by read_span()
+*/
+void AP_HAL::UARTDriver::read_span_advance(uint32_t n)
+{
+    if (n == 0) {
+        return;
+    }
+#if AP_UART_MONITOR_ENABLED
+    auto monitor = _monitor_read_buffer;
+    if (monitor != nullptr) {
+        const uint8_t *data;
+        if (_read_span(data) >= n) {
+            monitor->write(data, n);
+        }
+    }
+#endif
+    _read_span_advance(n);
+}
+
 uint32_t AP_HAL::UARTDriver::available_locked(uint32_t key)
 {
     if (lock_read_key != 0 && lock_read_key != key) {
@@ -55,6 +55,18 @@ public:
     int16_t read(void) override;
     bool read(uint8_t &b) override WARN_IF_UNUSED;
     ssize_t read(uint8_t *buffer, uint16_t count) override;
+
+    /*
+      zero copy block read. Points data at the longest contiguous run
+      of bytes at the front of the receive buffer and returns its
+      length, or 0 if nothing is waiting, the port is locked or the
+      backend can't expose its buffer (fall back to read() then). The
+      bytes stay in the buffer until read_span_advance() consumes
+      them, so the span is valid until then. Like read(), only one
+      thread may use this on a port
+     */
+    uint32_t read_span(const uint8_t *&data) WARN_IF_UNUSED;
+    void read_span_advance(uint32_t n);
     
     void end();
     void flush();
@@ -242,6 +254,14 @@ protected:
      */
     virtual ssize_t _read(uint8_t *buffer, uint16_t count)  WARN_IF_UNUSED = 0;
 
+    /*
+      backend zero copy read methods, for backends with a ring buffer
+      they can expose. _read_span_advance() is only called with a
+      count no larger than the last span returned
+     */
+    virtual uint32_t _read_span(const uint8_t *&data) { return 0; }
+    virtual void _read_span_advance(uint32_t n) {}
+
     /*
       end control of the port, freeing buffers
      */
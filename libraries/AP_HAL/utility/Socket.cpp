@@ -55,6 +55,8 @@
 #define MSG_NOSIGNAL 0
 #endif
 
+extern const AP_HAL::HAL& hal;
+
 /*
   constructor
  */
@@ -195,6 +197,25 @@ fail_multi:
   connect the socket with a timeout
  */
 bool SOCKET_CLASS_NAME::connect_timeout(const char *address, uint16_t port, uint32_t timeout_ms)
+{
+    if (!connect_start(address, port)) {
+        return false;
+    }
+    if (connected) {
+        // instant connect
+        return true;
+    }
+    bool pollret = pollout(timeout_ms);
+    if (!pollret) {
+        return false;
+    }
+    return connect_check();
+}
+
+/*
+  start a non-blocking connect
+ */
+bool SOCKET_CLASS_NAME::connect_start(const char *address, uint16_t port)
 {
     if (fd == -1) {
         return false;
@@ -207,13 +228,18 @@ bool SOCKET_CLASS_NAME::connect_timeout(const char *address, uint16_t port, uint
     int ret = CALL_PREFIX(connect)(fd, (struct sockaddr *)&sockaddr, sizeof(sockaddr));
     if (ret == 0) {
         // instant connect?
+        connected = true;
         return true;
     }
-    if (errno != EINPROGRESS) {
-        return false;
-    }
-    bool pollret = pollout(timeout_ms);
-    if (!pollret) {
+    return errno == EINPROGRESS;
+}
+
+/*
+  check the result of a non-blocking connect
+ */
+bool SOCKET_CLASS_NAME::connect_check(void)
+{
+    if (fd == -1) {
         return false;
     }
     int sock_error = 0;
@@ -343,7 +369,9 @@ ssize_t SOCKET_CLASS_NAME::sendto(const void *buf, size_t size, const char *addr
  */
 ssize_t SOCKET_CLASS_NAME::recv(void *buf, size_t size, uint32_t timeout_ms)
 {
-    if (!pollin(timeout_ms)) {
+    // with no timeout the MSG_DONTWAIT recvfrom() below is enough,
+    // saving a select() call per read
+    if (timeout_ms > 0 && !pollin(timeout_ms)) {
         errno = EWOULDBLOCK;
         return -1;
     }
@@ -482,6 +510,68 @@ bool SOCKET_CLASS_NAME::pollout(uint32_t timeout_ms)
     return true;
 }
 
+/*
+  wait for any of a set of sockets to be ready. This lets one thread
+  serve many sockets without polling each of them in turn
+ */
+int SOCKET_CLASS_NAME::poll(PollEntry *entries, uint8_t count, uint32_t timeout_us)
+{
+    fd_set rfds, wfds;
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+    int maxfd = -1;
+    for (uint8_t i=0; i<count; i++) {
+        auto &e = entries[i];
+        e.readable = false;
+        e.writable = false;
+        if (e.sock == nullptr) {
+            continue;
+        }
+        const int fin = e.sock->get_read_fd();
+        if (e.want_read && fin != -1) {
+            FD_SET(fin, &rfds);
+            if (fin > maxfd) {
+                maxfd = fin;
+            }
+        }
+        if (e.want_write && e.sock->fd != -1) {
+            FD_SET(e.sock->fd, &wfds);
+            if (e.sock->fd > maxfd) {
+                maxfd = e.sock->fd;
+            }
+        }
+    }
+
+    struct timeval tv;
+    tv.tv_sec = timeout_us / 1000000UL;
+    tv.tv_usec = timeout_us % 1000000UL;
+
+    if (maxfd == -1) {
+        // nothing to wait on, just sleep
+        hal.scheduler->delay_microseconds(timeout_us);
+        return 0;
+    }
+
+    const int ret = CALL_PREFIX(select)(maxfd+1, &rfds, &wfds, nullptr, &tv);
+    if (ret <= 0) {
+        return ret;
+    }
+    int ready = 0;
+    for (uint8_t i=0; i<count; i++) {
+        auto &e = entries[i];
+        if (e.sock == nullptr) {
+            continue;
+        }
+        const int fin = e.sock->get_read_fd();
+        e.readable = e.want_read && fin != -1 && FD_ISSET(fin, &rfds);
+        e.writable = e.want_write && e.sock->fd != -1 && FD_ISSET(e.sock->fd, &wfds);
+        if (e.readable || e.writable) {
+            ready++;
+        }
+    }
+    return ready;
+}
+
 /* 
    start listening for new tcp connections
  */
@@ -35,6 +35,13 @@ public:
 
     bool connect(const char *address, uint16_t port);
     bool connect_timeout(const char *address, uint16_t port, uint32_t timeout_ms);
+
+    // start a non-blocking connect, returns false on immediate failure
+    bool connect_start(const char *address, uint16_t port);
+
+    // check if a connect_start() has completed, call once the socket
+    // is writable. Returns true if connected
+    bool connect_check(void);
     bool bind(const char *address, uint16_t port);
     bool reuseaddress() const;
     bool set_blocking(bool blocking) const;
@@ -61,6 +68,22 @@ public:
     // return true if there is room for output data
     bool pollout(uint32_t timeout_ms);
 
+    // readiness of one socket for poll()
+    struct PollEntry {
+        SOCKET_CLASS_NAME *sock;
+        bool want_read;
+        bool want_write;
+        bool readable;
+        bool writable;
+    };
+
+    /*
+      wait up to timeout_us for any of a set of sockets to be readable
+      or writable, as requested by each entry. Entries with a null sock
+      are skipped. Returns the number of sockets ready, or -1 on error
+     */
+    static int poll(PollEntry *entries, uint8_t count, uint32_t timeout_us);
+
     // start listening for new tcp connections
     bool listen(uint16_t backlog) const;
 
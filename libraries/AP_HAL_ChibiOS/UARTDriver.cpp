@@ -772,6 +772,27 @@ ssize_t UARTDriver::_read(uint8_t *buffer, uint16_t count)
     return ret;
 }
 
+uint32_t UARTDriver::_read_span(const uint8_t *&data)
+{
+    if (_uart_owner_thd != chThdGetSelfX() || !_rx_initialised) {
+        return 0;
+    }
+    uint32_t n = 0;
+    data = _readbuf.readptr(n);
+    return data != nullptr ? n : 0;
+}
+
+void UARTDriver::_read_span_advance(uint32_t n)
+{
+    if (_uart_owner_thd != chThdGetSelfX() || !_rx_initialised) {
+        return;
+    }
+    _readbuf.advance(n);
+    if (!_rts_is_active) {
+        update_rts_line();
+    }
+}
+
 /* write a block of bytes to the port */
 size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
 {
@@ -280,6 +280,8 @@ protected:
     void _flush() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override;
+    uint32_t _read_span(const uint8_t *&data) override;
+    void _read_span_advance(uint32_t n) override;
     uint32_t _available() override;
     bool _discard_input() override;
 
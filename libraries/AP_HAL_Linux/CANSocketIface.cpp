@@ -38,6 +38,8 @@
 #include <net/if.h>
 #include <linux/can/raw.h>
 #include <cstring>
+#include <algorithm>
+#include <time.h>
 #include "Scheduler.h"
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Common/ExpandingString.h>
@@ -167,7 +169,15 @@ int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline
     tx_item.index = _tx_frame_counter;
     tx_item.deadline = tx_deadline;
     WITH_SEMAPHORE(sem);
-    _tx_queue.emplace(tx_item);
+    if (!_txPush(tx_item)) {
+        // make room by pushing queued frames out to the socket
+        _pollRead();
+        _pollWrite();
+        if (!_txPush(tx_item)) {
+            stats.tx_overflow++;
+            return 0;
+        }
+    }
     _tx_frame_counter++;
     stats.tx_requests++;
     _pollRead();     // Read poll is necessary because it can release the pending TX flag
@@ -179,35 +189,62 @@ int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_u
                           CANIface::CanIOFlags& out_flags)
 {
     WITH_SEMAPHORE(sem);
-    if (_rx_queue.empty()) {
+    if (_rx_queue.is_empty()) {
         _pollRead();            // This allows to use the socket not calling poll() explicitly.
-        if (_rx_queue.empty()) {
+        if (_rx_queue.is_empty()) {
             return 0;
         }
     }
     {
-        const CanRxItem& rx = _rx_queue.front();
+        const CanRxItem& rx = *_rx_queue[0];
         out_frame        = rx.frame;
         out_timestamp_us = rx.timestamp_us;
         out_flags        = rx.flags;
     }
-    (void)_rx_queue.pop();
+    IGNORE_RETURN(_rx_queue.pop());
     if (sem_handle != nullptr) {
         sem_handle->signal();
     }
     return AP_HAL::CANIface::receive(out_frame, out_timestamp_us, out_flags);
 }
 
+/*
+  the TX queue is a binary heap in a fixed array, so queueing a frame
+  never allocates. std::push_heap/pop_heap keep the highest priority
+  frame (by CanTxItem::operator<) at the front
+ */
+bool CANIface::_txPush(const CanTxItem& item)
+{
+    if (_tx_queue_len >= ARRAY_SIZE(_tx_queue)) {
+        return false;
+    }
+    _tx_queue[_tx_queue_len++] = item;
+    std::push_heap(&_tx_queue[0], &_tx_queue[_tx_queue_len]);
+    return true;
+}
+
+void CANIface::_txPop(CanTxItem& item)
+{
+    std::pop_heap(&_tx_queue[0], &_tx_queue[_tx_queue_len]);
+    item = _tx_queue[--_tx_queue_len];
+}
+
 bool CANIface::_hasReadyTx()
 {
     WITH_SEMAPHORE(sem);
-    return !_tx_queue.empty() && (_frames_in_socket_tx_queue < _max_frames_in_socket_tx_queue);
+    return _tx_queue_len > 0 && (_frames_in_socket_tx_queue < _max_frames_in_socket_tx_queue);
 }
 
 bool CANIface::_hasReadyRx()
 {
     WITH_SEMAPHORE(sem);
-    return !_rx_queue.empty();
+    return !_rx_queue.is_empty();
+}
+
+bool CANIface::_hasTxSpace()
+{
+    WITH_SEMAPHORE(sem);
+    return _tx_queue_len < ARRAY_SIZE(_tx_queue);
 }
 
 void CANIface::_poll(bool read, bool write)
@@ -266,6 +303,10 @@ uint32_t CANIface::getErrorCount() const
     return ec;
 }
 
+/*
+  move as many frames as the socket TX limit allows from the queue to
+  the socket, in priority order, with one sendmmsg() per batch
+ */
 void CANIface::_pollWrite()
 {
     while (_hasReadyTx()) {
@@ -273,57 +314,67 @@ void CANIface::_pollWrite()
         if (!_hasReadyTx()) {
             break;
         }
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
-                _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
-                }
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_overflow++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_rejected++;
+        const uint64_t curr_time = AP_HAL::micros64();
+        unsigned n = 0;
+        while (_tx_queue_len > 0 &&
+               n < CAN_IO_BATCH_SIZE &&
+               _frames_in_socket_tx_queue + n < _max_frames_in_socket_tx_queue) {
+            CanTxItem &tx = _tx_batch.items[n];
+            _txPop(tx);
+            if (tx.deadline < curr_time) {
+                // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
+                stats.tx_timedout++;
+                continue;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+            _tx_batch.frames[n] = makeSocketCanFrame(tx.frame);
+            n++;
+        }
+        if (n == 0) {
+            break;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        const int res = _write(_tx_batch.frames, n);
+        unsigned sent = 0;
+        if (res > 0) {                        // Transmitted successfully
+            sent = res;
+            stats.tx_success += sent;
+            stats.last_transmit_us = curr_time;
+        } else if (res < 0) {                 // Transmission error, drop the first frame
+            stats.tx_rejected++;
+            sent = 1;
+        } else {                              // Not transmitted, nor is it an error
+            stats.tx_overflow++;
+        }
+        for (unsigned i = 0; i < sent && res > 0; i++) {
+            _incrementNumFramesInSocketTxQueue();
+            if (_tx_batch.items[i].loopback) {
+                _addPendingLoopback(_tx_batch.items[i].frame);
+            }
+        }
+        // frames the socket did not take stay enqueued for the next
+        // retry, keeping their original order
+        for (unsigned i = sent; i < n; i++) {
+            IGNORE_RETURN(_txPush(_tx_batch.items[i]));
+        }
+        if (res == 0 || sent < n) {
+            break;
+        }
     }
 }
 
 bool CANIface::_pollRead()
 {
+    bool received = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
         iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
-            bool accept = true;
-            if (loopback) {           // We receive loopback for all CAN frames
-                _confirmSentFrame();
-                rx.flags |= Loopback;
-                accept = _wasInPendingLoopbackSet(rx.frame);
-                stats.tx_confirmed++;
-            }
-            if (accept) {
-                WITH_SEMAPHORE(sem);
-                _rx_queue.push(rx);
-                stats.rx_received++;
-                return true;
+        const int res = _read();
+        if (res > 0) {
+            received = true;
+            if (res < CAN_IO_BATCH_SIZE) {
+                // socket drained
+                break;
             }
         } else if (res == 0) {
             break;
@@ -332,71 +383,122 @@ bool CANIface::_pollRead()
             break;
         }
     }
-    return false;
+    return received;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+int CANIface::_write(const can_frame* frames, unsigned count)
 {
     if (_fd < 0) {
         return -1;
     }
     errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
+    for (unsigned i = 0; i < count; i++) {
+        _tx_batch.iov[i].iov_base = const_cast<can_frame*>(&frames[i]);
+        _tx_batch.iov[i].iov_len = sizeof(can_frame);
+        _tx_batch.msgs[i] = mmsghdr();
+        _tx_batch.msgs[i].msg_hdr.msg_iov = &_tx_batch.iov[i];
+        _tx_batch.msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    const int res = sendmmsg(_fd, _tx_batch.msgs, count, MSG_DONTWAIT);
     if (res <= 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
+        return res < 0 ? res : -1;
     }
-    if (res != sizeof(sockcan_frame)) {
-        return -1;
+    stats.num_tx_batches++;
+    for (int i = 0; i < res; i++) {
+        if (_tx_batch.msgs[i].msg_len != sizeof(can_frame)) {
+            // the frames before this one did go out
+            return i > 0 ? i : -1;
+        }
     }
-    return 1;
+    return res;
 }
 
-
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+/*
+  read a batch of frames straight into the RX queue. Frames are
+  timestamped with the time the kernel received them, converted from
+  the realtime clock to our monotonic clock
+ */
+int CANIface::_read()
 {
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
-    union {
-        uint8_t data[CMSG_SPACE(sizeof(::timeval))];
-        struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
-
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
+    WITH_SEMAPHORE(sem);
+    const unsigned count = std::min(unsigned(CAN_IO_BATCH_SIZE), unsigned(_rx_queue.space()));
+    if (count == 0) {
+        // keep the frames in the socket buffer until there is room
+        return 0;
+    }
+    for (unsigned i = 0; i < count; i++) {
+        _rx_batch.iov[i].iov_base = &_rx_batch.frames[i];
+        _rx_batch.iov[i].iov_len = sizeof(can_frame);
+        _rx_batch.msgs[i] = mmsghdr();
+        _rx_batch.msgs[i].msg_hdr.msg_iov = &_rx_batch.iov[i];
+        _rx_batch.msgs[i].msg_hdr.msg_iovlen = 1;
+        _rx_batch.msgs[i].msg_hdr.msg_control = _rx_batch.control[i];
+        _rx_batch.msgs[i].msg_hdr.msg_controllen = sizeof(_rx_batch.control[i]);
+    }
+
+    const int res = recvmmsg(_fd, _rx_batch.msgs, count, MSG_DONTWAIT, nullptr);
     if (res <= 0) {
         return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
-    /*
-     * Flags
-     */
-    loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
+    stats.num_rx_batches++;
 
-    if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
-    }
+    const uint64_t now_us = AP_HAL::micros64();
+    struct timespec ts_now;
+    clock_gettime(CLOCK_REALTIME, &ts_now);
+    const uint64_t realtime_now_us = ts_now.tv_sec * 1000000ULL + ts_now.tv_nsec / 1000U;
 
-    frame = makeUavcanFrame(sockcan_frame);
-    /*
-     * Timestamp
-     */
-    timestamp_us = AP_HAL::micros64();
-    return 1;
+    for (int i = 0; i < res; i++) {
+        const msghdr &msg = _rx_batch.msgs[i].msg_hdr;
+        const can_frame &sockcan_frame = _rx_batch.frames[i];
+        /*
+         * Flags
+         */
+        const bool loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
+
+        if (!loopback && !_checkHWFilters(sockcan_frame)) {
+            continue;
+        }
+
+        CanRxItem rx;
+        rx.frame = makeUavcanFrame(sockcan_frame);
+        /*
+         * Timestamp
+         */
+        rx.timestamp_us = now_us;
+        for (const cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), const_cast<cmsghdr*>(cmsg))) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMP) {
+                ::timeval tv;
+                memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+                const uint64_t rx_realtime_us = tv.tv_sec * 1000000ULL + tv.tv_usec;
+                const uint64_t age_us = realtime_now_us - rx_realtime_us;
+                // ignore timestamps from clock steps
+                if (rx_realtime_us <= realtime_now_us && age_us < now_us && age_us < 1000000U) {
+                    rx.timestamp_us = now_us - age_us;
+                }
+            }
+        }
+
+        if (loopback) {           // We receive loopback for all CAN frames
+            _confirmSentFrame();
+            rx.flags |= Loopback;
+            stats.tx_confirmed++;
+            if (!_wasInPendingLoopbackSet(rx.frame)) {
+                continue;
+            }
+        }
+        if (add_to_rx_queue(rx)) {
+            stats.rx_received++;
+        }
+    }
+    return res;
 }
 
 // Might block forever, only to be used for testing
@@ -406,15 +508,14 @@ void CANIface::flush_tx()
     do {
         _updateDownStatusFromPollResult(_pollfd);
         _poll(true, true);
-    } while(!_tx_queue.empty() && !_down);
+    } while(_tx_queue_len > 0 && !_down);
 }
 
 void CANIface::clear_rx()
 {
     WITH_SEMAPHORE(sem);
     // Clean Rx Queue
-    std::queue<CanRxItem> empty;
-    std::swap( _rx_queue, empty );
+    _rx_queue.clear();
 }
 
 void CANIface::_incrementNumFramesInSocketTxQueue()
@@ -429,11 +530,20 @@ void CANIface::_confirmSentFrame()
     }
 }
 
+void CANIface::_addPendingLoopback(const AP_HAL::CANFrame& frame)
+{
+    if (_num_pending_loopback < ARRAY_SIZE(_pending_loopback_ids)) {
+        _pending_loopback_ids[_num_pending_loopback++] = frame.id;
+    }
+}
+
 bool CANIface::_wasInPendingLoopbackSet(const AP_HAL::CANFrame& frame)
 {
-    if (_pending_loopback_ids.count(frame.id) > 0) {
-        _pending_loopback_ids.erase(frame.id);
-        return true;
+    for (uint8_t i = 0; i < _num_pending_loopback; i++) {
+        if (_pending_loopback_ids[i] == frame.id) {
+            _pending_loopback_ids[i] = _pending_loopback_ids[--_num_pending_loopback];
+            return true;
+        }
     }
     return false;
 }
@@ -494,7 +604,7 @@ bool CANIface::select(bool &read_select, bool &write_select,
                         const AP_HAL::CANFrame* const pending_tx, uint64_t blocking_deadline)
 {
     // Detecting whether we need to block at all
-    bool need_block = !write_select;    // Write queue is infinite
+    bool need_block = !(write_select && _hasTxSpace());
 
     if (read_select && _hasReadyRx()) {
         need_block = false;
@@ -520,7 +630,7 @@ bool CANIface::select(bool &read_select, bool &write_select,
 
     // Writing the output masks
     if (!_down) {
-        write_select = true;     // Always ready to write if not down
+        write_select = _hasTxSpace();     // Ready to write if not down and the queue has room
     } else {
         write_select = false;
     }
@@ -556,7 +666,10 @@ void CANIface::get_stats(ExpandingString &str)
                "num_tx_poll_req:  %u\n"
                "num_poll_waits:   %u\n"
                "num_poll_tx_events: %u\n"
-               "num_poll_rx_events: %u\n",
+               "num_poll_rx_events: %u\n"
+               "num_tx_batches: %u\n"
+               "num_rx_batches: %u\n"
+               "rx_overflow:    %u\n",
                stats.tx_requests,
                stats.tx_rejected,
                stats.tx_overflow,
@@ -570,7 +683,10 @@ void CANIface::get_stats(ExpandingString &str)
                stats.num_tx_poll_req,
                stats.num_poll_waits,
                stats.num_poll_tx_events,
-               stats.num_poll_rx_events);
+               stats.num_poll_rx_events,
+               stats.num_tx_batches,
+               stats.num_rx_batches,
+               stats.rx_overflow);
 }
 
 #endif
@@ -31,15 +31,16 @@
 #if HAL_NUM_CAN_IFACES
 
 #include <AP_HAL/CANIface.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 #include <linux/can.h>
 
 #include <string>
-#include <queue>
 #include <memory>
 #include <map>
-#include <unordered_set>
+#include <vector>
 #include <poll.h>
+#include <sys/socket.h>
 
 namespace Linux {
 
@@ -54,12 +55,28 @@ enum class SocketCanError
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
 
+#ifndef HAL_LINUX_CAN_TX_QUEUE_SIZE
+#define HAL_LINUX_CAN_TX_QUEUE_SIZE 128
+#endif
+#ifndef HAL_LINUX_CAN_RX_QUEUE_SIZE
+#define HAL_LINUX_CAN_RX_QUEUE_SIZE 128
+#endif
+// frames moved per sendmmsg()/recvmmsg() call
+#define CAN_IO_BATCH_SIZE 16
+// frames written to the socket but not yet seen on loopback. Keeping
+// this small stops the kernel queue from undoing our priority order
+#ifndef HAL_LINUX_CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE
+#define HAL_LINUX_CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE 8
+#endif
+
 class CANIface: public AP_HAL::CANIface {
 public:
     CANIface(int index)
       : _self_index(index)
-      , _max_frames_in_socket_tx_queue(2)
+      , _max_frames_in_socket_tx_queue(HAL_LINUX_CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE)
       , _frames_in_socket_tx_queue(0)
+      , _tx_queue_len(0)
+      , _num_pending_loopback(0)
     { }
 
     ~CANIface() { }
@@ -120,22 +137,34 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    // write up to count frames with one syscall, returns the number
+    // written, 0 if the socket is full or negative on error
+    int _write(const can_frame* frames, unsigned count);
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    // read up to CAN_IO_BATCH_SIZE frames with one syscall, returns
+    // the number read, 0 if nothing is available or negative on error
+    int _read();
 
     void _incrementNumFramesInSocketTxQueue();
 
     void _confirmSentFrame();
 
+    void _addPendingLoopback(const AP_HAL::CANFrame& frame);
+
     bool _wasInPendingLoopbackSet(const AP_HAL::CANFrame& frame);
 
+    // fixed capacity priority queue of frames waiting to be sent
+    bool _txPush(const CanTxItem& item);
+    void _txPop(CanTxItem& item);
+
     bool _checkHWFilters(const can_frame& frame) const;
 
     bool _hasReadyTx();
 
     bool _hasReadyRx();
 
+    bool _hasTxSpace();
+
     void _poll(bool read, bool write);
 
     int _openSocket(const std::string& iface_name);
@@ -158,9 +187,32 @@ private:
 
     pollfd _pollfd;
     std::map<SocketCanError, uint64_t> _errors;
-    std::priority_queue<CanTxItem> _tx_queue;
-    std::queue<CanRxItem> _rx_queue;
-    std::unordered_multiset<uint32_t> _pending_loopback_ids;
+
+    // binary heap ordered by CanTxItem::operator<
+    CanTxItem _tx_queue[HAL_LINUX_CAN_TX_QUEUE_SIZE];
+    uint16_t _tx_queue_len;
+    ObjectArray<CanRxItem> _rx_queue{HAL_LINUX_CAN_RX_QUEUE_SIZE};
+
+    // IDs of frames sent with the Loopback flag, at most one per frame
+    // in the socket TX queue
+    uint32_t _pending_loopback_ids[HAL_LINUX_CAN_MAX_FRAMES_IN_SOCKET_TX_QUEUE];
+    uint8_t _num_pending_loopback;
+
+    // buffers for batched socket I/O, kept here so the flight path
+    // does not touch the stack or heap for them
+    struct {
+        can_frame frames[CAN_IO_BATCH_SIZE];
+        iovec iov[CAN_IO_BATCH_SIZE];
+        mmsghdr msgs[CAN_IO_BATCH_SIZE];
+        alignas(cmsghdr) uint8_t control[CAN_IO_BATCH_SIZE][CMSG_SPACE(sizeof(::timeval))];
+    } _rx_batch;
+    struct {
+        can_frame frames[CAN_IO_BATCH_SIZE];
+        CanTxItem items[CAN_IO_BATCH_SIZE];
+        iovec iov[CAN_IO_BATCH_SIZE];
+        mmsghdr msgs[CAN_IO_BATCH_SIZE];
+    } _tx_batch;
+
     std::vector<can_filter> _hw_filters_container;
 
     struct bus_stats : public AP_HAL::CANIface::bus_stats_t {
@@ -171,11 +223,16 @@ private:
         uint32_t num_poll_waits;
         uint32_t num_poll_tx_events;
         uint32_t num_poll_rx_events;
+        uint32_t num_tx_batches;
+        uint32_t num_rx_batches;
     } stats;
 
 protected:
     bool add_to_rx_queue(const CanRxItem &rx_item) override {
-        _rx_queue.push(rx_item);
+        if (!_rx_queue.push(rx_item)) {
+            stats.rx_overflow++;
+            return false;
+        }
         return true;
     }
 
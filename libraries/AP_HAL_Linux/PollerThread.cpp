@@ -21,6 +21,7 @@
 #include <sys/epoll.h>
 #include <sys/timerfd.h>
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
 namespace Linux {
@@ -37,6 +38,12 @@ void TimerPollable::on_can_read()
         return;
     }
 
+    // timerfd counts expiries, more than one means we missed periods
+    const uint32_t missed = nevents > 1 ? nevents - 1 : 0;
+    const uint64_t expiry_usec = _next_usec + uint64_t(missed) * _period_usec;
+    const uint64_t wake_usec = AP_HAL::micros64();
+    _next_usec = expiry_usec + _period_usec;
+
     if (_wrapper) {
         _wrapper->start_cb();
     }
@@ -46,6 +53,11 @@ void TimerPollable::on_can_read()
     if (_wrapper) {
         _wrapper->end_cb();
     }
+
+    if (_thread) {
+        _thread->note_wakeup(wake_usec > expiry_usec ? wake_usec - expiry_usec : 0,
+                             AP_HAL::micros64() - wake_usec, missed);
+    }
 }
 
 bool TimerPollable::setup_timer(uint32_t timeout_usec)
@@ -83,6 +95,9 @@ bool TimerPollable::adjust_timer(uint32_t timeout_usec)
         return false;
     }
 
+    _period_usec = timeout_usec;
+    _next_usec = AP_HAL::micros64() + timeout_usec;
+
     return true;
 }
 
@@ -100,6 +115,7 @@ TimerPollable *PollerThread::add_timer(TimerPollable::PeriodicCb cb,
         return nullptr;
     }
 
+    p->_thread = this;
     _timers.push_back(p);
 
     return p;
@@ -57,6 +57,11 @@ protected:
     PeriodicCb _cb;
     WrapperCb *_wrapper;
     bool _removeme = false;
+
+    // thread running the timer, told how late each expiry was served
+    Thread *_thread = nullptr;
+    uint64_t _next_usec = 0;
+    uint32_t _period_usec = 0;
 };
 
 
@@ -29,6 +29,8 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_HAL/utility/OwnPtr.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 
 #include "GPIO.h"
 #include "PollerThread.h"
@@ -86,15 +88,34 @@ public:
     PollerThread thread;
     Semaphore sem;
     int fd[MAX_SUBDEVS];
+    // the mode is held by the kernel per chip select, so track it
+    // per subdev to avoid a SPI_IOC_WR_MODE on every transfer
+    int16_t last_mode[MAX_SUBDEVS];
     uint16_t bus;
-    int16_t last_mode = -1;
     uint8_t ref;
+
+    struct Stats {
+        uint32_t transactions;  // CS framed transactions
+        uint32_t messages;      // SPI_IOC_MESSAGE syscalls
+        uint32_t mode_changes;  // SPI_IOC_WR_MODE syscalls
+        uint32_t errors;
+        uint64_t bytes;
+    } stats;
+    // snapshot at the last bus_info() call, for rates
+    Stats last_stats;
+    uint32_t last_stats_ms;
 };
 
 SPIBus::SPIBus(uint16_t bus_)
     : bus(bus_)
+    , stats{}
+    , last_stats{}
+    , last_stats_ms(0)
 {
     memset(fd, -1, sizeof(fd));
+    for (unsigned i = 0; i < MAX_SUBDEVS; i++) {
+        last_mode[i] = -1;
+    }
 }
 
 SPIBus::~SPIBus()
@@ -173,41 +194,26 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
-bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
-                         uint8_t *recv, uint32_t recv_len)
+void SPIDevice::_fill_msg(struct spi_ioc_transfer &msg, const uint8_t *tx,
+                          uint8_t *rx, uint32_t len) const
 {
-    struct spi_ioc_transfer msgs[2] = { };
-    unsigned nmsgs = 0;
-    int fd = _bus.fd[_desc.subdev];
-
-    if (send && send_len != 0) {
-        msgs[nmsgs].tx_buf = (uint64_t) send;
-        msgs[nmsgs].rx_buf = 0;
-        msgs[nmsgs].len = send_len;
-        msgs[nmsgs].speed_hz = _speed;
-        msgs[nmsgs].delay_usecs = 0;
-        msgs[nmsgs].bits_per_word = _desc.bits_per_word;
-        msgs[nmsgs].cs_change = 0;
-        nmsgs++;
-    }
-
-    if (recv && recv_len != 0) {
-        msgs[nmsgs].tx_buf = 0;
-        msgs[nmsgs].rx_buf = (uint64_t) recv;
-        msgs[nmsgs].len = recv_len;
-        msgs[nmsgs].speed_hz = _speed;
-        msgs[nmsgs].delay_usecs = 0;
-        msgs[nmsgs].bits_per_word = _desc.bits_per_word;
-        msgs[nmsgs].cs_change = 0;
-        nmsgs++;
-    }
+    msg = { };
+    msg.tx_buf = (uint64_t) tx;
+    msg.rx_buf = (uint64_t) rx;
+    msg.len = len;
+    msg.speed_hz = _speed;
+    msg.delay_usecs = 0;
+    msg.bits_per_word = _desc.bits_per_word;
+    msg.cs_change = 0;
+}
 
-    if (!nmsgs) {
-        return false;
-    }
+bool SPIDevice::_message(struct spi_ioc_transfer *msgs, unsigned nmsgs)
+{
+    int fd = _bus.fd[_desc.subdev];
+    int16_t &last_mode = _bus.last_mode[_desc.subdev];
 
 #if DEBUG
-    if (_desc.mode == _bus.last_mode) {
+    if (_desc.mode == last_mode) {
         /*
           the mode in the kernel is not tied to the file descriptor,
           so there is a chance some other process has changed it since
@@ -220,74 +226,137 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         if (ioctl(fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
             hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
                                 fd, strerror(errno));
-            _bus.last_mode = -1;
-        } else if (current_mode != _bus.last_mode) {
+            last_mode = -1;
+        } else if (current_mode != last_mode) {
             hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
-                                fd, (unsigned)_bus.last_mode, (unsigned)current_mode);
-            _bus.last_mode = -1;
+                                fd, (unsigned)last_mode, (unsigned)current_mode);
+            last_mode = -1;
         }
     }
 #endif
 
     int r;
-    if (_desc.mode != _bus.last_mode) {
+    if (_desc.mode != last_mode) {
+        _bus.stats.mode_changes++;
         r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
         if (r < 0) {
+            _bus.stats.errors++;
             hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                                 fd, strerror(errno));
             return false;
         }
-        _bus.last_mode = _desc.mode;
+        last_mode = _desc.mode;
     }
 
-    _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
-    _cs_release();
+    _bus.stats.messages++;
+    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), msgs);
 
     if (r == -1) {
+        _bus.stats.errors++;
         hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
                             fd, strerror(errno));
         return false;
     }
 
+    // on success the kernel returns the number of bytes clocked
+    _bus.stats.bytes += r;
+
     return true;
 }
 
+bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len)
+{
+    struct spi_ioc_transfer msgs[2];
+    unsigned nmsgs = 0;
+
+    if (send && send_len != 0) {
+        _fill_msg(msgs[nmsgs++], send, nullptr, send_len);
+    }
+
+    if (recv && recv_len != 0) {
+        _fill_msg(msgs[nmsgs++], nullptr, recv, recv_len);
+    }
+
+    if (!nmsgs) {
+        return false;
+    }
+
+    _bus.stats.transactions++;
+
+    _cs_assert();
+    bool ret = _message(msgs, nmsgs);
+    _cs_release();
+
+    return ret;
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
-    struct spi_ioc_transfer msgs[1] = { };
-    int fd = _bus.fd[_desc.subdev];
+    struct spi_ioc_transfer msgs[1];
 
     if (!send || !recv || len == 0) {
         return false;
     }
 
-    msgs[0].tx_buf = (uint64_t) send;
-    msgs[0].rx_buf = (uint64_t) recv;
-    msgs[0].len = len;
-    msgs[0].speed_hz = _speed;
-    msgs[0].delay_usecs = 0;
-    msgs[0].bits_per_word = _desc.bits_per_word;
-    msgs[0].cs_change = 0;
-
-    int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
-    if (r < 0) {
-        hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                            fd, strerror(errno));
-        return false;
-    }
+    _fill_msg(msgs[0], send, recv, len);
+
+    _bus.stats.transactions++;
 
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(1), &msgs);
+    bool ret = _message(msgs, 1);
     _cs_release();
 
-    if (r == -1) {
-        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
-                            fd, strerror(errno));
+    return ret;
+}
+
+bool SPIDevice::transfer_batch(const Transfer *transfers, uint8_t count)
+{
+    /*
+      with a GPIO chip select the kernel can't toggle CS between
+      transactions for us, so they have to go out one at a time
+     */
+    if (_desc.cs_pin != SPI_CS_KERNEL) {
+        return AP_HAL::SPIDevice::transfer_batch(transfers, count);
+    }
+
+    if (count == 0) {
         return false;
     }
 
+    struct spi_ioc_transfer msgs[2 * LINUX_SPI_MAX_BATCH];
+
+    while (count > 0) {
+        const uint8_t n = MIN(count, LINUX_SPI_MAX_BATCH);
+        unsigned nmsgs = 0;
+
+        for (uint8_t i = 0; i < n; i++) {
+            const Transfer &t = transfers[i];
+            const unsigned first = nmsgs;
+            if (t.send && t.send_len != 0) {
+                _fill_msg(msgs[nmsgs++], t.send, nullptr, t.send_len);
+            }
+            if (t.recv && t.recv_len != 0) {
+                _fill_msg(msgs[nmsgs++], nullptr, t.recv, t.recv_len);
+            }
+            if (nmsgs == first) {
+                return false;
+            }
+            // deselect between transactions. On the last segment of
+            // the message cs_change would instead leave CS asserted
+            msgs[nmsgs-1].cs_change = (i + 1 < n);
+        }
+
+        _bus.stats.transactions += n;
+        if (!_message(msgs, nmsgs)) {
+            return false;
+        }
+
+        transfers += n;
+        count -= n;
+    }
+
     return true;
 }
 
@@ -332,6 +401,7 @@ AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
         snprintf(name, sizeof(name), "ap-spi-%u", _bus.bus);
 
         _bus.thread.set_stack_size(AP_LINUX_SENSORS_STACK_SIZE);
+        _bus.thread.set_class(AP_HAL::Scheduler::PRIORITY_SPI);
         _bus.thread.start(name, AP_LINUX_SENSORS_SCHED_POLICY,
                           AP_LINUX_SENSORS_SCHED_PRIO);
     }
@@ -413,6 +483,33 @@ SPIDeviceManager::_create_device(SPIBus &b, SPIDesc &desc) const
     return dev;
 }
 
+void SPIDeviceManager::bus_info(ExpandingString &str)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    str.printf("SPIV1\n");
+    str.printf("BUS  TXN/s  IOCTL/s  MODE/s  KB/s  ERR\n");
+    for (auto *b : _buses) {
+        SPIBus::Stats s;
+        {
+            WITH_SEMAPHORE(b->sem);
+            s = b->stats;
+        }
+        const uint32_t dt_ms = MAX(now_ms - b->last_stats_ms, 1U);
+        const SPIBus::Stats &l = b->last_stats;
+        const uint32_t ioctls = s.messages + s.mode_changes;
+        const uint32_t last_ioctls = l.messages + l.mode_changes;
+        str.printf("%3u %6u %8u %7u %5u %4u\n",
+                   unsigned(b->bus),
+                   unsigned((s.transactions - l.transactions) * 1000ULL / dt_ms),
+                   unsigned((ioctls - last_ioctls) * 1000ULL / dt_ms),
+                   unsigned((s.mode_changes - l.mode_changes) * 1000ULL / dt_ms),
+                   unsigned((s.bytes - l.bytes) * 1000ULL / (dt_ms * 1024ULL)),
+                   unsigned(s.errors));
+        b->last_stats = s;
+        b->last_stats_ms = now_ms;
+    }
+}
+
 void SPIDeviceManager::_unregister(SPIBus &b)
 {
     if (b.ref == 0 || --b.ref > 0) {
@@ -22,8 +22,15 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+struct spi_ioc_transfer;
+
 namespace Linux {
 
+// transactions queued into one SPI_IOC_MESSAGE by transfer_batch()
+#ifndef LINUX_SPI_MAX_BATCH
+#define LINUX_SPI_MAX_BATCH 8
+#endif
+
 class SPIBus;
 class SPIDesc;
 
@@ -69,6 +76,12 @@ public:
     /* See AP_HAL::SPIDevice::transfer_fullduplex() */
     bool transfer_fullduplex(uint8_t *send_recv, uint32_t len) override;
 
+    /*
+     * See AP_HAL::SPIDevice::transfer_batch(). With kernel chip select
+     * up to LINUX_SPI_MAX_BATCH transactions go out in one syscall
+     */
+    bool transfer_batch(const Transfer *transfers, uint8_t count) override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -95,6 +108,18 @@ protected:
      * Deselect device if using userspace CS
      */
     void _cs_release();
+
+    /*
+     * Fill one spi_ioc_transfer for this device
+     */
+    void _fill_msg(struct spi_ioc_transfer &msg, const uint8_t *tx,
+                   uint8_t *rx, uint32_t len) const;
+
+    /*
+     * Set the bus mode if it changed since it was last set, then
+     * submit nmsgs segments as one transaction
+     */
+    bool _message(struct spi_ioc_transfer *msgs, unsigned nmsgs);
 };
 
 class SPIDeviceManager : public AP_HAL::SPIDeviceManager {
@@ -128,6 +153,9 @@ public:
     /* See AP_HAL::SPIDeviceManager::get_device_name() */
     const char *get_device_name(uint8_t idx) override;
 
+    /* See AP_HAL::SPIDeviceManager::bus_info() */
+    void bus_info(ExpandingString &str) override;
+
 protected:
     void _unregister(SPIBus &b);
     AP_HAL::SPIDevice *_create_device(SPIBus &b, SPIDesc &device_desc) const;
@@ -155,3 +155,12 @@ void SPIUARTDriver::_timer_tick(void)
 
     _last_update_timestamp = AP_HAL::micros();
 }
+
+short SPIUARTDriver::poll_events(int &fd)
+{
+    // the SPI bridge has no file descriptor, it is serviced on a timer
+    if (!_external) {
+        return 0;
+    }
+    return UARTDriver::poll_events(fd);
+}
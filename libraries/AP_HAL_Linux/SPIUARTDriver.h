@@ -11,6 +11,7 @@ public:
     SPIUARTDriver();
     void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
     void _timer_tick(void) override;
+    short poll_events(int &fd) override;
     uint32_t get_baud_rate() const override {
         return high_speed_set ? 4000000U : 1000000U;
     }
@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -33,7 +34,10 @@ extern const AP_HAL::HAL& hal;
 #define APM_LINUX_SCRIPTING_PRIORITY     1
 
 #define APM_LINUX_TIMER_RATE            1000
-#define APM_LINUX_UART_RATE             100
+// the UART thread sleeps in poll() until a port is ready
+#define APM_LINUX_UART_RATE             0
+// longest poll() sleep, for ports that have no file descriptor
+#define APM_LINUX_UART_MAX_SLEEP_US     10000
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_NAVIO ||    \
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBRAIN2 || \
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BH || \
@@ -58,6 +62,7 @@ extern const AP_HAL::HAL& hal;
         .policy = SCHED_FIFO,                                   \
         .prio = APM_LINUX_##UPPER_NAME_##_PRIORITY,             \
         .rate = APM_LINUX_##UPPER_NAME_##_RATE,                 \
+        .base = PRIORITY_##UPPER_NAME_,                         \
     }
 
 Scheduler::Scheduler()
@@ -100,6 +105,48 @@ void Scheduler::init_cpu_affinity()
     }
 }
 
+bool Scheduler::get_class_cpus(priority_base base, cpu_set_t &cpus) const
+{
+    if (unsigned(base) >= ARRAY_SIZE(_class_cpu_mask) || _class_cpu_mask[base] == 0) {
+        return false;
+    }
+
+    CPU_ZERO(&cpus);
+    for (uint8_t i = 0; i < 32; i++) {
+        if (_class_cpu_mask[base] & (1U << i)) {
+            CPU_SET(i, &cpus);
+        }
+    }
+
+    return true;
+}
+
+bool Scheduler::set_thread_affinity(priority_base base, uint32_t cpu_mask)
+{
+    if (unsigned(base) >= ARRAY_SIZE(_class_cpu_mask)) {
+        return false;
+    }
+
+    _class_cpu_mask[base] = cpu_mask;
+
+    cpu_set_t cpus;
+    if (!get_class_cpus(base, cpus)) {
+        // back to whatever the process is allowed
+        if (CPU_COUNT(&_cpu_affinity)) {
+            cpus = _cpu_affinity;
+        } else {
+            CPU_ZERO(&cpus);
+            for (long i = 0; i < sysconf(_SC_NPROCESSORS_CONF) && i < CPU_SETSIZE; i++) {
+                CPU_SET(i, &cpus);
+            }
+        }
+    }
+
+    Thread::set_class_affinity(base, cpus);
+
+    return true;
+}
+
 void Scheduler::init()
 {
     int ret;
@@ -109,6 +156,7 @@ void Scheduler::init()
         int policy;
         int prio;
         uint32_t rate;
+        priority_base base;
     } sched_table[] = {
         SCHED_THREAD(timer, TIMER),
         SCHED_THREAD(uart, UART),
@@ -118,9 +166,17 @@ void Scheduler::init()
 
     _main_ctx = pthread_self();
 
+    _uart_wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_uart_wakeup_fd < 0) {
+        AP_HAL::panic("Scheduler: Failed to create UART wakeup: %m");
+    }
+
     init_realtime();
     init_cpu_affinity();
 
+    _main_thread.set_class(PRIORITY_MAIN);
+    _main_thread.adopt_current("ap-main", APM_LINUX_MAIN_PRIORITY);
+
     /* set barrier to N + 1 threads: worker threads + main */
     unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
@@ -132,7 +188,10 @@ void Scheduler::init()
     for (size_t i = 0; i < ARRAY_SIZE(sched_table); i++) {
         const struct sched_table *t = &sched_table[i];
 
-        t->thread->set_rate(t->rate);
+        if (t->rate != 0) {
+            t->thread->set_rate(t->rate);
+        }
+        t->thread->set_class(t->base);
         t->thread->set_stack_size(1024 * 1024);
         t->thread->start(t->name, t->policy, t->prio);
     }
@@ -290,9 +349,61 @@ void Scheduler::_rcin_task()
     RCInput::from(hal.rcin)->_timer_tick();
 }
 
+/*
+  wake the UART thread out of poll(), called when data is queued on
+  a port. The eventfd is only written while the thread is sleeping
+ */
+void Scheduler::wake_uart_thread()
+{
+    if (_uart_wakeup_armed.exchange(false)) {
+        const uint64_t v = 1;
+        IGNORE_RETURN(write(_uart_wakeup_fd, &v, sizeof(v)));
+    }
+}
+
+/*
+  service the UARTs, then sleep until one of them is readable, one
+  that was backed up is writable, new data is queued or the timeout
+  for ports without a file descriptor expires
+ */
 void Scheduler::_uart_task()
 {
+    struct pollfd fds[1 + AP_HAL::HAL::num_serial];
+
+    _uart_wakeup_armed = true;
+
+    const uint64_t start_us = AP_HAL::micros64();
     _run_uarts();
+    const uint32_t run_us = AP_HAL::micros64() - start_us;
+
+    nfds_t nfds = 0;
+    uint8_t fd_serial[AP_HAL::HAL::num_serial];
+    fds[nfds++] = { _uart_wakeup_fd, POLLIN, 0 };
+    for (uint8_t i = 0; i < hal.num_serial; i++) {
+        int fd = -1;
+        const short events = UARTDriver::from(hal.serial(i))->poll_events(fd);
+        if (events != 0) {
+            fd_serial[nfds-1] = i;
+            fds[nfds++] = { fd, events, 0 };
+        }
+    }
+
+    if (poll(fds, nfds, APM_LINUX_UART_MAX_SLEEP_US / 1000) > 0) {
+        if (fds[0].revents & POLLIN) {
+            uint64_t v;
+            IGNORE_RETURN(read(_uart_wakeup_fd, &v, sizeof(v)));
+        }
+        // stop polling devices that hung up or failed, such as an
+        // unplugged tty, or poll() returns at once and the thread spins
+        for (nfds_t i = 1; i < nfds; i++) {
+            if (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                UARTDriver::from(hal.serial(fd_serial[i-1]))->poll_error();
+            }
+        }
+    }
+    _uart_wakeup_armed = false;
+
+    _uart_thread.note_wakeup(0, run_us, 0);
 }
 
 void Scheduler::_io_task()
@@ -357,7 +468,19 @@ bool Scheduler::SchedulerThread::_run()
 {
     _sched._wait_all_threads();
 
-    return PeriodicThread::_run();
+    if (_period_usec != 0) {
+        return PeriodicThread::_run();
+    }
+
+    // event driven, the task does its own sleeping
+    while (!_should_exit) {
+        _task();
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
 }
 
 void Scheduler::teardown()
@@ -366,6 +489,7 @@ void Scheduler::teardown()
     _io_thread.stop();
     _rcin_thread.stop();
     _uart_thread.stop();
+    wake_uart_thread();
 
     _timer_thread.join();
     _io_thread.join();
@@ -418,6 +542,7 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
 
     // Add 256k to HAL-independent requested stack size
     thread->set_stack_size(256 * 1024 + stack_size);
+    thread->set_class(base);
 
     /*
      * We should probably store the thread handlers and join() when exiting,
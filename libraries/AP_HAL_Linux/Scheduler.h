@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <pthread.h>
 
 #include "AP_HAL_Linux.h"
@@ -60,6 +61,20 @@ public:
      */
     void set_cpu_affinity(const cpu_set_t &cpu_affinity) { _cpu_affinity = cpu_affinity; }
 
+    /* See AP_HAL::Scheduler::set_thread_affinity() */
+    bool set_thread_affinity(priority_base base, uint32_t cpu_mask) override;
+
+    /*
+      CPUs threads of class @base are restricted to, false if they
+      just follow the process affinity
+     */
+    bool get_class_cpus(priority_base base, cpu_set_t &cpus) const;
+
+    /*
+      wake the UART thread to send newly queued data
+     */
+    void wake_uart_thread();
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -116,7 +131,17 @@ private:
     pthread_t _main_ctx;
 
     Semaphore _io_semaphore;
+
+    // UART thread wakeup, only signalled while it is in poll()
+    int _uart_wakeup_fd = -1;
+    std::atomic<bool> _uart_wakeup_armed;
     cpu_set_t _cpu_affinity;
+
+    // the vehicle's own thread, tracked for stats and affinity
+    Thread _main_thread{nullptr};
+
+    // per priority class CPU masks, 0 for no restriction
+    uint32_t _class_cpu_mask[PRIORITY_NET + 1] {};
 };
 
 }
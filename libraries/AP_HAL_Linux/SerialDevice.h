@@ -23,4 +23,10 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * File descriptor the UART thread can poll() for readability and
+     * writability, -1 if the device has to be polled on a timer
+     */
+    virtual int get_poll_fd() const { return -1; }
 };
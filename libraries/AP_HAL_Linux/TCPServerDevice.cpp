@@ -47,7 +47,8 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
     if (sock == nullptr) {
         return -1;
     }
-    ssize_t ret = sock->recv(buf, n, 1);
+    // the UART thread only reads once poll() says there is data
+    ssize_t ret = sock->recv(buf, n, 0);
     if (ret == 0) {
         // EOF, go back to waiting for a new connection
         delete sock;
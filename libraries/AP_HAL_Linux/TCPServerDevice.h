@@ -19,6 +19,11 @@ public:
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
 
+    // the client once connected, else the listener so we wake on accept
+    int get_poll_fd() const override {
+        return sock != nullptr ? sock->get_read_fd() : listener.get_read_fd();
+    }
+
 private:
     SocketAPM_native listener{false};
     SocketAPM_native *sock = nullptr;
@@ -18,12 +18,16 @@
 
 #include <alloca.h>
 #include <limits.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 #include <utility>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Logger/AP_Logger.h>
 #include <AP_Math/AP_Math.h>
 #include "Scheduler.h"
 
@@ -33,13 +37,39 @@ extern const AP_HAL::HAL &hal;
 
 namespace Linux {
 
+Thread *Thread::_first;
+pthread_mutex_t Thread::_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pid_t current_tid()
+{
+    return (pid_t)syscall(SYS_gettid);
+}
+
+Thread::~Thread()
+{
+    _list_remove();
+}
 
 void *Thread::_run_trampoline(void *arg)
 {
     Thread *thread = static_cast<Thread *>(arg);
+    thread->_ctx = pthread_self();
+    thread->_tid = current_tid();
+    // list the thread from here rather than from start(), an auto freed
+    // thread may already be gone by the time pthread_create() returns
+    thread->_list_add();
+
+    cpu_set_t cpus;
+    if (Scheduler::from(hal.scheduler)->get_class_cpus(thread->_class, cpus) &&
+        sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        fprintf(stderr, "Failed to set affinity for thread '%s': %m\n",
+                thread->_name);
+    }
+
     thread->_poison_stack();
     thread->_run();
 
+    thread->_list_remove();
     if (thread->_auto_free) {
         delete thread;
     }
@@ -190,20 +220,245 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
-    r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
+    // everything the thread or the thread list reads must be set before
+    // it runs, after pthread_create() this object may already be freed
+    if (name) {
+        strncpy_noterm(_name, name, sizeof(_name) - 1);
+    }
+    _prio = prio;
+    _started = true;
+    const bool auto_free = _auto_free;
+
+    pthread_t ctx;
+    r = pthread_create(&ctx, &attr, &Thread::_run_trampoline, this);
+    pthread_attr_destroy(&attr);
     if (r != 0) {
+        _started = false;
         AP_HAL::panic("Failed to create thread '%s': %s",
                       name, strerror(r));
     }
-    pthread_attr_destroy(&attr);
 
     if (name) {
-        pthread_setname_np(_ctx, name);
+        pthread_setname_np(ctx, name);
+    }
+    if (!auto_free) {
+        // the trampoline sets the same value, but join() may be called first
+        _ctx = ctx;
     }
 
+    return true;
+}
+
+void Thread::adopt_current(const char *name, int prio)
+{
+    _ctx = pthread_self();
+    _tid = current_tid();
+    strncpy_noterm(_name, name, sizeof(_name) - 1);
+    _prio = prio;
     _started = true;
+    _list_add();
+}
 
-    return true;
+bool Thread::set_affinity(const cpu_set_t &cpus)
+{
+    if (!_started || _ctx == 0) {
+        return false;
+    }
+
+    return pthread_setaffinity_np(_ctx, sizeof(cpus), &cpus) == 0;
+}
+
+void Thread::note_wakeup(uint32_t latency_us, uint32_t run_us, uint32_t missed)
+{
+    _stats.wakeups++;
+    _stats.overruns += missed;
+    _stats.lat_sum_us += latency_us;
+    _stats.run_sum_us += run_us;
+    for (uint8_t i = 0; i < NUM_WINDOWS; i++) {
+        _stats.lat_max_us[i] = MAX(_stats.lat_max_us[i], latency_us);
+        _stats.run_max_us[i] = MAX(_stats.run_max_us[i], run_us);
+    }
+}
+
+void Thread::_list_add()
+{
+    pthread_mutex_lock(&_list_mutex);
+    if (!_listed) {
+        _next = _first;
+        _first = this;
+        _listed = true;
+    }
+    pthread_mutex_unlock(&_list_mutex);
+}
+
+void Thread::_list_remove()
+{
+    pthread_mutex_lock(&_list_mutex);
+    for (Thread **t = &_first; *t != nullptr; t = &(*t)->_next) {
+        if (*t == this) {
+            *t = _next;
+            _listed = false;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_list_mutex);
+}
+
+void Thread::set_class_affinity(AP_HAL::Scheduler::priority_base base,
+                                const cpu_set_t &cpus)
+{
+    pthread_mutex_lock(&_list_mutex);
+    for (Thread *t = _first; t != nullptr; t = t->_next) {
+        if (t->_class == base && !t->set_affinity(cpus)) {
+            fprintf(stderr, "Failed to set affinity for thread '%s'\n", t->_name);
+        }
+    }
+    pthread_mutex_unlock(&_list_mutex);
+}
+
+/*
+  involuntary context switches of a thread, i.e. how often something
+  of equal or higher priority took the CPU from it
+ */
+static uint32_t thread_preemptions(pid_t tid)
+{
+    char path[48];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", int(tid));
+    FILE *f = fopen(path, "re");
+    if (f == nullptr) {
+        return 0;
+    }
+    char line[128];
+    unsigned n = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (sscanf(line, "nonvoluntary_ctxt_switches: %u", &n) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static uint64_t thread_cpu_ns(pthread_t ctx)
+{
+    clockid_t cid;
+    struct timespec ts;
+    if (pthread_getcpuclockid(ctx, &cid) != 0 ||
+        clock_gettime(cid, &ts) != 0) {
+        return 0;
+    }
+    return uint64_t(ts.tv_sec) * AP_NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/*
+  usage of the thread since reader @w last asked
+ */
+void Thread::_usage(Window w, Usage &u)
+{
+    Snapshot now;
+    now.time_us = AP_HAL::micros64();
+    now.cpu_ns = thread_cpu_ns(_ctx);
+    now.preemptions = thread_preemptions(_tid);
+    now.wakeups = _stats.wakeups;
+    now.overruns = _stats.overruns;
+    now.lat_sum_us = _stats.lat_sum_us;
+    now.run_sum_us = _stats.run_sum_us;
+
+    Snapshot &last = _snapshot[w];
+    const uint64_t dt_us = MAX(now.time_us - last.time_us, uint64_t(1));
+    const uint32_t wakeups = now.wakeups - last.wakeups;
+
+    u.load_pct = (now.cpu_ns - last.cpu_ns) * 0.1f / dt_us;
+    u.preempt_hz = (now.preemptions - last.preemptions) * 1000000ULL / dt_us;
+    u.wakeup_hz = wakeups * 1000000ULL / dt_us;
+    u.overruns = now.overruns - last.overruns;
+    u.lat_avg_us = wakeups ? (now.lat_sum_us - last.lat_sum_us) / wakeups : 0;
+    u.run_avg_us = wakeups ? (now.run_sum_us - last.run_sum_us) / wakeups : 0;
+    u.lat_max_us = _stats.lat_max_us[w];
+    u.run_max_us = _stats.run_max_us[w];
+    _stats.lat_max_us[w] = 0;
+    _stats.run_max_us[w] = 0;
+
+    last = now;
+}
+
+void Thread::threads_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("LinuxThreadsV1\n");
+
+    pthread_mutex_lock(&_list_mutex);
+    for (Thread *t = _first; t != nullptr; t = t->_next) {
+        Usage u;
+        t->_usage(WINDOW_SYS, u);
+
+        cpu_set_t cpus;
+        uint32_t cpu_mask = 0;
+        if (pthread_getaffinity_np(t->_ctx, sizeof(cpus), &cpus) == 0) {
+            for (uint8_t i = 0; i < 32; i++) {
+                if (CPU_ISSET(i, &cpus)) {
+                    cpu_mask |= 1U << i;
+                }
+            }
+        }
+
+        str.printf("%-15.15s TID=%-6d PRI=%2d CPUS=0x%02x LOAD=%5.1f%% PREEMPT=%4u/s"
+                   " WAKE=%5u/s OVR=%3u LAT=%4u/%5uus RUN=%4u/%5uus STACK=%u/%u\n",
+                   t->_name, int(t->_tid), t->_prio, unsigned(cpu_mask),
+                   u.load_pct, unsigned(u.preempt_hz),
+                   unsigned(u.wakeup_hz), unsigned(u.overruns),
+                   unsigned(u.lat_avg_us), unsigned(u.lat_max_us),
+                   unsigned(u.run_avg_us), unsigned(u.run_max_us),
+                   unsigned(t->get_stack_usage() * sizeof(uint32_t)),
+                   unsigned(t->_stack_size));
+    }
+    pthread_mutex_unlock(&_list_mutex);
+}
+
+void Thread::log_thread_info()
+{
+#if HAL_LOGGING_ENABLED
+    static uint8_t next_id;
+
+    pthread_mutex_lock(&_list_mutex);
+    Thread *t = _first;
+    uint8_t id = 0;
+    while (t != nullptr && id < next_id) {
+        t = t->_next;
+        id++;
+    }
+    if (t == nullptr) {
+        // wrap around to the first thread
+        t = _first;
+        id = 0;
+    }
+    if (t != nullptr) {
+        Usage u;
+        t->_usage(WINDOW_LOG, u);
+
+// @LoggerMessage: THRD
+// @Description: Linux thread usage, one thread per message
+// @Field: TimeUS: Time since system startup
+// @Field: TID: Linux thread id, as shown in @SYS/threads.txt
+// @Field: Name: thread name
+// @Field: Load: share of one CPU used by the thread
+// @Field: Pre: involuntary context switches
+// @Field: Wake: wakeups
+// @Field: Ovr: whole periods missed since the last message
+// @Field: Lat: average wakeup latency
+// @Field: MaxLat: worst wakeup latency
+// @Field: Run: average run time per wakeup
+// @Field: MaxRun: worst run time per wakeup
+        AP::logger().Write("THRD", "TimeUS,TID,Name,Load,Pre,Wake,Ovr,Lat,MaxLat,Run,MaxRun",
+                           "s#-%zz-ssss", "F--000-FFFF", "QiNfIIIIIII",
+                           AP_HAL::micros64(), int32_t(t->_tid), t->_name, u.load_pct,
+                           u.preempt_hz, u.wakeup_hz, u.overruns,
+                           u.lat_avg_us, u.lat_max_us,
+                           u.run_avg_us, u.run_max_us);
+        next_id = id + 1;
+    }
+    pthread_mutex_unlock(&_list_mutex);
+#endif
 }
 
 bool Thread::is_current_thread()
@@ -259,16 +514,26 @@ bool PeriodicThread::_run()
     uint64_t next_run_usec = AP_HAL::micros64() + _period_usec;
 
     while (!_should_exit) {
-        uint64_t dt = next_run_usec - AP_HAL::micros64();
+        uint64_t now = AP_HAL::micros64();
+        uint64_t dt = next_run_usec - now;
+        uint32_t missed = 0;
         if (dt > _period_usec) {
             // we've lost sync - restart
-            next_run_usec = AP_HAL::micros64();
+            if (now > next_run_usec) {
+                missed = (now - next_run_usec) / _period_usec;
+            }
+            next_run_usec = now;
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
         }
+
+        const uint64_t wake_usec = AP_HAL::micros64();
+        const uint32_t latency = wake_usec > next_run_usec ? wake_usec - next_run_usec : 0;
         next_run_usec += _period_usec;
 
         _task();
+
+        note_wakeup(latency, AP_HAL::micros64() - wake_usec, missed);
     }
 
     _started = false;
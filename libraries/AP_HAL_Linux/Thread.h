@@ -18,10 +18,15 @@
 
 #include <pthread.h>
 #include <inttypes.h>
+#include <sched.h>
 #include <stdlib.h>
+#include <sys/types.h>
 
+#include <AP_HAL/Scheduler.h>
 #include <AP_HAL/utility/functor.h>
 
+class ExpandingString;
+
 namespace Linux {
 
 /*
@@ -33,10 +38,48 @@ public:
 
     Thread(task_t t) : _task(t) { }
 
-    virtual ~Thread() { }
+    virtual ~Thread();
 
     bool start(const char *name, int policy, int prio);
 
+    /*
+     * Track the calling thread, which was not created by us, as if it
+     * had been started with start()
+     */
+    void adopt_current(const char *name, int prio);
+
+    /*
+     * Kind of work the thread does, used to pick its CPU affinity. Set
+     * it before start()
+     */
+    void set_class(AP_HAL::Scheduler::priority_base base) { _class = base; }
+    AP_HAL::Scheduler::priority_base get_class() const { return _class; }
+
+    bool set_affinity(const cpu_set_t &cpus);
+
+    /*
+     * Called by the thread itself once per wakeup with how late it
+     * woke relative to its schedule, how long its work took and how
+     * many whole periods it missed before this one
+     */
+    void note_wakeup(uint32_t latency_us, uint32_t run_us, uint32_t missed);
+
+    /*
+     * One line per thread for @SYS/threads.txt
+     */
+    static void threads_info(ExpandingString &str);
+
+    /*
+     * Log THRD for one thread per call, cycling through them
+     */
+    static void log_thread_info();
+
+    /*
+     * Apply @cpus to every running thread of class @base
+     */
+    static void set_class_affinity(AP_HAL::Scheduler::priority_base base,
+                                   const cpu_set_t &cpus);
+
     bool is_current_thread();
 
     bool is_started() const { return _started; }
@@ -72,9 +115,64 @@ protected:
     struct stack_debug {
         uint32_t *start;
         uint32_t *end;
-    } _stack_debug;
+    } _stack_debug {};
 
     size_t _stack_size = 0;
+
+    AP_HAL::Scheduler::priority_base _class = AP_HAL::Scheduler::PRIORITY_IO;
+    char _name[16] {};
+    int _prio = 0;
+    pid_t _tid = 0;
+
+    // threads.txt and the log each report over their own window
+    enum Window : uint8_t {
+        WINDOW_SYS,
+        WINDOW_LOG,
+        NUM_WINDOWS,
+    };
+
+    // written only by the thread itself
+    struct {
+        uint32_t wakeups;
+        uint32_t overruns;
+        uint64_t lat_sum_us;
+        uint64_t run_sum_us;
+        // peaks since each reader last looked, reset by the reader
+        uint32_t lat_max_us[NUM_WINDOWS];
+        uint32_t run_max_us[NUM_WINDOWS];
+    } _stats {};
+
+    // what a reader saw at the end of its previous window
+    struct Snapshot {
+        uint64_t time_us;
+        uint64_t cpu_ns;
+        uint32_t preemptions;
+        uint32_t wakeups;
+        uint32_t overruns;
+        uint64_t lat_sum_us;
+        uint64_t run_sum_us;
+    } _snapshot[NUM_WINDOWS] {};
+
+    struct Usage {
+        float load_pct;
+        uint32_t preempt_hz;
+        uint32_t wakeup_hz;
+        uint32_t overruns;
+        uint32_t lat_avg_us;
+        uint32_t lat_max_us;
+        uint32_t run_avg_us;
+        uint32_t run_max_us;
+    };
+    void _usage(Window w, Usage &u);
+
+    // every started thread, guarded by _list_mutex
+    Thread *_next = nullptr;
+    bool _listed = false;
+    static Thread *_first;
+    static pthread_mutex_t _list_mutex;
+
+    void _list_add();
+    void _list_remove();
 };
 
 class PeriodicThread : public Thread {
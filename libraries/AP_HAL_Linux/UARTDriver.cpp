@@ -19,7 +19,10 @@
 
 #include <AP_HAL/AP_HAL.h>
 
+#include <AP_Common/ExpandingString.h>
+
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UDPDevice.h"
@@ -28,6 +31,9 @@
 #include <AP_HAL/utility/packetise.h>
 #endif
 
+// how long a device that reported an error or hangup is left out of poll()
+#define UART_POLL_ERROR_RETRY_MS 1000
+
 extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
@@ -268,7 +274,33 @@ ssize_t UARTDriver::_read(uint8_t *buffer, uint16_t count)
         return 0;
     }
 
-    return _readbuf.read(buffer, count);
+    const uint32_t ret = _readbuf.read(buffer, count);
+    if (ret > 0 && _rx_landed_us != 0) {
+        _stats.rx_latency.note(AP_HAL::micros() - _rx_landed_us);
+        _rx_landed_us = 0;
+    }
+    return ret;
+}
+
+uint32_t UARTDriver::_read_span(const uint8_t *&data)
+{
+    if (!_initialised) {
+        return 0;
+    }
+    uint32_t n = 0;
+    data = _readbuf.readptr(n);
+    return data != nullptr ? n : 0;
+}
+
+void UARTDriver::_read_span_advance(uint32_t n)
+{
+    if (!_initialised || !_readbuf.advance(n)) {
+        return;
+    }
+    if (_rx_landed_us != 0) {
+        _stats.rx_latency.note(AP_HAL::micros() - _rx_landed_us);
+        _rx_landed_us = 0;
+    }
 }
 
 bool UARTDriver::_discard_input()
@@ -292,8 +324,19 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
         return 0;
     }
 
+    const bool was_empty = _writebuf.available() == 0;
     size_t ret = _writebuf.write(buffer, size);
+    if (was_empty && ret > 0 && _tx_queued_us == 0) {
+        _tx_queued_us = AP_HAL::micros();
+    }
     _write_mutex.give();
+
+    if (ret > 0) {
+        // the UART thread may be asleep waiting for the device. Wake it
+        // for every write, not just the first into an empty buffer, as
+        // a packetised port can only send once the packet is complete
+        Scheduler::from(hal.scheduler)->wake_uart_thread();
+    }
     return ret;
 }
 
@@ -325,6 +368,22 @@ int UARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 }
 
 
+/*
+  write to the device, keeping count
+ */
+int UARTDriver::_write_counted(const uint8_t *buf, uint16_t n)
+{
+    errno = 0;
+    const int ret = _write_fd(buf, n);
+    _stats.writes++;
+    if (ret > 0) {
+        _stats.tx_bytes += ret;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        _tx_would_block = true;
+    }
+    return ret;
+}
+
 /*
   try to push out one lump of pending bytes
   return true if progress is made
@@ -342,21 +401,24 @@ bool UARTDriver::_write_pending_bytes(void)
     }
 #endif
 
+    _tx_would_block = false;
+
     if (n > 0) {
         int ret;
+        ByteBuffer::IoVec vec[2];
+        const auto n_vec = _writebuf.peekiovec(vec, n);
 
-        if (_packetise) {
-            // keep as a single UDP packet
+        if (_packetise && n_vec > 1) {
+            // keep as a single UDP packet. Only a packet that wraps
+            // around the end of the ring has to be copied out
             uint8_t tmpbuf[n];
             _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
+            ret = _write_counted(tmpbuf, n);
             if (ret > 0)
                 _writebuf.advance(ret);
         } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
             for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
+                ret = _write_counted(vec[i].data, (uint16_t)vec[i].len);
                 if (ret < 0) {
                     break;
                 }
@@ -370,13 +432,20 @@ bool UARTDriver::_write_pending_bytes(void)
         }
     }
 
-    return _writebuf.available() != available_bytes;
+    _tx_progress = _writebuf.available() != available_bytes;
+    if (_tx_progress && _tx_queued_us != 0) {
+        _stats.tx_latency.note(AP_HAL::micros() - _tx_queued_us);
+        _tx_queued_us = 0;
+    }
+
+    return _tx_progress;
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  push any pending bytes to/from the serial port. This is called from
+  the UART thread whenever poll() reports the device ready, or on a
+  timer for devices that can't be polled. Doing it this way reduces
+  the system call overhead in the main task enormously.
  */
 void UARTDriver::_timer_tick(void)
 {
@@ -389,17 +458,20 @@ void UARTDriver::_timer_tick(void)
         num_send--;
     }
 
-    // try to fill the read buffer
+    // try to fill the read buffer, straight into its free space
     int ret;
     ByteBuffer::IoVec vec[2];
+    const bool was_empty = _readbuf.available() == 0;
 
     const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
     for (int i = 0; i < n_vec; i++) {
         ret = _read_fd(vec[i].data, vec[i].len);
+        _stats.reads++;
         if (ret < 0) {
             break;
         }
         _readbuf.commit((unsigned)ret);
+        _stats.rx_bytes += ret;
 
         // update receive timestamp
         _receive_timestamp[_receive_timestamp_idx^1] = AP_HAL::micros64();
@@ -411,9 +483,55 @@ void UARTDriver::_timer_tick(void)
         }
     }
 
+    if (was_empty && _rx_landed_us == 0 && _readbuf.available() > 0) {
+        _rx_landed_us = AP_HAL::micros();
+    }
+
     _in_timer = false;
 }
 
+short UARTDriver::poll_events(int &fd)
+{
+    if (!_initialised) {
+        return 0;
+    }
+    fd = _device->get_poll_fd();
+    if (fd < 0) {
+        return 0;
+    }
+    if (_poll_error_ms != 0 && AP_HAL::millis() - _poll_error_ms < UART_POLL_ERROR_RETRY_MS) {
+        // the device hung up or failed, poll() would return at once
+        // for it so it is serviced on the timer until the retry
+        return 0;
+    }
+    _poll_error_ms = 0;
+
+    short events = 0;
+    if (_readbuf.space() > 0) {
+        events |= POLLIN;
+    }
+    /*
+      only wait for the device to drain if it was full or still
+      taking data. A port that can't send at all, such as an
+      unconnected UDP client, is retried on the timer instead
+     */
+    if (_writebuf.available() > 0 && (_tx_would_block || _tx_progress)) {
+        events |= POLLOUT;
+    }
+    return events;
+}
+
+/*
+  poll() reported POLLHUP, POLLERR or POLLNVAL for the device
+ */
+void UARTDriver::poll_error()
+{
+    _poll_error_ms = AP_HAL::millis();
+    if (_poll_error_ms == 0) {
+        _poll_error_ms = 1;
+    }
+}
+
 void UARTDriver::configure_parity(uint8_t v) {
     UARTDriver::parity = v;
     _device->set_parity(v);
@@ -449,3 +567,35 @@ uint32_t UARTDriver::bw_in_bytes_per_second() const
     const uint32_t bitrate = (_connected && _ip != nullptr) ? 10E6 : _baudrate;
     return bitrate/10; // convert bits to bytes minus overhead
 }
+
+#if HAL_UART_STATS_ENABLED
+void UARTDriver::uart_info(ExpandingString &str, StatsTracker &stats, const uint32_t dt_ms)
+{
+    const uint32_t tx_bytes = stats.tx.update(_stats.tx_bytes);
+    const uint32_t rx_bytes = stats.rx.update(_stats.rx_bytes);
+    const uint32_t writes = _stats.writes - _last_writes;
+    const uint32_t reads = _stats.reads - _last_reads;
+    _last_writes = _stats.writes;
+    _last_reads = _stats.reads;
+
+    // latency peaks are per report
+    const LatencyStats tx_lat = _stats.tx_latency;
+    const LatencyStats rx_lat = _stats.rx_latency;
+    _stats.tx_latency = {};
+    _stats.rx_latency = {};
+
+    str.printf("TX=%8u RX=%8u TXBD=%6u RXBD=%6u WR=%5u RD=%5u"
+               " TXLAT=%5u/%6uus RXLAT=%5u/%6uus %s\n",
+               unsigned(tx_bytes),
+               unsigned(rx_bytes),
+               unsigned((tx_bytes * 10000) / dt_ms),
+               unsigned((rx_bytes * 10000) / dt_ms),
+               unsigned(writes),
+               unsigned(reads),
+               unsigned(tx_lat.count ? tx_lat.sum_us / tx_lat.count : 0),
+               unsigned(tx_lat.max_us),
+               unsigned(rx_lat.count ? rx_lat.sum_us / rx_lat.count : 0),
+               unsigned(rx_lat.max_us),
+               device_path != nullptr ? device_path : "console");
+}
+#endif
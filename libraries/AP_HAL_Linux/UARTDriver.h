@@ -27,6 +27,15 @@ public:
     bool _write_pending_bytes(void);
     virtual void _timer_tick(void) override;
 
+    /*
+      poll() events the UART thread should wait for on @fd before the
+      next _timer_tick(), 0 if the port has to be serviced on a timer
+     */
+    virtual short poll_events(int &fd);
+
+    // poll() reported an error or hangup for the fd from poll_events()
+    void poll_error();
+
     virtual enum flow_control get_flow_control(void) override
     {
         return _device->get_flow_control();
@@ -58,6 +67,11 @@ public:
 
     virtual uint32_t get_baud_rate() const override { return _baudrate; }
 
+#if HAL_UART_STATS_ENABLED
+    // request information on uart I/O for this uart, for @SYS/uarts.txt
+    void uart_info(ExpandingString &str, StatsTracker &stats, const uint32_t dt_ms) override;
+#endif
+
 private:
     AP_HAL::OwnPtr<SerialDevice> _device;
     bool _console;
@@ -78,6 +92,46 @@ private:
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
 
+    // the last write attempt was refused because the device was full
+    bool _tx_would_block;
+    // the last write attempt made progress
+    bool _tx_progress;
+
+    // when poll() last reported an error or hangup, 0 if none
+    uint32_t _poll_error_ms;
+
+    // when data landed in an empty buffer, 0 once it has moved on
+    uint32_t _tx_queued_us;
+    uint32_t _rx_landed_us;
+
+    struct LatencyStats {
+        uint32_t count;
+        uint32_t sum_us;
+        uint32_t max_us;
+        void note(uint32_t us) {
+            count++;
+            sum_us += us;
+            if (us > max_us) {
+                max_us = us;
+            }
+        }
+    };
+
+    struct {
+        uint32_t tx_bytes;
+        uint32_t rx_bytes;
+        uint32_t writes;
+        uint32_t reads;
+        // queued by the vehicle until written to the device
+        LatencyStats tx_latency;
+        // read from the device until consumed by the vehicle
+        LatencyStats rx_latency;
+    } _stats;
+#if HAL_UART_STATS_ENABLED
+    uint32_t _last_writes;
+    uint32_t _last_reads;
+#endif
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -89,6 +143,7 @@ protected:
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
+    int _write_counted(const uint8_t *buf, uint16_t n);
 
     Linux::Semaphore _write_mutex;
 
@@ -99,6 +154,13 @@ protected:
     uint32_t _available() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override WARN_IF_UNUSED;
+    uint32_t _read_span(const uint8_t *&data) override;
+    void _read_span_advance(uint32_t n) override;
+
+#if HAL_UART_STATS_ENABLED
+    uint32_t get_total_tx_bytes() const override { return _stats.tx_bytes; }
+    uint32_t get_total_rx_bytes() const override { return _stats.rx_bytes; }
+#endif
 };
 
 }
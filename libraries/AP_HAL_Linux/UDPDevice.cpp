@@ -20,9 +20,7 @@ UDPDevice::~UDPDevice()
 
 ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
 {
-    if (!socket.pollout(0)) {
-        return -1;
-    }
+    // the socket is non-blocking, a full send buffer fails with EAGAIN
     if (_connected) {
         return socket.send(buf, n);
     }
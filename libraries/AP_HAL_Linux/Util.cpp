@@ -8,8 +8,11 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 
 #include "Heat_Pwm.h"
+#include "Thread.h"
 #include "Util.h"
 
 using namespace Linux;
@@ -259,6 +262,56 @@ bool Util::get_random_vals(uint8_t* data, size_t size)
     return true;
 }
 
+void Util::thread_info(ExpandingString &str)
+{
+    Thread::threads_info(str);
+}
+
+void Util::log_stack_info(void)
+{
+    Thread::log_thread_info();
+}
+
+#if HAL_UART_STATS_ENABLED
+// request information on uart I/O
+void Util::uart_info(ExpandingString &str)
+{
+    // Calculate time since last call
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = MAX(now_ms - sys_uart_stats.last_ms, 1U);
+    sys_uart_stats.last_ms = now_ms;
+
+    // a header to allow for machine parsers to determine format
+    str.printf("UARTV1\n");
+    for (uint8_t i = 0; i < hal.num_serial; i++) {
+        auto *uart = hal.serial(i);
+        if (uart) {
+            str.printf("SERIAL%u ", i);
+            uart->uart_info(str, sys_uart_stats.serial[i], dt_ms);
+        }
+    }
+}
+
+#if HAL_LOGGING_ENABLED
+// Log UART message for each serial port
+void Util::uart_log()
+{
+    // Calculate time since last call
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = MAX(now_ms - log_uart_stats.last_ms, 1U);
+    log_uart_stats.last_ms = now_ms;
+
+    // Loop over all ports
+    for (uint8_t i = 0; i < hal.num_serial; i++) {
+        auto *uart = hal.serial(i);
+        if (uart) {
+            uart->log_stats(i, log_uart_stats.serial[i], dt_ms);
+        }
+    }
+}
+#endif // HAL_LOGGING_ENABLED
+#endif // HAL_UART_STATS_ENABLED
+
 bool Util::parse_cpu_set(const char *str, cpu_set_t *cpu_set) const
 {
     unsigned long cpu1, cpu2;
@@ -95,7 +95,34 @@ public:
     // fills data with random values of requested size
     bool get_random_vals(uint8_t* data, size_t size) override;
 
+    // per thread load, latency and preemption, for @SYS/threads.txt
+    void thread_info(ExpandingString &str) override;
+
+    // log usage of one thread per call
+    void log_stack_info(void) override;
+
+#if HAL_UART_STATS_ENABLED
+    // request information on uart I/O
+    void uart_info(ExpandingString &str) override;
+
+#if HAL_LOGGING_ENABLED
+    // Log UART message for each serial port
+    void uart_log() override;
+#endif
+#endif // HAL_UART_STATS_ENABLED
+
 private:
+#if HAL_UART_STATS_ENABLED
+    // UART stats tracking helper
+    struct uart_stats {
+        AP_HAL::UARTDriver::StatsTracker serial[AP_HAL::HAL::num_serial];
+        uint32_t last_ms;
+    };
+    uart_stats sys_uart_stats;
+#if HAL_LOGGING_ENABLED
+    uart_stats log_uart_stats;
+#endif
+#endif // HAL_UART_STATS_ENABLED
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DISCO
     static ToneAlarm_Disco _toneAlarm;
 #else
@@ -0,0 +1,222 @@
+/*
+  SocketCAN throughput over a virtual CAN interface. Set one up with:
+
+    sudo modprobe vcan
+    sudo ip link add dev vcan0 type vcan
+    sudo ip link set up vcan0
+
+  Each iteration moves a burst of frames, sized like one 400Hz loop of
+  8 DroneCAN ESC commands plus sensor traffic, from one socket to
+  another on the same bus.
+ */
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX && HAL_NUM_CAN_IFACES
+
+#include <AP_HAL_Linux/CANSocketIface.h>
+#include <AP_CANManager/AP_CANManager.h>
+
+#include <fcntl.h>
+#include <net/if.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can/raw.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_CANMANAGER_ENABLED
+// the CAN interfaces log through the manager
+static AP_CANManager can_manager;
+#endif
+
+static const char *vcan_missing = "vcan0 not available, see the top of benchmark_can.cpp";
+
+static const unsigned burst = 16;
+
+// give up on a burst if any of it has not arrived after this long
+static const uint64_t burst_timeout_us = 100000;
+static const char *burst_timeout = "timed out waiting for frames";
+
+static int open_vcan(void)
+{
+    const int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) {
+        return -1;
+    }
+    ifreq ifr {};
+    strncpy(ifr.ifr_name, "vcan0", sizeof(ifr.ifr_name) - 1);
+    sockaddr_can addr {};
+    addr.can_family = AF_CAN;
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0 ||
+        (addr.can_ifindex = ifr.ifr_ifindex,
+         bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) ||
+        fcntl(s, F_SETFL, O_NONBLOCK) < 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static void fill_frames(can_frame *frames, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) {
+        frames[i] = can_frame {};
+        frames[i].can_id = (0x1000 + i) | CAN_EFF_FLAG;
+        frames[i].can_dlc = 8;
+        memset(frames[i].data, i, 8);
+    }
+}
+
+/*
+  one write() and one read() per frame, as the interface did before
+  batching
+ */
+static void BM_SocketCAN_PerFrame(benchmark::State& state)
+{
+    const int tx = open_vcan();
+    const int rx = open_vcan();
+    if (tx < 0 || rx < 0) {
+        state.SkipWithError(vcan_missing);
+        return;
+    }
+    can_frame frames[burst];
+    fill_frames(frames, burst);
+
+    while (state.KeepRunning()) {
+        unsigned sent = 0;
+        while (sent < burst && write(tx, &frames[sent], sizeof(can_frame)) == sizeof(can_frame)) {
+            sent++;
+        }
+        if (sent < burst) {
+            state.SkipWithError("write failed");
+            break;
+        }
+        const uint64_t deadline = AP_HAL::micros64() + burst_timeout_us;
+        unsigned received = 0;
+        while (received < burst && AP_HAL::micros64() < deadline) {
+            can_frame f;
+            if (read(rx, &f, sizeof(f)) == sizeof(f)) {
+                received++;
+            }
+        }
+        if (received < burst) {
+            state.SkipWithError(burst_timeout);
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    close(tx);
+    close(rx);
+}
+
+/*
+  the whole burst in one sendmmsg() and as few recvmmsg() calls as
+  the kernel allows
+ */
+static void BM_SocketCAN_Batched(benchmark::State& state)
+{
+    const int tx = open_vcan();
+    const int rx = open_vcan();
+    if (tx < 0 || rx < 0) {
+        state.SkipWithError(vcan_missing);
+        return;
+    }
+    can_frame frames[burst];
+    can_frame rx_frames[burst];
+    iovec tx_iov[burst], rx_iov[burst];
+    mmsghdr tx_msgs[burst], rx_msgs[burst];
+    fill_frames(frames, burst);
+    for (unsigned i = 0; i < burst; i++) {
+        tx_iov[i] = { &frames[i], sizeof(can_frame) };
+        rx_iov[i] = { &rx_frames[i], sizeof(can_frame) };
+        tx_msgs[i] = mmsghdr {};
+        tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+        tx_msgs[i].msg_hdr.msg_iovlen = 1;
+        rx_msgs[i] = mmsghdr {};
+        rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+        rx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (state.KeepRunning()) {
+        if (sendmmsg(tx, tx_msgs, burst, 0) != int(burst)) {
+            state.SkipWithError("sendmmsg failed");
+            break;
+        }
+        const uint64_t deadline = AP_HAL::micros64() + burst_timeout_us;
+        unsigned received = 0;
+        while (received < burst && AP_HAL::micros64() < deadline) {
+            const int n = recvmmsg(rx, rx_msgs, burst - received, MSG_DONTWAIT, nullptr);
+            if (n > 0) {
+                received += n;
+            }
+        }
+        if (received < burst) {
+            state.SkipWithError(burst_timeout);
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    close(tx);
+    close(rx);
+}
+
+/*
+  the full interface: priority queue, socket batching, loopback
+  confirmation and the RX queue. CANIface only uses vcan0 when
+  HAL_LINUX_USE_VIRTUAL_CAN is set, as it is for native builds
+ */
+static void BM_CANIface_Throughput(benchmark::State& state)
+{
+#if !HAL_LINUX_USE_VIRTUAL_CAN
+    // the interface opens can0 on this board, don't run against hardware
+    state.SkipWithError("CANIface is not using vcan0 on this board");
+    return;
+#endif
+    Linux::CANIface tx(0);
+    Linux::CANIface rx(0);
+    if (!tx.init(1000000, AP_HAL::CANIface::NormalMode) ||
+        !rx.init(1000000, AP_HAL::CANIface::NormalMode)) {
+        state.SkipWithError(vcan_missing);
+        return;
+    }
+    AP_HAL::CANFrame frames[burst];
+    for (unsigned i = 0; i < burst; i++) {
+        const uint8_t data[8] {};
+        frames[i] = AP_HAL::CANFrame((0x1000 + i) | AP_HAL::CANFrame::FlagEFF, data, 8);
+    }
+
+    while (state.KeepRunning()) {
+        const uint64_t deadline = AP_HAL::micros64() + burst_timeout_us;
+        unsigned sent = 0;
+        unsigned received = 0;
+        while (received < burst && AP_HAL::micros64() < deadline) {
+            if (sent < burst && tx.send(frames[sent], deadline, 0) == 1) {
+                sent++;
+            }
+            AP_HAL::CANFrame frame;
+            uint64_t timestamp_us;
+            AP_HAL::CANIface::CanIOFlags flags;
+            // consume our own loopback frames so the TX side can continue
+            IGNORE_RETURN(tx.receive(frame, timestamp_us, flags));
+            if (rx.receive(frame, timestamp_us, flags) == 1) {
+                received++;
+            }
+        }
+        if (received < burst) {
+            state.SkipWithError(burst_timeout);
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+BENCHMARK(BM_SocketCAN_PerFrame);
+BENCHMARK(BM_SocketCAN_Batched);
+BENCHMARK(BM_CANIface_Throughput);
+
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,141 @@
+/*
+  spidev syscall cost for an IMU style poll. Needs a spidev node, by
+  default /dev/spidev0.0, overridden with the SPIDEV environment
+  variable. Nothing has to be attached to the bus: with MISO floating
+  the transfers still clock the same number of bytes.
+
+  Each iteration reads a FIFO count, a status register and a block of
+  FIFO data as three chip select framed transactions, the way an
+  Invensense driver does at 1kHz. The ioctls counter is the number of
+  syscalls per poll and bytes_per_second is the achieved FIFO read rate.
+ */
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const char *spidev_missing = "spidev not available, see the top of benchmark_spi.cpp";
+
+static const uint32_t speed_hz = 8000000;
+static const uint8_t mode = SPI_MODE_3;
+// 24 samples of 14 bytes, the most the driver reads per poll
+static const uint32_t fifo_len = 24 * 14;
+
+static int open_spidev(void)
+{
+    const char *path = getenv("SPIDEV");
+    if (path == nullptr) {
+        path = "/dev/spidev0.0";
+    }
+    return open(path, O_RDWR | O_CLOEXEC);
+}
+
+struct Poll {
+    uint8_t count_reg = 0x72 | 0x80;
+    uint8_t status_reg = 0x3A | 0x80;
+    uint8_t fifo_reg = 0x74 | 0x80;
+    uint8_t count[2];
+    uint8_t status[1];
+    uint8_t fifo[fifo_len];
+};
+
+static void fill(spi_ioc_transfer &msg, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    msg = { };
+    msg.tx_buf = (uint64_t) tx;
+    msg.rx_buf = (uint64_t) rx;
+    msg.len = len;
+    msg.speed_hz = speed_hz;
+    msg.bits_per_word = 8;
+}
+
+/*
+  one SPI_IOC_MESSAGE per transaction plus a SPI_IOC_WR_MODE before
+  each, as transfer_fullduplex() used to do
+ */
+static void BM_SPI_PerTransaction(benchmark::State& state)
+{
+    const int fd = open_spidev();
+    if (fd < 0) {
+        state.SkipWithError(spidev_missing);
+        return;
+    }
+    Poll p;
+    spi_ioc_transfer msgs[3][2];
+    fill(msgs[0][0], &p.count_reg, nullptr, 1);
+    fill(msgs[0][1], nullptr, p.count, sizeof(p.count));
+    fill(msgs[1][0], &p.status_reg, nullptr, 1);
+    fill(msgs[1][1], nullptr, p.status, sizeof(p.status));
+    fill(msgs[2][0], &p.fifo_reg, nullptr, 1);
+    fill(msgs[2][1], nullptr, p.fifo, sizeof(p.fifo));
+
+    uint64_t ioctls = 0;
+    while (state.KeepRunning()) {
+        for (auto &m : msgs) {
+            if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+                ioctl(fd, SPI_IOC_MESSAGE(2), m) < 0) {
+                state.SkipWithError("ioctl failed");
+                break;
+            }
+            ioctls += 2;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * fifo_len);
+    state.counters["ioctls"] = benchmark::Counter(ioctls, benchmark::Counter::kAvgIterations);
+    close(fd);
+}
+
+/*
+  the three transactions queued into one SPI_IOC_MESSAGE with
+  cs_change between them, as transfer_batch() does. The mode is set
+  once, as the per-subdev mode cache does
+ */
+static void BM_SPI_Batched(benchmark::State& state)
+{
+    const int fd = open_spidev();
+    if (fd < 0 || ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) {
+        state.SkipWithError(spidev_missing);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+    Poll p;
+    spi_ioc_transfer msgs[6];
+    fill(msgs[0], &p.count_reg, nullptr, 1);
+    fill(msgs[1], nullptr, p.count, sizeof(p.count));
+    msgs[1].cs_change = 1;
+    fill(msgs[2], &p.status_reg, nullptr, 1);
+    fill(msgs[3], nullptr, p.status, sizeof(p.status));
+    msgs[3].cs_change = 1;
+    fill(msgs[4], &p.fifo_reg, nullptr, 1);
+    fill(msgs[5], nullptr, p.fifo, sizeof(p.fifo));
+
+    uint64_t ioctls = 0;
+    while (state.KeepRunning()) {
+        if (ioctl(fd, SPI_IOC_MESSAGE(6), msgs) < 0) {
+            state.SkipWithError("ioctl failed");
+            break;
+        }
+        ioctls++;
+    }
+    state.SetBytesProcessed(state.iterations() * fifo_len);
+    state.counters["ioctls"] = benchmark::Counter(ioctls, benchmark::Counter::kAvgIterations);
+    close(fd);
+}
+
+BENCHMARK(BM_SPI_PerTransaction);
+BENCHMARK(BM_SPI_Batched);
+
+#endif
+
+BENCHMARK_MAIN();
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/select.h>
 #include <sys/socket.h>
@@ -173,7 +174,7 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
                 }
             }
 #endif
-            usleep(1000);
+            Scheduler::from(hal.scheduler)->wait_for_clock(wait_time_usec);
         }
     }
     // check the outbound TCP queue size.  If it is too long then
@@ -190,11 +191,48 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
             }
             _serial_0_outqueue_full_count++;
             uart->handle_reading_from_device_to_readbuffer();
+            // this stays a sleep: the queue drains as the GCS acknowledges
+            // data, and no simulated clock advance or socket event tells
+            // us it has dropped below the threshold
             usleep(1000);
         }
     }
 }
 
+/*
+  report the speedup this instance is actually achieving, which with
+  many instances on one machine is often well below the requested
+  --speedup. Only enabled with --speedup-report
+ */
+void SITL_State::report_speedup(void)
+{
+    const float target = sitl_model->get_speedup();
+    if (!_speedup_report || target <= 1) {
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t wall_us = ts.tv_sec*1000000ULL + ts.tv_nsec/1000U;
+    const uint64_t sim_us = _sitl->state.timestamp_us;
+    if (speedup_report.last_wall_us == 0) {
+        speedup_report.last_wall_us = wall_us;
+        speedup_report.last_sim_us = sim_us;
+        return;
+    }
+    const uint64_t dt_wall_us = wall_us - speedup_report.last_wall_us;
+    if (dt_wall_us < 30000000ULL) {
+        return;
+    }
+    ::printf("SITL%u: speedup %.1f/%.1f outqueue-stalls %u\n",
+             unsigned(_instance),
+             float(sim_us - speedup_report.last_sim_us) / dt_wall_us,
+             target,
+             unsigned(_serial_0_outqueue_full_count - speedup_report.last_outqueue_full_count));
+    speedup_report.last_wall_us = wall_us;
+    speedup_report.last_sim_us = sim_us;
+    speedup_report.last_outqueue_full_count = _serial_0_outqueue_full_count;
+}
+
 /*
   output current state to flightgear
  */
@@ -279,6 +317,8 @@ void SITL_State::_fdm_input_local(void)
     // update simulation time
     hal.scheduler->stop_clock(_sitl->state.timestamp_us);
 
+    report_speedup();
+
     set_height_agl();
 
     _update_count++;
@@ -75,6 +75,14 @@ private:
 
     void wait_clock(uint64_t wait_time_usec);
 
+    // periodically report simulated time achieved against wall clock time
+    void report_speedup(void);
+    struct {
+        uint64_t last_wall_us;
+        uint64_t last_sim_us;
+        uint32_t last_outqueue_full_count;
+    } speedup_report;
+
     // internal state
     uint8_t _instance;
     uint16_t _base_port;
@@ -89,6 +97,7 @@ private:
 
     bool _use_rtscts;
     bool _use_fg_view;
+    bool _speedup_report;   // print achieved speedup every 30s
     
     const char *_fg_address;
 
@@ -117,6 +117,7 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set MAV_SYSID\n"
            "\t--slave number           set the number of JSON slaves\n"
+           "\t--speedup-report         print the achieved speedup every 30 seconds\n"
         );
 }
 
@@ -241,6 +242,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     const char *model_str = nullptr;
     const char *vehicle_str = AP_BUILD_TARGET_NAME;
     _use_fg_view = false;
+    _speedup_report = false;
     char *autotest_dir = nullptr;
     _fg_address = "127.0.0.1";
     const char* config = "";
@@ -303,6 +305,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+        CMDLINE_SPEEDUP_REPORT,
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -363,6 +366,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+        {"speedup-report",  false,  0, CMDLINE_SPEEDUP_REPORT},
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -473,6 +477,9 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         case CMDLINE_FGVIEW:
             _use_fg_view = true;
             break;
+        case CMDLINE_SPEEDUP_REPORT:
+            _speedup_report = true;
+            break;
         case CMDLINE_AUTOTESTDIR:
             autotest_dir = strdup(gopt.optarg);
             break;
@@ -13,6 +13,8 @@
 #include <malloc.h>
 #endif
 #include <AP_RCProtocol/AP_RCProtocol.h>
+#include <errno.h>
+#include <time.h>
 #ifdef UBSAN_ENABLED
 #include <fcntl.h>
 #include <sanitizer/asan_interface.h>
@@ -300,13 +302,49 @@ void Scheduler::_run_io_procs()
  */
 void Scheduler::stop_clock(uint64_t time_usec)
 {
+    pthread_mutex_lock(&_clock_mutex);
     _stopped_clock_usec = time_usec;
+    if (_clock_waiters > 0) {
+        pthread_cond_broadcast(&_clock_cond);
+    }
+    pthread_mutex_unlock(&_clock_mutex);
     if (_sitlState->_sitl != nullptr && time_usec - _last_io_run > 10000) {
         _last_io_run = time_usec;
         _run_io_procs();
     }
 }
 
+/*
+  wait for the simulated clock to reach wait_time_usec. The wait is
+  bounded in wall-clock time so that a thread can never be stranded if
+  the clock stops being advanced (e.g. while the main thread is itself
+  blocked on a semaphore this thread holds)
+ */
+void Scheduler::wait_for_clock(uint64_t wait_time_usec)
+{
+    if (_stopped_clock_usec == 0) {
+        // clock is free running, nothing will wake us
+        usleep(1000);
+        return;
+    }
+    pthread_mutex_lock(&_clock_mutex);
+    _clock_waiters++;
+    while (_stopped_clock_usec < wait_time_usec && !_should_exit) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 1000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        if (pthread_cond_timedwait(&_clock_cond, &_clock_mutex, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    _clock_waiters--;
+    pthread_mutex_unlock(&_clock_mutex);
+}
+
 /*
   trampoline for thread create
 */
@@ -49,6 +49,13 @@ public:
 
     uint64_t stopped_clock_usec() const { return _stopped_clock_usec; }
 
+    /*
+      block the calling thread until the simulated clock reaches
+      wait_time_usec. Threads are woken by stop_clock() rather than
+      polling, so at high speedups they wake as soon as time advances
+     */
+    void wait_for_clock(uint64_t wait_time_usec);
+
     static void _run_io_procs();
     static bool _should_exit;
 
@@ -96,6 +103,11 @@ private:
     
     bool _initialized;
     uint64_t _stopped_clock_usec;
+
+    // wakeup of threads waiting in wait_for_clock()
+    pthread_mutex_t _clock_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _clock_cond = PTHREAD_COND_INITIALIZER;
+    uint32_t _clock_waiters;
     uint64_t _last_io_run;
     pthread_t _main_ctx;
 
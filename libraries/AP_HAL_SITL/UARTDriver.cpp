@@ -233,6 +233,20 @@ ssize_t UARTDriver::_read(uint8_t *buffer, uint16_t count)
     return ret;
 }
 
+uint32_t UARTDriver::_read_span(const uint8_t *&data)
+{
+    uint32_t n = 0;
+    data = _readbuffer.readptr(n);
+    return data != nullptr ? n : 0;
+}
+
+void UARTDriver::_read_span_advance(uint32_t n)
+{
+    if (_readbuffer.advance(n)) {
+        _rx_stats_bytes += n;
+    }
+}
+
 bool UARTDriver::_discard_input(void)
 {
     _readbuffer.clear();
@@ -143,6 +143,8 @@ protected:
     void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
     size_t _write(const uint8_t *buffer, size_t size) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override;
+    uint32_t _read_span(const uint8_t *&data) override;
+    void _read_span_advance(uint32_t n) override;
     uint32_t _available() override;
     void _end() override;
     void _flush() override;
@@ -85,6 +85,33 @@ template float safe_sqrt<short>(const short v);
 template float safe_sqrt<float>(const float v);
 template float safe_sqrt<double>(const double v);
 
+/*
+ * polynomial approximation of atan2f() for hot paths that can accept a
+ * maximum error of 2.5e-6 radians. Returns 0 if both arguments are zero
+ */
+float atan2f_fast(float y, float x)
+{
+    const float abs_x = fabsf(x);
+    const float abs_y = fabsf(y);
+    const float max_xy = MAX(abs_x, abs_y);
+    if (!is_positive(max_xy)) {
+        return 0;
+    }
+
+    // minimax polynomial for atan() over [0, 1], reflected into the
+    // other octants
+    const float a = MIN(abs_x, abs_y) / max_xy;
+    const float s = a * a;
+    float ret = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+    if (abs_y > abs_x) {
+        ret = M_PI_2 - ret;
+    }
+    if (x < 0) {
+        ret = M_PI - ret;
+    }
+    return (y < 0) ? -ret : ret;
+}
+
 /*
   replacement for std::swap() needed for STM32
  */
@@ -109,6 +109,12 @@ float safe_asin(const T v);
 template <typename T>
 float safe_sqrt(const T v);
 
+/*
+ * polynomial approximation of atan2f() for hot paths that can accept a
+ * maximum error of 2.5e-6 radians. Returns 0 if both arguments are zero
+ */
+float atan2f_fast(float y, float x);
+
 // matrix multiplication of two NxN matrices
 template <typename T>
 void mat_mul(const T *A, const T *B, T *C, uint16_t n);
@@ -52,6 +52,8 @@ void SCurve::init()
     time = 0.0f;
     num_segs = SEG_INIT;
     add_segment(num_segs, 0.0f, SegmentType::CONSTANT_JERK, 0.0f, 0.0f, 0.0f, 0.0f);
+    seg_cursor = SEG_INIT;
+    memset(&jerk_terms, 0, sizeof(jerk_terms));
     track.zero();
     delta_unit.zero();
     position_sq = 0.0f;
@@ -643,15 +645,9 @@ void SCurve::get_jerk_accel_vel_pos_at_time(float time_now, float &Jt_out, float
     }
 
     SegmentType Jtype;
-    uint8_t pnt = num_segs;
+    const uint8_t pnt = find_segment(time_now);
     float Jm, tj, T0, A0, V0, P0;
 
-    // find active segment at time_now
-    for (uint8_t i = 0; i < num_segs; i++) {
-        if (time_now < segment[num_segs - 1 - i].end_time) {
-            pnt = num_segs - 1 - i;
-        }
-    }
     if (pnt == 0) {
         Jtype = SegmentType::CONSTANT_JERK;
         Jm = 0.0f;
@@ -692,6 +688,45 @@ void SCurve::get_jerk_accel_vel_pos_at_time(float time_now, float &Jt_out, float
     Pt_out = MAX(0.0f, Pt_out);
 }
 
+// return the index of the segment active at time_now, this is the first
+// segment ending after time_now or num_segs if the path has finished.
+// Segment end times never decrease so the search walks from the segment
+// found by the previous lookup, usually zero or one step as time moves forward
+uint8_t SCurve::find_segment(float time_now) const
+{
+    uint8_t pnt = MIN(seg_cursor, num_segs);
+    while (pnt > 0 && time_now < segment[pnt - 1].end_time) {
+        pnt--;
+    }
+    while (pnt < num_segs && !(time_now < segment[pnt].end_time)) {
+        pnt++;
+    }
+    seg_cursor = pnt;
+    return pnt;
+}
+
+// return the jerk profile terms for a segment of duration tj and jerk Jm
+// the terms are only recalculated when the segment shape changes
+const SCurve::JerkTerms &SCurve::get_jerk_terms(float tj, float Jm) const
+{
+    const float key[2] {tj, Jm};
+    if (memcmp(key, &jerk_terms.tj, sizeof(key)) != 0) {
+        const float Alpha = Jm * 0.5f;
+        const float Beta = M_PI / tj;
+        jerk_terms.tj = tj;
+        jerk_terms.Jm = Jm;
+        jerk_terms.Alpha = Alpha;
+        jerk_terms.Beta = Beta;
+        jerk_terms.Alpha_Beta = Alpha / Beta;
+        jerk_terms.Alpha_Beta2 = Alpha / (Beta * Beta);
+        jerk_terms.Alpha_Beta3 = Alpha / (Beta * Beta * Beta);
+        jerk_terms.AT = Alpha * tj;
+        jerk_terms.VT = Alpha * ((tj * tj) * 0.5f - 2.0f / (Beta * Beta));
+        jerk_terms.PT = Alpha * ((-1.0f / (Beta * Beta)) * tj + (1.0f / 6.0f) * (tj * tj * tj));
+    }
+    return jerk_terms;
+}
+
 // calculate the jerk, acceleration, velocity and position at time time_now when running the constant jerk time segment
 void SCurve::calc_javp_for_segment_const_jerk(float time_now, float J0, float A0, float V0, float P0, float &Jt, float &At, float &Vt, float &Pt) const
 {
@@ -711,12 +746,13 @@ void SCurve::calc_javp_for_segment_incr_jerk(float time_now, float tj, float Jm,
         Pt = P0;
         return;
     }
-    const float Alpha = Jm * 0.5f;
-    const float Beta = M_PI / tj;
-    Jt = Alpha * (1.0f - cosf(Beta * time_now));
-    At = A0 + Alpha * time_now - (Alpha / Beta) * sinf(Beta * time_now);
-    Vt = V0 + A0 * time_now + (Alpha * 0.5f) * (time_now * time_now) + (Alpha / (Beta * Beta)) * cosf(Beta * time_now) - Alpha / (Beta * Beta);
-    Pt = P0 + V0 * time_now + 0.5f * A0 * (time_now * time_now) + (-Alpha / (Beta * Beta)) * time_now + Alpha * (time_now * time_now * time_now) / 6.0f + (Alpha / (Beta * Beta * Beta)) * sinf(Beta * time_now);
+    const JerkTerms &k = get_jerk_terms(tj, Jm);
+    const float sin_t = sinf(k.Beta * time_now);
+    const float cos_t = cosf(k.Beta * time_now);
+    Jt = k.Alpha * (1.0f - cos_t);
+    At = A0 + k.Alpha * time_now - k.Alpha_Beta * sin_t;
+    Vt = V0 + A0 * time_now + (k.Alpha * 0.5f) * (time_now * time_now) + k.Alpha_Beta2 * cos_t - k.Alpha_Beta2;
+    Pt = P0 + V0 * time_now + 0.5f * A0 * (time_now * time_now) + (-k.Alpha_Beta2) * time_now + k.Alpha * (time_now * time_now * time_now) / 6.0f + k.Alpha_Beta3 * sin_t;
 }
 
 // Calculate the jerk, acceleration, velocity and position at time time_now when running the decreasing jerk magnitude time segment based on a raised cosine profile
@@ -729,15 +765,14 @@ void SCurve::calc_javp_for_segment_decr_jerk(float time_now, float tj, float Jm,
         Pt = P0;
         return;
     }
-    const float Alpha = Jm * 0.5f;
-    const float Beta = M_PI / tj;
-    const float AT = Alpha * tj;
-    const float VT = Alpha * ((tj * tj) * 0.5f - 2.0f / (Beta * Beta));
-    const float PT = Alpha * ((-1.0f / (Beta * Beta)) * tj + (1.0f / 6.0f) * (tj * tj * tj));
-    Jt = Alpha * (1.0f - cosf(Beta * (time_now + tj)));
-    At = (A0 - AT) + Alpha * (time_now + tj) - (Alpha / Beta) * sinf(Beta * (time_now + tj));
-    Vt = (V0 - VT) + (A0 - AT) * time_now + 0.5f * Alpha * (time_now + tj) * (time_now + tj) + (Alpha / (Beta * Beta)) * cosf(Beta * (time_now + tj)) - Alpha / (Beta * Beta);
-    Pt = (P0 - PT) + (V0 - VT) * time_now + 0.5f * (A0 - AT) * (time_now * time_now) + (-Alpha / (Beta * Beta)) * (time_now + tj) + (Alpha / 6.0f) * (time_now + tj) * (time_now + tj) * (time_now + tj) + (Alpha / (Beta * Beta * Beta)) * sinf(Beta * (time_now + tj));
+    const JerkTerms &k = get_jerk_terms(tj, Jm);
+    const float t = time_now + tj;
+    const float sin_t = sinf(k.Beta * t);
+    const float cos_t = cosf(k.Beta * t);
+    Jt = k.Alpha * (1.0f - cos_t);
+    At = (A0 - k.AT) + k.Alpha * t - k.Alpha_Beta * sin_t;
+    Vt = (V0 - k.VT) + (A0 - k.AT) * time_now + 0.5f * k.Alpha * t * t + k.Alpha_Beta2 * cos_t - k.Alpha_Beta2;
+    Pt = (P0 - k.PT) + (V0 - k.VT) * time_now + 0.5f * (A0 - k.AT) * (time_now * time_now) + (-k.Alpha_Beta2) * t + (k.Alpha / 6.0f) * t * t * t + k.Alpha_Beta3 * sin_t;
 }
 
 // generate the segments for a path of length L
@@ -144,6 +144,28 @@ private:
     // calculate the jerk, acceleration, velocity and position at time t
     void get_jerk_accel_vel_pos_at_time(float time_now, float &Jt_out, float &At_out, float &Vt_out, float &Pt_out) const;
 
+    // return the index of the segment active at time t, num_segs if t is past the end of the path
+    uint8_t find_segment(float time_now) const;
+
+    // terms of the raised cosine jerk profile. These depend only on the
+    // segment duration and jerk so are reused while lookups stay on
+    // segments of the same shape
+    struct JerkTerms {
+        float tj;           // segment duration the terms were calculated for
+        float Jm;           // segment jerk the terms were calculated for
+        float Alpha;        // half the segment jerk
+        float Beta;         // pi / tj
+        float Alpha_Beta;   // Alpha / Beta
+        float Alpha_Beta2;  // Alpha / Beta^2
+        float Alpha_Beta3;  // Alpha / Beta^3
+        float AT;           // acceleration change over an increasing jerk segment
+        float VT;           // velocity change over an increasing jerk segment
+        float PT;           // position change over an increasing jerk segment
+    };
+
+    // return the jerk profile terms for a segment of duration tj and jerk Jm
+    const JerkTerms &get_jerk_terms(float tj, float Jm) const;
+
     // calculate the jerk, acceleration, velocity and position at time t when running the constant jerk time segment
     void calc_javp_for_segment_const_jerk(float time_now, float J0, float A0, float V0, float P0, float &Jt, float &At, float &Vt, float &Pt) const;
 
@@ -210,6 +232,8 @@ private:
     const static uint8_t segments_max = 23; // maximum number of time segments
 
     uint8_t num_segs;       // number of time segments being used
+    mutable uint8_t seg_cursor;         // segment found by the last lookup, the search for the next lookup starts here
+    mutable JerkTerms jerk_terms;       // jerk profile terms for the last jerk segment looked up
     struct {
         float jerk_ref;     // jerk reference value for time segment (the jerk at the beginning, middle or end depending upon the segment type)
         SegmentType seg_type;   // segment type (jerk is constant, increasing or decreasing)
@@ -0,0 +1,137 @@
+#include "batch.h"
+
+#include <string.h>
+
+#if AP_MATH_BATCH_SIMD_ENABLED
+// four floats, mapped to an SSE or NEON register by the compiler
+typedef float batch_f4 __attribute__((vector_size(16)));
+
+static_assert(sizeof(Quaternion) == sizeof(batch_f4), "Quaternion must be four packed floats");
+
+static inline batch_f4 splat(float v)
+{
+    return batch_f4{v, v, v, v};
+}
+
+static inline batch_f4 load4(const float *p)
+{
+    batch_f4 ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+static inline void store4(float *p, const batch_f4 &v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+#endif // AP_MATH_BATCH_SIMD_ENABLED
+
+// out[i] = m * in[i] for count vectors
+void matrix_mul_batch(const Matrix3f &m, const Vector3f *in, Vector3f *out, uint16_t count)
+{
+    uint16_t i = 0;
+
+#if AP_MATH_BATCH_SIMD_ENABLED
+    const batch_f4 ax = splat(m.a.x), ay = splat(m.a.y), az = splat(m.a.z);
+    const batch_f4 bx = splat(m.b.x), by = splat(m.b.y), bz = splat(m.b.z);
+    const batch_f4 cx = splat(m.c.x), cy = splat(m.c.y), cz = splat(m.c.z);
+
+    // transpose four vectors into x, y and z lanes
+    for (; i + 4 <= count; i += 4) {
+        const Vector3f *v = &in[i];
+        const batch_f4 x { v[0].x, v[1].x, v[2].x, v[3].x };
+        const batch_f4 y { v[0].y, v[1].y, v[2].y, v[3].y };
+        const batch_f4 z { v[0].z, v[1].z, v[2].z, v[3].z };
+        const batch_f4 rx = ax * x + ay * y + az * z;
+        const batch_f4 ry = bx * x + by * y + bz * z;
+        const batch_f4 rz = cx * x + cy * y + cz * z;
+        for (uint8_t k = 0; k < 4; k++) {
+            out[i+k] = Vector3f(rx[k], ry[k], rz[k]);
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = m * in[i];
+    }
+}
+
+// out[i] = m.transposed() * in[i] for count vectors
+void matrix_mul_transpose_batch(const Matrix3f &m, const Vector3f *in, Vector3f *out, uint16_t count)
+{
+    matrix_mul_batch(m.transposed(), in, out, count);
+}
+
+// struct of arrays form of matrix_mul_batch, each of the six arrays
+// holds count values
+void matrix_mul_batch(const Matrix3f &m, const float *x, const float *y, const float *z,
+                      float *out_x, float *out_y, float *out_z, uint16_t count)
+{
+    uint16_t i = 0;
+
+#if AP_MATH_BATCH_SIMD_ENABLED
+    const batch_f4 ax = splat(m.a.x), ay = splat(m.a.y), az = splat(m.a.z);
+    const batch_f4 bx = splat(m.b.x), by = splat(m.b.y), bz = splat(m.b.z);
+    const batch_f4 cx = splat(m.c.x), cy = splat(m.c.y), cz = splat(m.c.z);
+
+    for (; i + 4 <= count; i += 4) {
+        const batch_f4 vx = load4(&x[i]);
+        const batch_f4 vy = load4(&y[i]);
+        const batch_f4 vz = load4(&z[i]);
+        store4(&out_x[i], ax * vx + ay * vy + az * vz);
+        store4(&out_y[i], bx * vx + by * vy + bz * vz);
+        store4(&out_z[i], cx * vx + cy * vy + cz * vz);
+    }
+#endif
+
+    for (; i < count; i++) {
+        const Vector3f r = m * Vector3f(x[i], y[i], z[i]);
+        out_x[i] = r.x;
+        out_y[i] = r.y;
+        out_z[i] = r.z;
+    }
+}
+
+// rotate count vectors in place, equivalent to Vector3f::rotate()
+// to within float rounding
+void rotate_batch(enum Rotation rotation, Vector3f *v, uint16_t count)
+{
+    if (rotation == ROTATION_NONE) {
+        return;
+    }
+    Matrix3f m;
+    m.from_rotation(rotation);
+    matrix_mul_batch(m, v, v, count);
+}
+
+// out[i] = q * in[i] for count quaternions
+void quaternion_mul_batch(const Quaternion &q, const Quaternion *in, Quaternion *out, uint16_t count)
+{
+    uint16_t i = 0;
+
+#if AP_MATH_BATCH_SIMD_ENABLED
+    // left multiplication by q as a 4x4 matrix, one column per
+    // component of the right hand quaternion
+    const batch_f4 cw { q.q1,  q.q2,  q.q3,  q.q4 };
+    const batch_f4 cx {-q.q2,  q.q1,  q.q4, -q.q3 };
+    const batch_f4 cy {-q.q3, -q.q4,  q.q1,  q.q2 };
+    const batch_f4 cz {-q.q4,  q.q3, -q.q2,  q.q1 };
+
+    for (; i < count; i++) {
+        const batch_f4 p = load4(&in[i].q1);
+        store4(&out[i].q1, cw * splat(p[0]) + cx * splat(p[1]) + cy * splat(p[2]) + cz * splat(p[3]));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = q * in[i];
+    }
+}
+
+// rotate count vectors by q, equivalent to Quaternion::earth_to_body()
+void quaternion_rotate_batch(const Quaternion &q, const Vector3f *in, Vector3f *out, uint16_t count)
+{
+    Matrix3f m;
+    q.rotation_matrix(m);
+    matrix_mul_batch(m, in, out, count);
+}
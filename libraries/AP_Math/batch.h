@@ -0,0 +1,41 @@
+#pragma once
+
+/*
+  batch versions of the vector, matrix and quaternion operations for
+  code that applies the same rotation to many values.
+
+  On SITL and Linux boards with SSE2 or NEON four values are processed
+  per step using the compiler's vector extensions, everywhere else the
+  same functions are plain loops. In all functions out may be the same
+  array as in.
+ */
+
+#include "AP_Math.h"
+
+#ifndef AP_MATH_BATCH_SIMD_ENABLED
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define AP_MATH_BATCH_SIMD_ENABLED 1
+#else
+#define AP_MATH_BATCH_SIMD_ENABLED 0
+#endif
+#endif
+
+// out[i] = m * in[i] for count vectors
+void matrix_mul_batch(const Matrix3f &m, const Vector3f *in, Vector3f *out, uint16_t count);
+
+// out[i] = m.transposed() * in[i] for count vectors
+void matrix_mul_transpose_batch(const Matrix3f &m, const Vector3f *in, Vector3f *out, uint16_t count);
+
+// struct of arrays form of matrix_mul_batch, each of the six arrays
+// holds count values
+void matrix_mul_batch(const Matrix3f &m, const float *x, const float *y, const float *z,
+                      float *out_x, float *out_y, float *out_z, uint16_t count);
+
+// rotate count vectors in place, equivalent to Vector3f::rotate()
+void rotate_batch(enum Rotation rotation, Vector3f *v, uint16_t count);
+
+// out[i] = q * in[i] for count quaternions
+void quaternion_mul_batch(const Quaternion &q, const Quaternion *in, Quaternion *out, uint16_t count);
+
+// rotate count vectors by q, equivalent to Quaternion::earth_to_body()
+void quaternion_rotate_batch(const Quaternion &q, const Vector3f *in, Vector3f *out, uint16_t count);
@@ -0,0 +1,140 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// state.range(0) vectors rotated by one matrix, per vector and in a batch
+
+static void fill_vectors(Vector3f *v, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        v[i] = Vector3f(i * 0.5f, 1.0f - i * 0.25f, i * 0.125f);
+    }
+}
+
+static void BM_MatrixMulLoop(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Matrix3f m;
+    m.from_euler(0.1f, -0.4f, 1.2f);
+    Vector3f *v = new Vector3f[count];
+    fill_vectors(v, count);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            v[i] = m * v[i];
+        }
+        gbenchmark_escape(v);
+    }
+    delete[] v;
+}
+
+static void BM_MatrixMulBatch(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Matrix3f m;
+    m.from_euler(0.1f, -0.4f, 1.2f);
+    Vector3f *v = new Vector3f[count];
+    fill_vectors(v, count);
+
+    while (state.KeepRunning()) {
+        matrix_mul_batch(m, v, v, count);
+        gbenchmark_escape(v);
+    }
+    delete[] v;
+}
+
+static void BM_MatrixMulBatchSoA(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Matrix3f m;
+    m.from_euler(0.1f, -0.4f, 1.2f);
+    float *x = new float[count];
+    float *y = new float[count];
+    float *z = new float[count];
+    for (uint16_t i = 0; i < count; i++) {
+        x[i] = i * 0.5f;
+        y[i] = 1.0f - i * 0.25f;
+        z[i] = i * 0.125f;
+    }
+
+    while (state.KeepRunning()) {
+        matrix_mul_batch(m, x, y, z, x, y, z, count);
+        gbenchmark_escape(x);
+        gbenchmark_escape(y);
+        gbenchmark_escape(z);
+    }
+    delete[] x;
+    delete[] y;
+    delete[] z;
+}
+
+static void BM_RotateLoop(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Vector3f *v = new Vector3f[count];
+    fill_vectors(v, count);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            v[i].rotate(ROTATION_YAW_45);
+        }
+        gbenchmark_escape(v);
+    }
+    delete[] v;
+}
+
+static void BM_RotateBatch(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Vector3f *v = new Vector3f[count];
+    fill_vectors(v, count);
+
+    while (state.KeepRunning()) {
+        rotate_batch(ROTATION_YAW_45, v, count);
+        gbenchmark_escape(v);
+    }
+    delete[] v;
+}
+
+static void BM_QuaternionMulLoop(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Quaternion q;
+    q.from_euler(0.1f, -0.4f, 1.2f);
+    Quaternion *p = new Quaternion[count];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < count; i++) {
+            p[i] = q * p[i];
+        }
+        gbenchmark_escape(p);
+    }
+    delete[] p;
+}
+
+static void BM_QuaternionMulBatch(benchmark::State& state)
+{
+    const uint16_t count = state.range(0);
+    Quaternion q;
+    q.from_euler(0.1f, -0.4f, 1.2f);
+    Quaternion *p = new Quaternion[count];
+
+    while (state.KeepRunning()) {
+        quaternion_mul_batch(q, p, p, count);
+        gbenchmark_escape(p);
+    }
+    delete[] p;
+}
+
+BENCHMARK(BM_MatrixMulLoop)->Arg(16)->Arg(256);
+BENCHMARK(BM_MatrixMulBatch)->Arg(16)->Arg(256);
+BENCHMARK(BM_MatrixMulBatchSoA)->Arg(16)->Arg(256);
+BENCHMARK(BM_RotateLoop)->Arg(16)->Arg(256);
+BENCHMARK(BM_RotateBatch)->Arg(16)->Arg(256);
+BENCHMARK(BM_QuaternionMulLoop)->Arg(16)->Arg(256);
+BENCHMARK(BM_QuaternionMulBatch)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
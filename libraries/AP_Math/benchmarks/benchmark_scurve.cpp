@@ -0,0 +1,48 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/SCurve.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// fly a mission of state.range(0) legs the way AC_WPNav does, advancing
+// the current leg while blending with the previous and next legs at a
+// 400Hz loop rate
+static void BM_SCurveMission(benchmark::State& state)
+{
+    const uint16_t num_legs = state.range(0);
+
+    // zig-zag waypoints with a climb every second leg, in cm
+    Vector3f *wp = new Vector3f[num_legs + 1];
+    for (uint16_t i = 1; i <= num_legs; i++) {
+        wp[i] = wp[i-1] + Vector3f(5000.0f, (i % 2) ? 3000.0f : -3000.0f, (i % 2) ? -500.0f : 0.0f);
+    }
+
+    while (state.KeepRunning()) {
+        SCurve prev_leg, this_leg, next_leg;
+        this_leg.calculate_track(wp[0], wp[1], 1000.0f, 250.0f, 150.0f, 250.0f, 100.0f, 1000.0f, 500.0f);
+        for (uint16_t i = 0; i < num_legs; i++) {
+            const bool fast_waypoint = i + 2 <= num_legs;
+            if (fast_waypoint) {
+                next_leg.calculate_track(wp[i+1], wp[i+2], 1000.0f, 250.0f, 150.0f, 250.0f, 100.0f, 1000.0f, 500.0f);
+            } else {
+                next_leg.init();
+            }
+            bool reached = false;
+            while (!reached && !this_leg.finished()) {
+                Vector3f target_pos = wp[i];
+                Vector3f target_vel, target_accel;
+                reached = this_leg.advance_target_along_track(prev_leg, next_leg, 200.0f, 500.0f, fast_waypoint, 0.0025f, target_pos, target_vel, target_accel);
+                gbenchmark_escape(&target_pos);
+            }
+            prev_leg = this_leg;
+            this_leg = next_leg;
+        }
+    }
+
+    delete[] wp;
+}
+
+BENCHMARK(BM_SCurveMission)->Arg(10)->Arg(50);
+
+BENCHMARK_MAIN();
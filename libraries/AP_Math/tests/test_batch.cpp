@@ -0,0 +1,126 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/batch.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define BATCH_TEST_COUNT 23     // not a multiple of four so the scalar tail is covered
+
+static void fill_vectors(Vector3f *v, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        v[i] = Vector3f(i * 1.5f - 7.0f, 3.0f - i * 0.25f, i * i * 0.125f - 10.0f);
+    }
+}
+
+// batch matrix products match the per vector operators
+TEST(BatchTest, MatrixMul)
+{
+    Matrix3f m;
+    m.from_euler(radians(10), radians(-35), radians(120));
+
+    Vector3f in[BATCH_TEST_COUNT];
+    Vector3f out[BATCH_TEST_COUNT];
+    Vector3f out_t[BATCH_TEST_COUNT];
+    fill_vectors(in, BATCH_TEST_COUNT);
+
+    matrix_mul_batch(m, in, out, BATCH_TEST_COUNT);
+    matrix_mul_transpose_batch(m, in, out_t, BATCH_TEST_COUNT);
+
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        const Vector3f expected = m * in[i];
+        const Vector3f expected_t = m.mul_transpose(in[i]);
+        for (uint8_t k = 0; k < 3; k++) {
+            EXPECT_NEAR(expected[k], out[i][k], 1.0e-5);
+            EXPECT_NEAR(expected_t[k], out_t[i][k], 1.0e-5);
+        }
+    }
+
+    // in place
+    matrix_mul_batch(m, in, in, BATCH_TEST_COUNT);
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        for (uint8_t k = 0; k < 3; k++) {
+            EXPECT_NEAR(out[i][k], in[i][k], 1.0e-5);
+        }
+    }
+}
+
+// struct of arrays form matches the array of structs form
+TEST(BatchTest, MatrixMulSoA)
+{
+    Matrix3f m;
+    m.from_euler(radians(-60), radians(5), radians(-170));
+
+    Vector3f in[BATCH_TEST_COUNT];
+    fill_vectors(in, BATCH_TEST_COUNT);
+
+    float x[BATCH_TEST_COUNT], y[BATCH_TEST_COUNT], z[BATCH_TEST_COUNT];
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        x[i] = in[i].x;
+        y[i] = in[i].y;
+        z[i] = in[i].z;
+    }
+    matrix_mul_batch(m, x, y, z, x, y, z, BATCH_TEST_COUNT);
+
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        const Vector3f expected = m * in[i];
+        EXPECT_NEAR(expected.x, x[i], 1.0e-5);
+        EXPECT_NEAR(expected.y, y[i], 1.0e-5);
+        EXPECT_NEAR(expected.z, z[i], 1.0e-5);
+    }
+}
+
+// every board rotation matches Vector3f::rotate()
+TEST(BatchTest, Rotate)
+{
+    for (uint16_t r = 0; r < ROTATION_MAX; r++) {
+        const enum Rotation rotation = (enum Rotation)r;
+        Vector3f v[BATCH_TEST_COUNT];
+        fill_vectors(v, BATCH_TEST_COUNT);
+        rotate_batch(rotation, v, BATCH_TEST_COUNT);
+
+        Vector3f expected[BATCH_TEST_COUNT];
+        fill_vectors(expected, BATCH_TEST_COUNT);
+        for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+            expected[i].rotate(rotation);
+            for (uint8_t k = 0; k < 3; k++) {
+                EXPECT_NEAR(expected[i][k], v[i][k], 1.0e-4) << "rotation " << r;
+            }
+        }
+    }
+}
+
+// batch quaternion operations match the per quaternion operators
+TEST(BatchTest, Quaternion)
+{
+    Quaternion q;
+    q.from_euler(radians(20), radians(-40), radians(75));
+
+    Quaternion in[BATCH_TEST_COUNT];
+    Quaternion out[BATCH_TEST_COUNT];
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        in[i].from_euler(radians(i * 7), radians(i * -3), radians(i * 15));
+    }
+    quaternion_mul_batch(q, in, out, BATCH_TEST_COUNT);
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        const Quaternion expected = q * in[i];
+        for (uint8_t k = 0; k < 4; k++) {
+            EXPECT_NEAR(expected[k], out[i][k], 1.0e-6);
+        }
+    }
+
+    Vector3f v[BATCH_TEST_COUNT];
+    Vector3f v_out[BATCH_TEST_COUNT];
+    fill_vectors(v, BATCH_TEST_COUNT);
+    quaternion_rotate_batch(q, v, v_out, BATCH_TEST_COUNT);
+    for (uint16_t i = 0; i < BATCH_TEST_COUNT; i++) {
+        Vector3f expected = v[i];
+        q.earth_to_body(expected);
+        for (uint8_t k = 0; k < 3; k++) {
+            EXPECT_NEAR(expected[k], v_out[i][k], 1.0e-5);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -21,6 +21,7 @@ class AP_Networking_Backend;
 class AP_Networking_ChibiOS;
 
 class SocketAPM;
+class ExpandingString;
 
 class AP_Networking
 {
@@ -152,6 +153,11 @@ public:
      */
     bool sendfile(SocketAPM *sock, int fd);
 
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    // network port throughput and latency, for @SYS/net_ports.txt
+    void ports_info(ExpandingString &str);
+#endif
+
     static const struct AP_Param::GroupInfo var_info[];
 
     enum class OPTION {
@@ -251,16 +257,26 @@ private:
         void tcp_server_init(void);
         void tcp_client_init(void);
 
-        void udp_client_loop(void);
-        void udp_server_loop(void);
-        void tcp_client_loop(void);
-        void tcp_server_loop(void);
+        // the following are called from the ports thread
 
-        bool send_receive(void);
+        // connect or bind once the network is up
+        void start(void);
+
+        // the socket to wait on and what to wait for, or nullptr
+        SocketAPM *poll_socket(bool &want_read, bool &want_write);
+
+        // handle a wakeup, returns true if any data moved
+        bool service(bool readable, bool writable);
+
+        void port_info(ExpandingString &str, uint32_t now_ms);
 
-    private:
         bool init_buffers(const uint32_t size_rx, const uint32_t size_tx);
-        void thread_create(AP_HAL::MemberProc);
+
+    private:
+        bool send_receive(bool readable);
+        uint32_t tx_sendable(uint32_t max_bytes) const;
+        void tcp_client_connect(bool writable);
+        void close_connection(const char *reason);
 
         uint32_t txspace() override;
         void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
@@ -279,7 +295,6 @@ private:
 
         ByteBuffer *readbuffer;
         ByteBuffer *writebuffer;
-        char thread_name[10];
         uint32_t last_size_tx;
         uint32_t last_size_rx;
         bool packetise;
@@ -289,10 +304,33 @@ private:
         bool have_received;
         bool close_on_recv_error;
         uint32_t last_udp_srv_recv_time_ms;
+        bool connecting;
+        uint32_t last_connect_ms;
 
         // statistics
         uint32_t tx_stats_bytes;
         uint32_t rx_stats_bytes;
+        uint32_t tx_stats_packets;
+        uint32_t rx_stats_packets;
+
+        // time from data being queued in an empty writebuffer to the
+        // writebuffer being drained to the socket
+        uint32_t tx_queued_us;
+        uint32_t tx_latency_avg_us;
+        uint32_t tx_latency_max_us;
+
+        // time from received data landing in an empty readbuffer to
+        // the readbuffer being drained by the reader
+        uint32_t rx_queued_us;
+        uint32_t rx_latency_avg_us;
+        uint32_t rx_latency_max_us;
+
+        // for rates in port_info()
+        struct {
+            uint32_t time_ms;
+            uint32_t tx_bytes;
+            uint32_t rx_bytes;
+        } last_report;
 
         HAL_Semaphore sem;
 
@@ -346,6 +384,12 @@ private:
     bool sendfile_thread_started;
 
     void ports_init(void);
+
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    // single thread serving all network ports
+    void ports_loop(void);
+    uint32_t ports_wakeups;
+#endif
 };
 
 namespace AP
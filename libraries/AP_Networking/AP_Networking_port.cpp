@@ -13,6 +13,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_HAL/utility/packetise.h>
+#include <AP_Common/ExpandingString.h>
 #include <errno.h>
 
 extern const AP_HAL::HAL& hal;
@@ -25,8 +26,26 @@ extern const AP_HAL::HAL& hal;
 #define AP_NETWORKING_PORT_MIN_RXSIZE 2048
 #endif
 
+// stack of the thread serving all ports
 #ifndef AP_NETWORKING_PORT_STACK_SIZE
-#define AP_NETWORKING_PORT_STACK_SIZE 1024
+#define AP_NETWORKING_PORT_STACK_SIZE 2048
+#endif
+
+// longest the ports thread sleeps when idle, in microseconds
+#ifndef AP_NETWORKING_PORT_POLL_US
+#define AP_NETWORKING_PORT_POLL_US 1000
+#endif
+
+// bytes moved per send or receive call, and calls per wakeup
+#ifndef AP_NETWORKING_PORT_IO_SIZE
+#define AP_NETWORKING_PORT_IO_SIZE 300
+#endif
+#ifndef AP_NETWORKING_PORT_IO_BATCH
+#define AP_NETWORKING_PORT_IO_BATCH 8
+#endif
+
+#ifndef AP_NETWORKING_PORT_CONNECT_TIMEOUT_MS
+#define AP_NETWORKING_PORT_CONNECT_TIMEOUT_MS 5000
 #endif
 
 const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
@@ -67,6 +86,7 @@ const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
  */
 void AP_Networking::ports_init(void)
 {
+    bool have_ports = false;
     for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
         auto &p = ports[i];
         NetworkPortType ptype = (NetworkPortType)p.type;
@@ -87,27 +107,61 @@ void AP_Networking::ports_init(void)
             p.tcp_client_init();
             break;
         }
-        if (p.sock != nullptr || p.listen_sock != nullptr) {
-            AP::serialmanager().register_port(&p);
+        if (p.sock == nullptr && p.listen_sock == nullptr) {
+            continue;
+        }
+        if (!p.init_buffers(AP_NETWORKING_PORT_MIN_RXSIZE, AP_NETWORKING_PORT_MIN_TXSIZE)) {
+            AP_BoardConfig::allocation_error("Failed to allocate NET_P%u buffers", unsigned(i));
         }
+        AP::serialmanager().register_port(&p);
+        have_ports = true;
+    }
+
+    /*
+      all ports are served by one thread waiting on the sockets
+      together, rather than a thread per port polling its own socket
+     */
+    if (have_ports &&
+        !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::ports_loop, void),
+                                      "NET_PORTS", AP_NETWORKING_PORT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+        AP_BoardConfig::allocation_error("Failed to allocate NET_PORTS thread");
     }
 }
 
 /*
-  wrapper for thread_create for port functions
+  the network ports thread
  */
-void AP_Networking::Port::thread_create(AP_HAL::MemberProc proc)
+void AP_Networking::ports_loop(void)
 {
-    const uint8_t idx = state.idx - AP_SERIALMANAGER_NET_PORT_1;
-    hal.util->snprintf(thread_name, sizeof(thread_name), "NET_P%u", unsigned(idx));
+    startup_wait();
 
-    if (!init_buffers(AP_NETWORKING_PORT_MIN_RXSIZE, AP_NETWORKING_PORT_MIN_TXSIZE)) {
-        AP_BoardConfig::allocation_error("Failed to allocate %s buffers", thread_name);
-        return;
+    for (auto &p : ports) {
+        p.start();
     }
 
-    if (!hal.scheduler->thread_create(proc, thread_name, AP_NETWORKING_PORT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
-        AP_BoardConfig::allocation_error("Failed to allocate %s client thread", thread_name);
+    SocketAPM::PollEntry entries[AP_NETWORKING_NUM_PORTS] {};
+    bool active = false;
+    while (true) {
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            auto &e = entries[i];
+            e.sock = ports[i].poll_socket(e.want_read, e.want_write);
+        }
+
+        /*
+          sleep until a socket is ready. Data written by the vehicle
+          code does not wake us, so the timeout bounds the added
+          latency for a port which was idle
+         */
+        IGNORE_RETURN(SocketAPM::poll(entries, ARRAY_SIZE(entries), active ? 0 : AP_NETWORKING_PORT_POLL_US));
+        ports_wakeups++;
+
+        active = false;
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            const auto &e = entries[i];
+            if (ports[i].service(e.readable, e.writable)) {
+                active = true;
+            }
+        }
     }
 }
 
@@ -125,8 +179,6 @@ void AP_Networking::Port::udp_client_init(void)
     // setup for packet boundaries if this is mavlink
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
-
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_client_loop, void));
 }
 
 /*
@@ -143,8 +195,6 @@ void AP_Networking::Port::udp_server_init(void)
     // setup for packet boundaries if this is mavlink
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
-
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_server_loop, void));
 }
 
 /*
@@ -157,8 +207,6 @@ void AP_Networking::Port::tcp_server_init(void)
         return;
     }
     listen_sock->reuseaddress();
-
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_server_loop, void));
 }
 
 /*
@@ -167,188 +215,266 @@ void AP_Networking::Port::tcp_server_init(void)
 void AP_Networking::Port::tcp_client_init(void)
 {
     sock = NEW_NOTHROW SocketAPM(false);
-    if (sock != nullptr) {
-        sock->set_blocking(true);
-        thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_client_loop, void));
-    }
 }
 
 /*
-  update a UDP client
+  connect or bind the port once the network is up
  */
-void AP_Networking::Port::udp_client_loop(void)
+void AP_Networking::Port::start(void)
 {
-    AP::network().startup_wait();
+    const NetworkPortType ptype = (NetworkPortType)type;
+    switch (ptype) {
+    case NetworkPortType::NONE:
+        break;
 
-    const char *dest = ip.get_str();
-    if (!sock->connect(dest, port.get())) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to connect to %s", (unsigned)state.idx, dest);
-        delete sock;
-        sock = nullptr;
-        return;
+    case NetworkPortType::UDP_CLIENT: {
+        if (sock == nullptr) {
+            break;
+        }
+        const char *dest = ip.get_str();
+        if (!sock->connect(dest, port.get())) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to connect to %s", (unsigned)state.idx, dest);
+            delete sock;
+            sock = nullptr;
+            break;
+        }
+        // connect() may have added a multicast or broadcast receive socket
+        sock->set_blocking(false);
+
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: connected to %s:%u", (unsigned)state.idx, dest, unsigned(port.get()));
+
+        connected = true;
+        break;
     }
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: connected to %s:%u", (unsigned)state.idx, dest, unsigned(port.get()));
+    case NetworkPortType::UDP_SERVER: {
+        if (sock == nullptr) {
+            break;
+        }
+        const char *addr = ip.get_str();
+        if (!sock->bind(addr, port.get())) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+            delete sock;
+            sock = nullptr;
+            break;
+        }
+        sock->reuseaddress();
 
-    connected = true;
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+        break;
+    }
 
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+    case NetworkPortType::TCP_SERVER: {
+        if (listen_sock == nullptr) {
+            break;
+        }
+        const char *addr = ip.get_str();
+        if (!listen_sock->bind(addr, port.get()) || !listen_sock->listen(1)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "TCP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+            delete listen_sock;
+            listen_sock = nullptr;
+            break;
         }
-        active = send_receive();
+
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+
+        close_on_recv_error = true;
+        break;
+    }
+
+    case NetworkPortType::TCP_CLIENT:
+        close_on_recv_error = true;
+        break;
     }
 }
 
 /*
-  update a UDP server
+  get the socket to wait on and what to wait for
  */
-void AP_Networking::Port::udp_server_loop(void)
+SocketAPM *AP_Networking::Port::poll_socket(bool &want_read, bool &want_write)
 {
-    AP::network().startup_wait();
+    want_read = false;
+    want_write = false;
 
-    const char *addr = ip.get_str();
-    if (!sock->bind(addr, port.get())) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete sock;
-        sock = nullptr;
-        return;
+    const NetworkPortType ptype = (NetworkPortType)type;
+    if (ptype == NetworkPortType::TCP_SERVER && sock == nullptr) {
+        // readable when a connection is waiting to be accepted
+        want_read = listen_sock != nullptr;
+        return listen_sock;
+    }
+    if (ptype == NetworkPortType::TCP_CLIENT && !connected) {
+        // writable once a connect in progress completes
+        want_write = connecting;
+        return sock;
+    }
+    if (sock == nullptr) {
+        return nullptr;
     }
-    sock->reuseaddress();
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+    WITH_SEMAPHORE(sem);
+    want_read = readbuffer != nullptr && readbuffer->space() > 0;
+    // a partial packet on a packetised port can't be sent yet, so
+    // waiting for the socket to be writable would return at once
+    want_write = connected && writebuffer != nullptr && tx_sendable(AP_NETWORKING_PORT_IO_SIZE) > 0;
+    return sock;
+}
 
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
-        }
-        active = send_receive();
+/*
+  bytes that can go out in the next send, holding back a partial
+  MAVLink packet on packetised ports. Called with sem held
+ */
+uint32_t AP_Networking::Port::tx_sendable(uint32_t max_bytes) const
+{
+    uint32_t available = MIN(writebuffer->available(), max_bytes);
+#if AP_MAVLINK_PACKETISE_ENABLED
+    if (packetise) {
+        available = mavlink_packetise(*writebuffer, available);
     }
+#endif
+    return available;
 }
 
 /*
-  update a TCP server
+  handle a wakeup of the ports thread
  */
-void AP_Networking::Port::tcp_server_loop(void)
+bool AP_Networking::Port::service(bool readable, bool writable)
 {
-    AP::network().startup_wait();
-
-    const char *addr = ip.get_str();
-    if (!listen_sock->bind(addr, port.get()) || !listen_sock->listen(1)) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "TCP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete listen_sock;
-        listen_sock = nullptr;
-        return;
+    if (readbuffer == nullptr || writebuffer == nullptr) {
+        return false;
     }
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-
-    close_on_recv_error = true;
-
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
-        }
-        if (sock == nullptr) {
-            sock = listen_sock->accept(100);
-            if (sock != nullptr) {
-                sock->set_blocking(false);
-                char buf[IP4_STR_LEN];
-                uint16_t last_port;
-                const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
-                if (last_addr != nullptr) {
-                    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
-                }
-                connected = true;
-                sock->reuseaddress();
-            }
+    const NetworkPortType ptype = (NetworkPortType)type;
+    if (ptype == NetworkPortType::TCP_SERVER && sock == nullptr) {
+        if (listen_sock == nullptr || !readable) {
+            return false;
         }
+        sock = listen_sock->accept(0);
         if (sock != nullptr) {
-            active = send_receive();
+            sock->set_blocking(false);
+            char buf[IP4_STR_LEN];
+            uint16_t last_port;
+            const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
+            if (last_addr != nullptr) {
+                GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
+            }
+            connected = true;
+            sock->reuseaddress();
         }
+        return false;
     }
+    if (ptype == NetworkPortType::TCP_CLIENT && !connected) {
+        tcp_client_connect(writable);
+        return false;
+    }
+    if (sock == nullptr) {
+        return false;
+    }
+    return send_receive(readable);
 }
 
 /*
-  update a TCP client
+  work through a non-blocking connect of a TCP client
  */
-void AP_Networking::Port::tcp_client_loop(void)
+void AP_Networking::Port::tcp_client_connect(bool writable)
 {
-    AP::network().startup_wait();
-
-    close_on_recv_error = true;
-
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+    const uint32_t now_ms = AP_HAL::millis();
+    if (sock == nullptr) {
+        // don't try and connect too fast
+        if (now_ms - last_connect_ms < 100) {
+            return;
         }
+        sock = NEW_NOTHROW SocketAPM(false);
         if (sock == nullptr) {
-            sock = NEW_NOTHROW SocketAPM(false);
-            if (sock == nullptr) {
-                continue;
-            }
-            sock->set_blocking(true);
-            connected = false;
+            return;
         }
-        if (!connected) {
-            const char *dest = ip.get_str();
-            connected = sock->connect(dest, port.get());
-            if (connected) {
-                GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
-                sock->set_blocking(false);
-            } else {
-                delete sock;
-                sock = nullptr;
-                // don't try and connect too fast
-                hal.scheduler->delay(100);
-            }
+    }
+
+    const char *dest = ip.get_str();
+    if (!connecting) {
+        last_connect_ms = now_ms;
+        if (!sock->connect_start(dest, port.get())) {
+            delete sock;
+            sock = nullptr;
+            return;
         }
-        if (sock != nullptr && connected) {
-            active = send_receive();
+        connecting = true;
+        if (!sock->is_connected()) {
+            return;
         }
     }
+
+    if (sock->is_connected() || (writable && sock->connect_check())) {
+        connecting = false;
+        connected = true;
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
+        return;
+    }
+
+    if (writable || now_ms - last_connect_ms > AP_NETWORKING_PORT_CONNECT_TIMEOUT_MS) {
+        // refused or timed out, start again with a new socket
+        connecting = false;
+        delete sock;
+        sock = nullptr;
+    }
 }
 
 /*
-  run one send/receive loop
+  close a TCP connection so we can reconnect, or accept another client
  */
-bool AP_Networking::Port::send_receive(void)
+void AP_Networking::Port::close_connection(const char *reason)
 {
+    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: %s", unsigned(state.idx), reason);
+    sock->close();
+    delete sock;
+    sock = nullptr;
+    connected = false;
+}
 
+/*
+  move data between the socket and the port buffers. After a wakeup
+  we keep going until the socket or the buffers run dry, up to
+  AP_NETWORKING_PORT_IO_BATCH packets each way
+ */
+bool AP_Networking::Port::send_receive(bool readable)
+{
     bool active = false;
-    uint32_t space;
-
+    uint8_t buf[AP_NETWORKING_PORT_IO_SIZE];
 
     // handle incoming packets
-    {
-        WITH_SEMAPHORE(sem);
-        space = readbuffer->space();
-    }
-    if (space > 0) {
-        const uint32_t n = MIN(300U, space);
-        uint8_t buf[n];
+    for (uint8_t i=0; readable && i<AP_NETWORKING_PORT_IO_BATCH; i++) {
+        uint32_t space;
+        {
+            WITH_SEMAPHORE(sem);
+            space = readbuffer->space();
+        }
+        if (space == 0) {
+            break;
+        }
+        const uint32_t n = MIN(sizeof(buf), space);
         const auto ret = sock->recv(buf, n, 0);
         if (close_on_recv_error && ret == 0) {
-            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: closed connection", unsigned(state.idx));
-            delete sock;
-            sock = nullptr;
+            close_connection("closed connection");
             return false;
         }
-        if (ret > 0) {
+        if (ret <= 0) {
+            break;
+        }
+        {
             WITH_SEMAPHORE(sem);
+            if (readbuffer->available() == 0) {
+                // start of the latency measurement
+                rx_queued_us = AP_HAL::micros();
+            }
             readbuffer->write(buf, ret);
 
             // Cant track dropped read packets because we only read in what there is space for
             // The socket buffer becomes full and data is lost there
             rx_stats_bytes += ret;
-
-            active = true;
-            have_received = true;
+            rx_stats_packets++;
         }
+
+        active = true;
+        have_received = true;
     }
 
     if (type == NetworkPortType::UDP_SERVER && have_received) {
@@ -375,33 +501,20 @@ bool AP_Networking::Port::send_receive(void)
         }
     }
 
-    if (connected) {
-        // handle outgoing packets
-        uint32_t available;
-
+    // handle outgoing packets
+    for (uint8_t i=0; connected && i<AP_NETWORKING_PORT_IO_BATCH; i++) {
+        uint32_t n;
         {
             WITH_SEMAPHORE(sem);
-            available = writebuffer->available();
-            available = MIN(300U, available);
-#if AP_MAVLINK_PACKETISE_ENABLED
-            if (packetise) {
-                available = mavlink_packetise(*writebuffer, available);
-            }
-#endif
+            const uint32_t available = tx_sendable(sizeof(buf));
+            // nothing to send
             if (available == 0) {
-                return active;
+                break;
             }
-        }
-        uint8_t buf[available];
-        uint32_t n;
-        {
-            WITH_SEMAPHORE(sem);
             n = writebuffer->peekbytes(buf, available);
         }
-
-        // nothing to send return
-        if (n <= 0) {
-            return active;
+        if (n == 0) {
+            break;
         }
 
         ssize_t ret = -1;
@@ -416,24 +529,106 @@ bool AP_Networking::Port::send_receive(void)
         }
 
         if (ret > 0) {
-            WITH_SEMAPHORE(sem);
-            writebuffer->advance(ret);
-            tx_stats_bytes += ret;
+            bool drained;
+            {
+                WITH_SEMAPHORE(sem);
+                writebuffer->advance(ret);
+                drained = writebuffer->available() == 0;
+                tx_stats_bytes += ret;
+                tx_stats_packets++;
+                if (drained) {
+                    const uint32_t latency_us = AP_HAL::micros() - tx_queued_us;
+                    tx_latency_avg_us = (tx_latency_avg_us * 15 + latency_us) / 16;
+                    tx_latency_max_us = MAX(tx_latency_max_us, latency_us);
+                }
+            }
             active = true;
-        } else if (errno == ENOTCONN &&
-            (type == NetworkPortType::TCP_CLIENT || type == NetworkPortType::TCP_SERVER)) {
-            // close socket and mark as disconnected, so we can reconnect with another client or when server comes back
-            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: disconnected", unsigned(state.idx));
-            sock->close();
-            delete sock;
-            sock = nullptr;
-            connected = false;
+            if (drained) {
+                break;
+            }
+            if (uint32_t(ret) < n) {
+                // the socket is full
+                break;
+            }
+        } else {
+            if (errno == ENOTCONN &&
+                (type == NetworkPortType::TCP_CLIENT || type == NetworkPortType::TCP_SERVER)) {
+                // close socket and mark as disconnected, so we can reconnect with another client or when server comes back
+                close_connection("disconnected");
+            }
+            break;
         }
     }
 
     return active;
 }
 
+/*
+  report throughput and latency of the port since the last call
+ */
+void AP_Networking::Port::port_info(ExpandingString &str, uint32_t now_ms)
+{
+    WITH_SEMAPHORE(sem);
+
+    const uint32_t dt_ms = MAX(now_ms - last_report.time_ms, 1U);
+    const uint32_t tx_bytes = tx_stats_bytes;
+    const uint32_t rx_bytes = rx_stats_bytes;
+
+    const char *type_str = "";
+    const NetworkPortType ptype = (NetworkPortType)type;
+    switch (ptype) {
+    case NetworkPortType::NONE:
+        return;
+    case NetworkPortType::UDP_CLIENT:
+        type_str = "UDP_CLIENT";
+        break;
+    case NetworkPortType::UDP_SERVER:
+        type_str = "UDP_SERVER";
+        break;
+    case NetworkPortType::TCP_CLIENT:
+        type_str = "TCP_CLIENT";
+        break;
+    case NetworkPortType::TCP_SERVER:
+        type_str = "TCP_SERVER";
+        break;
+    }
+
+    str.printf("NET_P%u %-10s %s TX=%8u RX=%8u TXR=%8uB/s RXR=%8uB/s TXPKT=%7u RXPKT=%7u TXLAT=%6uus TXMAXLAT=%7uus RXLAT=%6uus RXMAXLAT=%7uus\n",
+               unsigned(state.idx - AP_SERIALMANAGER_NET_PORT_1),
+               type_str,
+               connected ? "UP  " : "DOWN",
+               unsigned(tx_bytes),
+               unsigned(rx_bytes),
+               unsigned(uint64_t(tx_bytes - last_report.tx_bytes) * 1000U / dt_ms),
+               unsigned(uint64_t(rx_bytes - last_report.rx_bytes) * 1000U / dt_ms),
+               unsigned(tx_stats_packets),
+               unsigned(rx_stats_packets),
+               unsigned(tx_latency_avg_us),
+               unsigned(tx_latency_max_us),
+               unsigned(rx_latency_avg_us),
+               unsigned(rx_latency_max_us));
+
+    last_report.time_ms = now_ms;
+    last_report.tx_bytes = tx_bytes;
+    last_report.rx_bytes = rx_bytes;
+    tx_latency_max_us = 0;
+    rx_latency_max_us = 0;
+}
+
+/*
+  report on all network ports
+ */
+void AP_Networking::ports_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("NetPortsV1\n");
+    str.printf("WAKEUPS=%u\n", unsigned(ports_wakeups));
+    const uint32_t now_ms = AP_HAL::millis();
+    for (auto &p : ports) {
+        p.port_info(str, now_ms);
+    }
+}
+
 /*
   available space in outgoing buffer
  */
@@ -453,13 +648,23 @@ void AP_Networking::Port::_begin(uint32_t b, uint16_t rxS, uint16_t txS)
 size_t AP_Networking::Port::_write(const uint8_t *buffer, size_t size)
 {
     WITH_SEMAPHORE(sem);
+    if (writebuffer->available() == 0) {
+        // start of the latency measurement
+        tx_queued_us = AP_HAL::micros();
+    }
     return writebuffer->write(buffer, size);
 }
 
 ssize_t AP_Networking::Port::_read(uint8_t *buffer, uint16_t count)
 {
     WITH_SEMAPHORE(sem);
-    return readbuffer->read(buffer, count);
+    const uint32_t ret = readbuffer->read(buffer, count);
+    if (ret > 0 && readbuffer->available() == 0) {
+        const uint32_t latency_us = AP_HAL::micros() - rx_queued_us;
+        rx_latency_avg_us = (rx_latency_avg_us * 15 + latency_us) / 16;
+        rx_latency_max_us = MAX(rx_latency_max_us, latency_us);
+    }
+    return ret;
 }
 
 uint32_t AP_Networking::Port::_available()
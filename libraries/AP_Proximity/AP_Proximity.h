@@ -24,6 +24,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_Proximity_Params.h"
 #include "AP_Proximity_Boundary_3D.h"
+#include "AP_Proximity_PointCloud.h"
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 #include <AP_HAL/Semaphores.h>
@@ -206,8 +207,15 @@ public:
     // 3D boundary
     AP_Proximity_Boundary_3D boundary;
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // voxel downsampled points from high resolution sensors, earth frame
+    AP_Proximity_PointCloud pointcloud;
+#endif
+
     // Check if Obstacle defined by body-frame yaw and pitch is near ground
     bool check_obstacle_near_ground(float pitch, float yaw, float distance) const;
+    // Check if Obstacle at the NED offset (in meters) from the vehicle is near ground
+    bool check_obstacle_near_ground(const Vector3f &obstacle_ned) const;
 
     // get proximity address (for AP_Periph CAN)
     uint8_t get_address(uint8_t id) const {
@@ -145,4 +145,65 @@ void AP_Proximity_Backend::database_push(float angle, float pitch, float distanc
 #endif  // AP_OADATABASE_ENABLED
 }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+// add body-frame FRD points (in meters) measured at timestamp_ms to the point cloud.
+// Points out of range or near the ground are dropped and the downsampled voxels are
+// passed on to the Object Avoidance database
+void AP_Proximity_Backend::push_points(const Vector3f *points_frd, uint16_t count, uint32_t timestamp_ms)
+{
+    Vector3f current_pos;
+    if (!AP::ahrs().get_relative_position_NED_origin_float(current_pos)) {
+        return;
+    }
+    const Matrix3f body_to_ned = AP::ahrs().get_rotation_body_to_ned();
+
+    const float dist_min_sq = sq(MAX(distance_min(), params.min_m.get()));
+    float dist_max = distance_max();
+    if (!is_zero(params.max_m)) {
+        dist_max = MIN(dist_max, params.max_m.get());
+    }
+    const float dist_max_sq = sq(dist_max);
+
+#if AP_OADATABASE_ENABLED
+    AP_OADatabase *oaDb = AP::oadatabase();
+    const bool database_ready = oaDb != nullptr && oaDb->healthy();
+    // the database works in NEU
+    const Vector3f current_pos_neu{current_pos.x, current_pos.y, -current_pos.z};
+#endif
+
+    // points are rotated and merged in chunks to keep the stack small
+    const uint16_t chunk_size = 16;
+    Vector3f points_ned[chunk_size];
+    Vector3f voxels[chunk_size];
+    uint16_t i = 0;
+    while (i < count) {
+        uint16_t n = 0;
+        for (; i < count && n < chunk_size; i++) {
+            const float dist_sq = points_frd[i].length_squared();
+            if (dist_sq < dist_min_sq || dist_sq > dist_max_sq || is_zero(dist_sq)) {
+                continue;
+            }
+            const Vector3f rotated = body_to_ned * points_frd[i];
+            if (frontend.check_obstacle_near_ground(rotated)) {
+                continue;
+            }
+            points_ned[n++] = current_pos + rotated;
+        }
+
+        const uint16_t num_voxels = frontend.pointcloud.add_points(points_ned, n, timestamp_ms, voxels, chunk_size);
+
+#if AP_OADATABASE_ENABLED
+        if (database_ready && num_voxels > 0) {
+            for (uint16_t v = 0; v < num_voxels; v++) {
+                voxels[v].z = -voxels[v].z;
+            }
+            oaDb->queue_push(voxels, num_voxels, current_pos_neu, timestamp_ms, AP_OADatabase::OA_DbItem::Source::proximity);
+        }
+#else
+        (void)num_voxels;
+#endif
+    }
+}
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
+
 #endif // HAL_PROXIMITY_ENABLED
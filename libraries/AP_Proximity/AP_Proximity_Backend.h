@@ -84,6 +84,13 @@ protected:
     };
     static void database_push(float angle, float pitch, float distance, uint32_t timestamp_ms, const Vector3f &current_pos, const Matrix3f &body_to_ned);
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // add body-frame FRD points (in meters) measured at timestamp_ms to the point cloud.
+    // Points out of range or near the ground are dropped and the downsampled voxels are
+    // passed on to the Object Avoidance database
+    void push_points(const Vector3f *points_frd, uint16_t count, uint32_t timestamp_ms);
+#endif
+
     // semaphore for access to shared frontend data
     HAL_Semaphore _sem;
 
@@ -37,8 +37,25 @@ void AP_Proximity_MAV::update(void)
     } else {
         set_status(AP_Proximity::Status::Good);
     }
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // don't hold points back waiting for the next scan
+    flush_points();
+#endif
 }
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+// pass buffered OBSTACLE_DISTANCE_3D points to the point cloud
+void AP_Proximity_MAV::flush_points()
+{
+    if (_num_points == 0) {
+        return;
+    }
+    push_points(_points_frd, _num_points, _points_ms);
+    _num_points = 0;
+}
+#endif
+
 // get distance upwards in meters. returns true on success
 bool AP_Proximity_MAV::get_upward_distance(float &distance) const
 {
@@ -236,14 +253,19 @@ void AP_Proximity_MAV::handle_obstacle_distance_3d_msg(const mavlink_message_t &
         temp_boundary.update_3D_boundary(state.instance, frontend.boundary);
         // clear temp boundary for new data
         temp_boundary.reset();
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+        flush_points();
+#endif
     }
 
     _distance_min = packet.min_distance;
     _distance_max = packet.max_distance;
 
+#if !AP_PROXIMITY_POINTCLOUD_ENABLED
     Vector3f current_pos;
     Matrix3f body_to_ned;
     const bool database_ready = database_prepare_for_push(current_pos, body_to_ned);
+#endif
 
     const Vector3f obstacle_FRD(packet.x, packet.y, packet.z);
     const float obstacle_distance = obstacle_FRD.length();
@@ -268,9 +290,18 @@ void AP_Proximity_MAV::handle_obstacle_distance_3d_msg(const mavlink_message_t &
     const AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(pitch, yaw);
     temp_boundary.add_distance(face, pitch, yaw, obstacle.length());
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // the point cloud downsamples before updating the OA database
+    if (_num_points >= POINTS_BUFFER_SIZE) {
+        flush_points();
+    }
+    _points_frd[_num_points++] = obstacle_FRD;
+    _points_ms = _last_update_ms;
+#else
     if (database_ready) {
         database_push(yaw, pitch, obstacle.length(),_last_update_ms, current_pos, body_to_ned);
     }
+#endif
     return;
 }
 
@@ -37,6 +37,18 @@ private:
 
    AP_Proximity_Temp_Boundary temp_boundary;
 
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+    // pass buffered OBSTACLE_DISTANCE_3D points to the point cloud
+    void flush_points();
+
+    // OBSTACLE_DISTANCE_3D carries a single point, so points are
+    // collected and added to the point cloud as a batch
+    static const uint8_t POINTS_BUFFER_SIZE = 32;
+    Vector3f _points_frd[POINTS_BUFFER_SIZE];   // body-frame FRD points in meters
+    uint8_t _num_points;                        // number of points in _points_frd
+    uint32_t _points_ms;                        // system time the buffered points were received
+#endif
+
     // horizontal distance support
     uint32_t _last_update_ms;   // system time of last mavlink message received
     uint32_t _last_msg_update_timestamp_ms;   // last stored mavlink message timestamp
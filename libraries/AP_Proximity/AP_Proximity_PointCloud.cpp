@@ -0,0 +1,210 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Proximity_PointCloud.h"
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+static_assert((AP_PROXIMITY_POINTCLOUD_VOXELS & (AP_PROXIMITY_POINTCLOUD_VOXELS - 1)) == 0,
+              "AP_PROXIMITY_POINTCLOUD_VOXELS must be a power of two");
+static_assert(AP_PROXIMITY_POINTCLOUD_MAX_PROBE <= AP_PROXIMITY_POINTCLOUD_VOXELS,
+              "probe window larger than the table");
+
+// once a voxel holds this many points the centroid becomes a moving
+// average, so it follows an obstacle that moves within the voxel
+#define POINTCLOUD_CENTROID_POINTS_MAX 64
+
+// allocate the table on first use, returns false on failure
+bool AP_Proximity_PointCloud::allocate()
+{
+    if (_voxels != nullptr) {
+        return true;
+    }
+    if (_alloc_failed) {
+        return false;
+    }
+    _voxels = NEW_NOTHROW Voxel[AP_PROXIMITY_POINTCLOUD_VOXELS]();
+    if (_voxels == nullptr) {
+        _alloc_failed = true;
+        return false;
+    }
+    return true;
+}
+
+// return the voxel for the grid coordinates, claiming a slot if needed
+AP_Proximity_PointCloud::Voxel &AP_Proximity_PointCloud::find_or_claim(const int16_t key[3], uint32_t now_ms)
+{
+    // spatial hash of the grid coordinates
+    const uint32_t hash = (uint32_t(key[0]) * 73856093U) ^
+                          (uint32_t(key[1]) * 19349663U) ^
+                          (uint32_t(key[2]) * 83492791U);
+
+    // the whole probe window is always searched, so expired or
+    // recycled slots never hide a live voxel further along
+    Voxel *free_slot = nullptr;
+    Voxel *oldest = nullptr;
+    for (uint8_t i = 0; i < AP_PROXIMITY_POINTCLOUD_MAX_PROBE; i++) {
+        Voxel &v = _voxels[(hash + i) & (AP_PROXIMITY_POINTCLOUD_VOXELS - 1)];
+        if (!live(v, now_ms)) {
+            if (free_slot == nullptr) {
+                free_slot = &v;
+            }
+            continue;
+        }
+        if (v.key[0] == key[0] && v.key[1] == key[1] && v.key[2] == key[2]) {
+            return v;
+        }
+        if (oldest == nullptr || int32_t(v.last_ms - oldest->last_ms) < 0) {
+            oldest = &v;
+        }
+    }
+
+    // new voxel, take a free slot or recycle the stalest one
+    Voxel &v = (free_slot != nullptr) ? *free_slot : *oldest;
+    v.key[0] = key[0];
+    v.key[1] = key[1];
+    v.key[2] = key[2];
+    v.points = 0;
+    v.batch = _batch - 1;
+    return v;
+}
+
+// add a batch of points. The centroids of up to max_touched voxels
+// hit by this batch are written to touched (may be nullptr).
+// returns the number of centroids written
+uint16_t AP_Proximity_PointCloud::add_points(const Vector3f *points_ned, uint16_t count, uint32_t timestamp_ms, Vector3f *touched, uint16_t max_touched)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (count == 0 || !allocate()) {
+        return 0;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const float inv_size = 1.0f / AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M;
+    max_touched = (touched == nullptr) ? 0 : MIN(max_touched, uint16_t(AP_PROXIMITY_POINTCLOUD_BATCH_MAX));
+    uint16_t num_touched = 0;
+
+    _batch++;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const Vector3f &p = points_ned[i];
+        const float gx = floorf(p.x * inv_size);
+        const float gy = floorf(p.y * inv_size);
+        const float gz = floorf(p.z * inv_size);
+        if (!(fabsf(gx) <= INT16_MAX && fabsf(gy) <= INT16_MAX && fabsf(gz) <= INT16_MAX)) {
+            // too far from the origin to be represented, or not a number
+            continue;
+        }
+        const int16_t key[3] { int16_t(gx), int16_t(gy), int16_t(gz) };
+
+        Voxel &v = find_or_claim(key, now_ms);
+        if (v.points < POINTCLOUD_CENTROID_POINTS_MAX) {
+            v.points++;
+        }
+        v.centroid += (p - v.centroid) / v.points;
+        v.last_ms = timestamp_ms;
+
+        if (v.batch != _batch) {
+            v.batch = _batch;
+            if (num_touched < max_touched) {
+                _touched[num_touched++] = &v - _voxels;
+            }
+        }
+    }
+
+    // report centroids once all points in the batch have been merged
+    for (uint16_t i = 0; i < num_touched; i++) {
+        touched[i] = _voxels[_touched[i]].centroid;
+    }
+    return num_touched;
+}
+
+// find the nearest voxel ahead of pos_ned along the unit vector dir
+// that lies within radius_m of the line and max_dist_m along it.
+// dist_m is the distance along dir. Cost is bounded by the table size
+bool AP_Proximity_PointCloud::closest_along(const Vector3f &pos_ned, const Vector3f &dir, float max_dist_m, float radius_m, float &dist_m, Vector3f &obstacle_ned) const
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_voxels == nullptr) {
+        return false;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const float radius_sq = sq(radius_m);
+    float best = max_dist_m;
+    const Voxel *closest = nullptr;
+    for (uint16_t i = 0; i < AP_PROXIMITY_POINTCLOUD_VOXELS; i++) {
+        const Voxel &v = _voxels[i];
+        if (!live(v, now_ms)) {
+            continue;
+        }
+        const Vector3f rel = v.centroid - pos_ned;
+        const float along = rel * dir;
+        if (!is_positive(along) || along >= best) {
+            // behind us or further than the best so far
+            continue;
+        }
+        if (rel.length_squared() - sq(along) > radius_sq) {
+            // passes wide of the path
+            continue;
+        }
+        best = along;
+        closest = &v;
+    }
+
+    if (closest == nullptr) {
+        return false;
+    }
+    dist_m = best;
+    obstacle_ned = closest->centroid;
+    return true;
+}
+
+// number of voxels that have not timed out
+uint16_t AP_Proximity_PointCloud::count() const
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_voxels == nullptr) {
+        return 0;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    uint16_t ret = 0;
+    for (uint16_t i = 0; i < AP_PROXIMITY_POINTCLOUD_VOXELS; i++) {
+        if (live(_voxels[i], now_ms)) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+// forget all voxels
+void AP_Proximity_PointCloud::reset()
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_voxels == nullptr) {
+        return;
+    }
+    for (uint16_t i = 0; i < AP_PROXIMITY_POINTCLOUD_VOXELS; i++) {
+        _voxels[i].points = 0;
+    }
+}
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
@@ -0,0 +1,94 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_Proximity_config.h"
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_HAL/Semaphores.h>
+
+#define AP_PROXIMITY_POINTCLOUD_MAX_PROBE   16  // slots searched for a voxel before the oldest one is replaced
+#define AP_PROXIMITY_POINTCLOUD_BATCH_MAX   32  // most voxels reported back from a single add_points() call
+
+/*
+  Fixed memory occupancy grid for high resolution sensors (3D lidars,
+  depth cameras). Points are snapped to a voxel grid in earth frame and
+  each occupied voxel keeps the mean of the points that fell in it, so
+  a scan of thousands of points is reduced to one entry per voxel.
+
+  Voxels live in an open addressed hash table of
+  AP_PROXIMITY_POINTCLOUD_VOXELS entries. Entries expire lazily after
+  AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS and when the table is full the
+  oldest entry in the probe window is recycled, so the most recent
+  surroundings are always kept.
+
+  All positions are NED in meters from the EKF origin.
+ */
+class AP_Proximity_PointCloud
+{
+public:
+    AP_Proximity_PointCloud() {}
+
+    CLASS_NO_COPY(AP_Proximity_PointCloud);
+
+    // add a batch of points. The centroids of up to max_touched voxels
+    // hit by this batch are written to touched (may be nullptr).
+    // returns the number of centroids written
+    uint16_t add_points(const Vector3f *points_ned, uint16_t count, uint32_t timestamp_ms, Vector3f *touched, uint16_t max_touched);
+
+    // find the nearest voxel ahead of pos_ned along the unit vector dir
+    // that lies within radius_m of the line and max_dist_m along it.
+    // dist_m is the distance along dir. Cost is bounded by the table size
+    bool closest_along(const Vector3f &pos_ned, const Vector3f &dir, float max_dist_m, float radius_m, float &dist_m, Vector3f &obstacle_ned) const;
+
+    // number of voxels that have not timed out
+    uint16_t count() const;
+
+    // forget all voxels
+    void reset();
+
+private:
+
+    struct Voxel {
+        Vector3f centroid;      // mean of the points in this voxel
+        uint32_t last_ms;       // timestamp of the most recent point
+        int16_t key[3];         // grid coordinates
+        uint16_t points;        // points merged into the centroid, 0 if unused
+        uint16_t batch;         // add_points() call that last touched this voxel
+    };
+
+    // allocate the table on first use, returns false on failure
+    bool allocate();
+
+    // true if the voxel holds data younger than the timeout
+    static bool live(const Voxel &v, uint32_t now_ms) {
+        return v.points != 0 && (now_ms - v.last_ms) < AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS;
+    }
+
+    // return the voxel for the grid coordinates, claiming a slot if needed
+    Voxel &find_or_claim(const int16_t key[3], uint32_t now_ms);
+
+    Voxel *_voxels = nullptr;   // table, nullptr until the first point arrives
+    bool _alloc_failed = false; // true if allocation failed, don't retry
+    uint16_t _batch = 0;        // id of the current add_points() call
+    uint16_t _touched[AP_PROXIMITY_POINTCLOUD_BATCH_MAX];   // table index of voxels touched by the current batch
+
+    mutable HAL_Semaphore _sem;
+};
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
@@ -72,14 +72,32 @@ bool AP_Proximity::check_obstacle_near_ground(float pitch, float yaw, float dist
     const Matrix3f body_to_ned = AP::ahrs().get_rotation_body_to_ned();
     const Vector3f rotated_object_3D = body_to_ned * object_3D;
 
+    return check_obstacle_near_ground(rotated_object_3D);
+#else
+    return false;
+#endif
+}
+
+// Check if Obstacle at the NED offset (in meters) from the vehicle is near ground
+bool AP_Proximity::check_obstacle_near_ground(const Vector3f &obstacle_ned) const
+{
+#if !APM_BUILD_TYPE(APM_BUILD_AP_Periph)
+    if (!_ign_gnd_enable) {
+        return false;
+    }
+    if (!hal.util->get_soft_armed()) {
+        // don't run this feature while vehicle is disarmed, otherwise proximity data will not show up on GCS
+        return false;
+    }
+
     float alt = FLT_MAX;
     if (!get_rangefinder_alt(alt)) {
         return false;
     }
 
-    if (rotated_object_3D.z > -0.5f) {
+    if (obstacle_ned.z > -0.5f) {
         // obstacle is at the most 0.5 meters above vehicle
-        if ((alt - _alt_min) < rotated_object_3D.z) {
+        if ((alt - _alt_min) < obstacle_ned.z) {
             // obstacle is near or below ground
             return true;
         }
@@ -81,3 +81,19 @@
 #ifndef AP_PROXIMITY_MR72_DRIVER_ENABLED
 #define AP_PROXIMITY_MR72_DRIVER_ENABLED (AP_PROXIMITY_MR72_ENABLED  || AP_PROXIMITY_HEXSOONRADAR_ENABLED)
 #endif  // AP_PROXIMITY_MR72_DRIVER_ENABLED
+
+#ifndef AP_PROXIMITY_POINTCLOUD_ENABLED
+#define AP_PROXIMITY_POINTCLOUD_ENABLED HAL_PROXIMITY_ENABLED && HAL_PROGRAM_SIZE_LIMIT_KB > 1024
+#endif
+
+#ifndef AP_PROXIMITY_POINTCLOUD_VOXELS
+#define AP_PROXIMITY_POINTCLOUD_VOXELS 512      // number of voxels held, must be a power of two
+#endif
+
+#ifndef AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M
+#define AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M 0.5f   // edge length of a voxel in meters
+#endif
+
+#ifndef AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS
+#define AP_PROXIMITY_POINTCLOUD_TIMEOUT_MS 3000     // voxels not seen for this long are forgotten
+#endif
@@ -0,0 +1,115 @@
+#include <AP_gtest.h>
+
+#include <AP_Proximity/AP_Proximity_PointCloud.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_PROXIMITY_POINTCLOUD_ENABLED
+
+static const float voxel = AP_PROXIMITY_POINTCLOUD_VOXEL_SIZE_M;
+
+/*
+  many points inside one voxel collapse to a single entry at their mean
+ */
+TEST(PointCloud, Downsample)
+{
+    AP_Proximity_PointCloud cloud;
+    Vector3f points[50];
+    Vector3f sum;
+    for (uint8_t i = 0; i < ARRAY_SIZE(points); i++) {
+        points[i] = Vector3f{10.0f, 2.0f, -1.0f} + Vector3f{float(i % 10), float(i / 10), float(i % 7)} * (voxel * 0.09f);
+        sum += points[i];
+    }
+    Vector3f touched[4];
+    EXPECT_EQ(cloud.add_points(points, ARRAY_SIZE(points), AP_HAL::millis(), touched, ARRAY_SIZE(touched)), 1);
+    EXPECT_EQ(cloud.count(), 1);
+    const Vector3f mean = sum / ARRAY_SIZE(points);
+    EXPECT_NEAR(touched[0].x, mean.x, 1e-3);
+    EXPECT_NEAR(touched[0].y, mean.y, 1e-3);
+    EXPECT_NEAR(touched[0].z, mean.z, 1e-3);
+
+    // adding the same points again touches the same voxel
+    EXPECT_EQ(cloud.add_points(points, ARRAY_SIZE(points), AP_HAL::millis(), touched, ARRAY_SIZE(touched)), 1);
+    EXPECT_EQ(cloud.count(), 1);
+
+    cloud.reset();
+    EXPECT_EQ(cloud.count(), 0);
+}
+
+/*
+  a dense wall is reduced to one entry per voxel it crosses
+ */
+TEST(PointCloud, Wall)
+{
+    AP_Proximity_PointCloud cloud;
+    // 4m x 2m wall 5m north, sampled every 5cm
+    for (uint16_t row = 0; row < 40; row++) {
+        Vector3f points[80];
+        for (uint16_t col = 0; col < ARRAY_SIZE(points); col++) {
+            points[col] = Vector3f{5.1f, -2.0f + col * 0.05f + 0.01f, -row * 0.05f - 0.01f};
+        }
+        cloud.add_points(points, ARRAY_SIZE(points), AP_HAL::millis(), nullptr, 0);
+    }
+    EXPECT_EQ(cloud.count(), uint16_t((4.0f / voxel) * (2.0f / voxel)));
+}
+
+/*
+  the nearest obstacle in the path is found, ignoring obstacles behind
+  or off to the side
+ */
+TEST(PointCloud, ClosestAlong)
+{
+    AP_Proximity_PointCloud cloud;
+    const Vector3f points[] {
+        { -3.0f,  0.0f, 0.0f },     // behind
+        {  4.0f,  6.0f, 0.0f },     // off to the side
+        { 12.0f,  0.2f, 0.0f },     // in the path, far
+        {  8.0f, -0.2f, 0.0f },     // in the path, near
+        { 30.0f,  0.0f, 0.0f },     // beyond the look ahead
+    };
+    cloud.add_points(points, ARRAY_SIZE(points), AP_HAL::millis(), nullptr, 0);
+    EXPECT_EQ(cloud.count(), ARRAY_SIZE(points));
+
+    float dist;
+    Vector3f obstacle;
+    ASSERT_TRUE(cloud.closest_along(Vector3f{}, Vector3f{1, 0, 0}, 20.0f, 1.0f, dist, obstacle));
+    EXPECT_NEAR(dist, 8.0f, voxel);
+    EXPECT_NEAR(obstacle.y, -0.2f, voxel);
+
+    // heading west there is only the point behind
+    ASSERT_TRUE(cloud.closest_along(Vector3f{}, Vector3f{-1, 0, 0}, 20.0f, 1.0f, dist, obstacle));
+    EXPECT_NEAR(dist, 3.0f, voxel);
+
+    // nothing to the south
+    EXPECT_FALSE(cloud.closest_along(Vector3f{}, Vector3f{0, -1, 0}, 20.0f, 1.0f, dist, obstacle));
+
+    // nothing within a short look ahead
+    EXPECT_FALSE(cloud.closest_along(Vector3f{}, Vector3f{1, 0, 0}, 5.0f, 1.0f, dist, obstacle));
+}
+
+/*
+  memory stays fixed however many distinct voxels are seen
+ */
+TEST(PointCloud, Capacity)
+{
+    AP_Proximity_PointCloud cloud;
+    for (uint16_t n = 0; n < 4 * AP_PROXIMITY_POINTCLOUD_VOXELS; n += 64) {
+        Vector3f points[64];
+        for (uint16_t i = 0; i < ARRAY_SIZE(points); i++) {
+            points[i] = Vector3f{(n + i) * voxel * 1.5f, 0.0f, 0.0f};
+        }
+        cloud.add_points(points, ARRAY_SIZE(points), AP_HAL::millis(), nullptr, 0);
+    }
+    EXPECT_LE(cloud.count(), AP_PROXIMITY_POINTCLOUD_VOXELS);
+    EXPECT_GT(cloud.count(), AP_PROXIMITY_POINTCLOUD_VOXELS / 2);
+
+    // the most recent point is always kept
+    float dist;
+    Vector3f obstacle;
+    const Vector3f last{(4 * AP_PROXIMITY_POINTCLOUD_VOXELS - 1) * voxel * 1.5f, 0.0f, 0.0f};
+    EXPECT_TRUE(cloud.closest_along(last - Vector3f{1, 0, 0}, Vector3f{1, 0, 0}, 2.0f, 0.5f, dist, obstacle));
+}
+
+#endif // AP_PROXIMITY_POINTCLOUD_ENABLED
+
+AP_GTEST_MAIN()
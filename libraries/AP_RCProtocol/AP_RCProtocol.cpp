@@ -41,6 +41,7 @@
 #include "AP_RCProtocol_UDP.h"
 #include "AP_RCProtocol_FDM.h"
 #include "AP_RCProtocol_Radio.h"
+#include <AP_Common/ExpandingString.h>
 #include <AP_Math/AP_Math.h>
 #include <RC_Channel/RC_Channel.h>
 
@@ -186,36 +187,56 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
         return;
     }
 
-    // otherwise scan all protocols
+    // otherwise scan the candidate protocols
+    if (_search.search_start_ms == 0 ||
+        now - _search.round_start_ms >= AP_RCPROTOCOL_DETECT_RETRY_MS) {
+        restart_search(now);
+    }
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    _search.sample++;
+#endif
     for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (_disabled_for_pulses & (1U << i)) {
-            // this protocol is disabled for pulse input
+        if ((_search.pulse_candidates & (1U << i)) == 0 ||
+            (_disabled_for_pulses & (1U << i))) {
+            // can't decode pulses, or has been disabled for them
             continue;
         }
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
-            }
-            const uint32_t frame_count = backend[i]->get_rc_frame_count();
-            const uint32_t input_count = backend[i]->get_rc_input_count();
-            backend[i]->process_pulse(width_s0, width_s1);
-            const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
-            if (frame_count2 > frame_count) {
-                if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
-                    continue;
-                }
-                _new_input = (input_count != backend[i]->get_rc_input_count());
-                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
-                    if (backend[j]) {
-                        backend[j]->reset_rc_frame_count();
-                    }
-                }
-                _last_input_ms = now;
-                _detected_with_bytes = false;
-                break;
+        if (!protocol_enabled(rcprotocol_t(i))) {
+            continue;
+        }
+        const uint32_t frame_count = backend[i]->get_rc_frame_count();
+        const uint32_t input_count = backend[i]->get_rc_input_count();
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+        const uint32_t start_us = (_search.sample & 0xF) == 0 ? AP_HAL::micros() : 0;
+#endif
+        backend[i]->process_pulse(width_s0, width_s1);
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+        if (start_us != 0) {
+            // timing every pulse would cost more than the decoding
+            _search.stats[i].cost_us += (AP_HAL::micros() - start_us) * 16;
+        }
+        _search.stats[i].inputs++;
+#endif
+        const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
+        if (frame_count2 <= frame_count) {
+            search_input(i, AP_RCPROTOCOL_DETECT_REJECT_PULSES, _search.pulse_candidates);
+            continue;
+        }
+        _search.since_frame[i] = 0;
+        if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
+            continue;
+        }
+        _new_input = (input_count != backend[i]->get_rc_input_count());
+        _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
+        for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
+            if (backend[j]) {
+                backend[j]->reset_rc_frame_count();
             }
         }
+        _last_input_ms = now;
+        _detected_with_bytes = false;
+        search_done(now);
+        break;
     }
 }
 
@@ -271,38 +292,127 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
         return true;
     }
 
-    // otherwise scan all protocols
+    // otherwise scan the candidate protocols
+    if (_search.search_start_ms == 0 ||
+        baudrate != _search.baudrate ||
+        now - _search.round_start_ms >= AP_RCPROTOCOL_DETECT_RETRY_MS) {
+        _search.baudrate = baudrate;
+        restart_search(now);
+    }
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    _search.sample++;
+#endif
     for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
-            }
-            const uint32_t frame_count = backend[i]->get_rc_frame_count();
-            const uint32_t input_count = backend[i]->get_rc_input_count();
-            backend[i]->process_byte(byte, baudrate);
-            const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
-            if (frame_count2 > frame_count) {
-                if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
-                    continue;
-                }
-                _new_input = (input_count != backend[i]->get_rc_input_count());
-                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                _last_input_ms = now;
-                _detected_with_bytes = true;
-                for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
-                    if (backend[j]) {
-                        backend[j]->reset_rc_frame_count();
-                    }
-                }
-                // stop decoding pulses to save CPU
-                hal.rcin->pulse_input_enable(false);
-                return true;
+        if ((_search.byte_candidates & (1U << i)) == 0) {
+            continue;
+        }
+        if (!protocol_enabled(rcprotocol_t(i))) {
+            continue;
+        }
+        const uint32_t frame_count = backend[i]->get_rc_frame_count();
+        const uint32_t input_count = backend[i]->get_rc_input_count();
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+        const uint32_t start_us = (_search.sample & 0xF) == 0 ? AP_HAL::micros() : 0;
+#endif
+        backend[i]->process_byte(byte, baudrate);
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+        if (start_us != 0) {
+            // timing every byte would cost more than the decoding
+            _search.stats[i].cost_us += (AP_HAL::micros() - start_us) * 16;
+        }
+        _search.stats[i].inputs++;
+#endif
+        const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
+        if (frame_count2 <= frame_count) {
+            search_input(i, AP_RCPROTOCOL_DETECT_REJECT_BYTES, _search.byte_candidates);
+            continue;
+        }
+        _search.since_frame[i] = 0;
+        if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
+            continue;
+        }
+        _new_input = (input_count != backend[i]->get_rc_input_count());
+        _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
+        _last_input_ms = now;
+        _detected_with_bytes = true;
+        for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
+            if (backend[j]) {
+                backend[j]->reset_rc_frame_count();
             }
         }
+        search_done(now);
+        // stop decoding pulses to save CPU
+        hal.rcin->pulse_input_enable(false);
+        return true;
     }
     return false;
 }
 
+/*
+  start a new round of the protocol search with every backend that
+  can decode the input as a candidate
+ */
+void AP_RCProtocol::restart_search(uint32_t now_ms)
+{
+    if (_search.search_start_ms == 0) {
+        _search.search_start_ms = now_ms;
+    }
+    _search.round_start_ms = now_ms;
+    _search.byte_candidates = 0;
+    _search.pulse_candidates = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+        _search.since_frame[i] = 0;
+        if (backend[i] == nullptr) {
+            continue;
+        }
+        if (backend[i]->accepts_baudrate(_search.baudrate)) {
+            _search.byte_candidates |= 1U << i;
+        }
+        if (backend[i]->accepts_pulses()) {
+            _search.pulse_candidates |= 1U << i;
+        }
+    }
+}
+
+/*
+  count an input that didn't complete a frame, dropping the backend
+  from this round once it has had enough of them
+ */
+void AP_RCProtocol::search_input(uint8_t i, uint16_t reject_limit, uint32_t &candidates)
+{
+    if (_search.since_frame[i] < reject_limit) {
+        _search.since_frame[i]++;
+        return;
+    }
+    if (!can_reject(rcprotocol_t(i))) {
+        return;
+    }
+    candidates &= ~(1U << i);
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    _search.stats[i].rejections++;
+#endif
+}
+
+/*
+  SRXL2 receivers only stream channels once a handshake carried on
+  the same bytes has completed, so it can't be judged on frames
+ */
+bool AP_RCProtocol::can_reject(rcprotocol_t p) const
+{
+#if AP_RCPROTOCOL_SRXL2_ENABLED
+    if (p == SRXL2) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+void AP_RCProtocol::search_done(uint32_t now_ms)
+{
+    _search.last_search_ms = now_ms - _search.search_start_ms;
+    _search.search_start_ms = 0;
+}
+
 // handshake if nothing else has succeeded so far
 void AP_RCProtocol::process_handshake( uint32_t baudrate)
 {
@@ -453,6 +563,9 @@ bool AP_RCProtocol::detect_async_protocol(rcprotocol_t protocol)
 
     // we can provide data, change the detected protocol to be us:
     _detected_protocol = protocol;
+    if (_search.search_start_ms != 0) {
+        search_done(now);
+    }
     return true;
 }
 
@@ -486,8 +599,38 @@ void AP_RCProtocol::announce_detected()
     }
     (void)src;  // iofirmware doesn't use this
     (void)name;  // iofirmware doesn't use this
-    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "RCInput: decoding %s (%s)", name, src);
+    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "RCInput: decoding %s (%s) after %ums", name, src, unsigned(_search.last_search_ms));
+}
+
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+/*
+  report what the protocol search has cost so far. IN is the number
+  of bytes or pulses each backend decoded while searching, COST an
+  estimate of the time spent doing so from a sample of 1 in 16
+ */
+void AP_RCProtocol::detection_info(ExpandingString &str) const
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("RCInSearchV1\n");
+    const char *name = detected_protocol_name();
+    str.printf("DETECTED=%s SEARCH=%ums\n",
+               name != nullptr ? name : "NONE",
+               unsigned(_search.last_search_ms));
+    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+        if (backend[i] == nullptr) {
+            continue;
+        }
+        const char *pname = protocol_name_from_protocol(rcprotocol_t(i));
+        str.printf("%-10s IN=%8u COST=%8uus REJ=%5u%s%s\n",
+                   pname != nullptr ? pname : "?",
+                   unsigned(_search.stats[i].inputs),
+                   unsigned(_search.stats[i].cost_us),
+                   unsigned(_search.stats[i].rejections),
+                   (_search.byte_candidates & (1U << i)) ? " BYTES" : "",
+                   (_search.pulse_candidates & (1U << i)) ? " PULSES" : "");
+    }
 }
+#endif  // AP_RCPROTOCOL_DETECT_STATS_ENABLED
 
 bool AP_RCProtocol::new_input()
 {
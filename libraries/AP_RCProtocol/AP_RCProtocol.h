@@ -28,6 +28,7 @@
 #define MIN_RCIN_CHANNELS  5
 
 class AP_RCProtocol_Backend;
+class ExpandingString;
 
 class AP_RCProtocol {
 public:
@@ -264,6 +265,11 @@ public:
         return _detected_with_bytes;
     }
 
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+    // protocol search statistics, for @SYS/rcin.txt
+    void detection_info(ExpandingString &str) const;
+#endif
+
     // handle mavlink radio
 #if AP_RCPROTOCOL_MAVLINK_RADIO_ENABLED
     void handle_radio_rc_channels(const mavlink_radio_rc_channels_t* packet);
@@ -304,6 +310,36 @@ private:
     bool _last_detected_using_uart;
     void announce_detected();
 
+    /*
+      protocol search. Each backend that can decode the input is a
+      candidate; one that is fed AP_RCPROTOCOL_DETECT_REJECT_BYTES
+      bytes (or _PULSES pulses) without decoding a frame is dropped.
+      All rejoin on a baudrate change and every
+      AP_RCPROTOCOL_DETECT_RETRY_MS
+     */
+    void restart_search(uint32_t now_ms);
+    bool can_reject(rcprotocol_t p) const;
+    void search_input(uint8_t i, uint16_t reject_limit, uint32_t &candidates);
+    void search_done(uint32_t now_ms);
+
+    struct {
+        uint32_t byte_candidates;
+        uint32_t pulse_candidates;
+        uint32_t baudrate;
+        uint32_t round_start_ms;
+        uint32_t search_start_ms;
+        uint32_t last_search_ms;
+        uint16_t since_frame[NONE];
+#if AP_RCPROTOCOL_DETECT_STATS_ENABLED
+        uint8_t sample;
+        struct {
+            uint32_t inputs;
+            uint32_t cost_us;
+            uint16_t rejections;
+        } stats[NONE];
+#endif
+    } _search;
+
 #endif  // AP_RCPROTCOL_ENABLED
 
 };
@@ -33,6 +33,13 @@ public:
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
     virtual void process_handshake(uint32_t baudrate) {}
+
+    /*
+      detection prefilters: a backend is only fed pulses, or bytes
+      at a given baudrate, while searching if it can decode them
+     */
+    virtual bool accepts_pulses() const { return false; }
+    virtual bool accepts_baudrate(uint32_t baudrate) const { return false; }
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
     bool new_input();
@@ -26,6 +26,7 @@ class AP_RCProtocol_PPMSum : public AP_RCProtocol_Backend {
 public:
     AP_RCProtocol_PPMSum(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
+    bool accepts_pulses() const override { return true; }
 private:
     // state of ppm decoder
     struct {
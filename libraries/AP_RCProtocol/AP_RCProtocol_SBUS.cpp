@@ -207,7 +207,7 @@ void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
 {
     // note that if we're here we're not actually using SoftSerial,
     // but it does record our configured baud rate:
-    if (baudrate != ss.baud()) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
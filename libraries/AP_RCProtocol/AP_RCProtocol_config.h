@@ -99,3 +99,28 @@
 #ifndef AP_RCPROTOCOL_FDM_ENABLED
 #define AP_RCPROTOCOL_FDM_ENABLED AP_RCPROTOCOL_BACKEND_DEFAULT_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
 #endif
+
+// bytes a backend may be fed while searching without decoding a
+// frame before it is dropped from the search
+#ifndef AP_RCPROTOCOL_DETECT_REJECT_BYTES
+#define AP_RCPROTOCOL_DETECT_REJECT_BYTES 256
+#endif
+
+// as above for pulses, a software serial byte is up to 5 pulse pairs
+#ifndef AP_RCPROTOCOL_DETECT_REJECT_PULSES
+#define AP_RCPROTOCOL_DETECT_REJECT_PULSES 2048
+#endif
+
+// interval at which dropped backends rejoin the search
+#ifndef AP_RCPROTOCOL_DETECT_RETRY_MS
+#define AP_RCPROTOCOL_DETECT_RETRY_MS 1000
+#endif
+
+// per backend detection cost, too much RAM for the IOMCU
+#ifndef AP_RCPROTOCOL_DETECT_STATS_ENABLED
+#ifdef IOMCU_FW
+#define AP_RCPROTOCOL_DETECT_STATS_ENABLED 0
+#else
+#define AP_RCPROTOCOL_DETECT_STATS_ENABLED 1
+#endif
+#endif
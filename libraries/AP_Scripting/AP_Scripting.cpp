@@ -165,6 +165,14 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
 
+    // @Param: VM_I_QUOTA
+    // @DisplayName: Scripting per-script instruction quota
+    // @Description: The number of virtual machine instructions each script may execute per second. A script that exceeds its quota has its next run deferred until the end of the current one second window, so a single busy script cannot starve the others. Per-script usage can be seen in @SYS/scripts.txt. 0 disables the quota.
+    // @Range: 0 10000000
+    // @Increment: 10000
+    // @User: Advanced
+    AP_GROUPINFO("VM_I_QUOTA", 19, AP_Scripting, _script_vm_quota, 0),
+
 #if AP_SCRIPTING_SERIALDEVICE_ENABLED
     // @Param: SDEV_EN
     // @DisplayName: Scripting serial device enable
@@ -310,7 +318,7 @@ void AP_Scripting::thread(void) {
         _restart = false;
         _init_failed = false;
 
-        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_options);
+        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_vm_quota, _script_heap_size, _debug_options);
         if (lua == nullptr || !lua->heap_allocated()) {
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "Unable to allocate memory");
             _init_failed = true;
@@ -324,12 +332,20 @@ void AP_Scripting::thread(void) {
             // Clear any dangling pre-arms from previous script loads
             AP_Arming::get_singleton()->reset_all_aux_auths();
 #endif
+            {
+                WITH_SEMAPHORE(_lua_sem);
+                _lua = lua;
+            }
             // run won't return while scripting is still active
             lua->run();
 
             // only reachable if the lua backend has died for any reason
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "stopped");
         }
+        {
+            WITH_SEMAPHORE(_lua_sem);
+            _lua = nullptr;
+        }
         delete lua;
         lua = nullptr;
 
@@ -483,6 +499,15 @@ void AP_Scripting::restart_all()
     _stop = true;
 }
 
+// display per-script statistics as text buffer for @SYS/scripts.txt
+void AP_Scripting::scripts_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(_lua_sem);
+    if (_lua != nullptr) {
+        _lua->scripts_info(str);
+    }
+}
+
 #if HAL_GCS_ENABLED
 void AP_Scripting::handle_message(const mavlink_message_t &msg, const mavlink_channel_t chan) {
     if (mavlink_data.rx_buffer == nullptr) {
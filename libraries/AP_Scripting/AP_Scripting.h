@@ -45,6 +45,8 @@ class SocketAPM;
 #include "AP_Scripting_SerialDevice.h"
 #endif
 
+class ExpandingString;
+
 class AP_Scripting
 {
 public:
@@ -85,6 +87,9 @@ public:
     
     void restart_all(void);
 
+    // display per-script statistics as text buffer for @SYS/scripts.txt
+    void scripts_info(ExpandingString &str);
+
    // User parameters for inputs into scripts 
    AP_Float _user[6];
 
@@ -187,6 +192,7 @@ private:
 
     AP_Int8 _enable;
     AP_Int32 _script_vm_exec_count;
+    AP_Int32 _script_vm_quota;
     AP_Int32 _script_heap_size;
     AP_Int8 _debug_options;
     AP_Int16 _dir_disable;
@@ -210,6 +216,10 @@ private:
 
     static AP_Scripting *_singleton;
     int current_env_ref;
+
+    // running lua instance, protected by _lua_sem for access from outside the scripting thread
+    class lua_scripts *_lua;
+    HAL_Semaphore _lua_sem;
 };
 
 namespace AP {
@@ -21,9 +21,14 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Scripting.h"
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Common/ExpandingString.h>
 
 #include <AP_Scripting/lua_generated_bindings.h>
 
+extern "C" {
+#include "lua/src/lstate.h"
+}
+
 #define DISABLE_INTERRUPTS_FOR_SCRIPT_RUN 0
 
 extern const AP_HAL::HAL& hal;
@@ -49,8 +54,9 @@ static const char *get_error_object_message(lua_State *L) {
     return m;
 }
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options)
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &vm_quota, const AP_Int32 &heap_size, AP_Int8 &debug_options)
     : _vm_steps(vm_steps),
+      _vm_quota(vm_quota),
       _debug_options(debug_options)
 {
     const bool allow_heap_expansion = !option_is_set(AP_Scripting::DebugOption::DISABLE_HEAP_EXPANSION);
@@ -61,6 +67,76 @@ lua_scripts::~lua_scripts() {
     _heap.destroy();
 }
 
+/*
+  accumulate the always-on per-script statistics. If an instruction
+  quota is set then a script which has used more than its quota in the
+  current window is deferred until the window ends, so that a single
+  busy script cannot starve the others
+ */
+void lua_scripts::accumulate_stats(script_info *script, uint32_t run_time_us, int run_mem, uint32_t instructions)
+{
+    {
+        WITH_SEMAPHORE(queue_sem);
+        script->stats.run_count++;
+        script->stats.run_time_us += run_time_us;
+        script->stats.max_run_time_us = MAX(script->stats.max_run_time_us, run_time_us);
+        script->stats.vm_instructions += instructions;
+        if (run_mem > 0) {
+            script->stats.alloc_bytes += run_mem;
+        }
+        total_run_time_us += run_time_us;
+    }
+
+    const int32_t quota = _vm_quota.get();
+    if (quota <= 0) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - script->quota_window_start_ms >= QUOTA_WINDOW_MS) {
+        script->quota_window_start_ms = now_ms;
+        script->quota_window_instructions = 0;
+    }
+    script->quota_window_instructions += instructions;
+    if (script->quota_window_instructions > uint32_t(quota)) {
+        const uint64_t window_end_ms = AP_HAL::millis64() + (QUOTA_WINDOW_MS - (now_ms - script->quota_window_start_ms));
+        if (script->next_run_ms < window_end_ms) {
+            script->next_run_ms = window_end_ms;
+            script->stats.throttle_count++;
+        }
+    }
+}
+
+// display per-script statistics as text buffer for @SYS/scripts.txt
+void lua_scripts::scripts_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("ScriptsV1\n");
+
+    WITH_SEMAPHORE(queue_sem);
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const float total_time = MAX(total_run_time_us, 1U);
+    for (uint16_t i = 0; i <= run_queue_len; i++) {
+        const script_info *script = (i < run_queue_len) ? run_queue[i] : running_script;
+        if (script == nullptr) {
+            continue;
+        }
+        const char *name = strrchr(script->name, '/');
+        name = (name != nullptr) ? name + 1 : script->name;
+        const uint32_t runs = MAX(script->stats.run_count, 1U);
+        const float loaded_s = MAX((now_ms - script->stats.loaded_ms) * 0.001f, 0.001f);
+        str.printf("%-24.24s RUN=%6u AVG=%5u MAX=%6u CPU=%5.1f%% VMI=%7u ALLOC=%6.1fkB/s THR=%4u\n",
+                   name,
+                   unsigned(script->stats.run_count),
+                   unsigned(script->stats.run_time_us / runs),
+                   unsigned(script->stats.max_run_time_us),
+                   script->stats.run_time_us * 100.0f / total_time,
+                   unsigned(script->stats.vm_instructions / runs),
+                   script->stats.alloc_bytes / (1024.0f * loaded_s),
+                   unsigned(MIN(script->stats.throttle_count, 9999U)));
+    }
+}
+
 void lua_scripts::hook(lua_State *L, lua_Debug *ar) {
     lua_scripts::overtime = true;
 
@@ -213,6 +289,11 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     new_script->env_ref = luaL_ref(L, LUA_REGISTRYINDEX); // store reference to script's environment
     new_script->run_ref = luaL_ref(L, LUA_REGISTRYINDEX); // store reference to function to run
     new_script->next_run_ms = AP_HAL::millis64() - 1; // force the script to be stale
+    new_script->queue_index = NOT_QUEUED;
+    new_script->stats = {};
+    new_script->stats.loaded_ms = AP_HAL::millis();
+    new_script->quota_window_start_ms = new_script->stats.loaded_ms;
+    new_script->quota_window_instructions = 0;
 
     // Get checksum of file
     uint32_t crc = 0;
@@ -302,7 +383,11 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
             _heap.deallocate(filename);
             continue;
         }
-        reschedule_script(script);
+        if (!reschedule_script(script)) {
+            set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Insufficent memory scheduling %s", filename);
+            remove_script(L, script);
+            continue;
+        }
 
 #if HAL_LOGGER_FILE_CONTENTS_ENABLED
         if (!option_is_set(AP_Scripting::DebugOption::SUPPRESS_SCRIPT_LOG)) {
@@ -321,7 +406,8 @@ void lua_scripts::reset_loop_overtime(lua_State *L) {
 }
 
 void lua_scripts::run_next_script(lua_State *L) {
-    if (scripts == nullptr) {
+    script_info *script = peek_next_script();
+    if (script == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         AP_HAL::panic("Lua: Attempted to run a script without any scripts queued");
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -329,9 +415,12 @@ void lua_scripts::run_next_script(lua_State *L) {
     }
 
     uint64_t start_time_ms = AP_HAL::millis64();
-    // strip the selected script out of the list
-    script_info *script = scripts;
-    scripts = script->next;
+    // strip the selected script out of the queue
+    {
+        WITH_SEMAPHORE(queue_sem);
+        queue_remove(script);
+        running_script = script;
+    }
 
     // reset the hook to clear the counter
     reset_loop_overtime(L);
@@ -344,7 +433,20 @@ void lua_scripts::run_next_script(lua_State *L) {
     // set current environment for other users
     AP::scripting()->set_current_env_ref(script->env_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    const int start_mem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    const uint32_t start_us = AP_HAL::micros();
+
+    const int result = lua_pcall(L, 0, LUA_MULTRET, 0);
+
+    const uint32_t run_time_us = AP_HAL::micros() - start_us;
+    const int end_mem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    // the count hook counts down from the base count, on overtime the full allowance was used
+    const uint32_t instructions = overtime ? uint32_t(L->basehookcount) : uint32_t(L->basehookcount - L->hookcount);
+
+    update_stats(script->name, run_time_us, end_mem, end_mem - start_mem);
+    accumulate_stats(script, run_time_us, end_mem - start_mem, instructions);
+
+    if (result) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s exceeded time limit", script->name);
@@ -378,12 +480,16 @@ void lua_scripts::run_next_script(lua_State *L) {
                     }
 
                     // types match the expectations, go ahead and reschedule
-                    script->next_run_ms = start_time_ms + (uint64_t)luaL_checknumber(L, -1);
+                    // the quota may already have deferred the script past the requested time
+                    script->next_run_ms = MAX(script->next_run_ms, start_time_ms + (uint64_t)luaL_checknumber(L, -1));
                     lua_pop(L, 1);
                     int old_ref = script->run_ref;
                     script->run_ref = luaL_ref(L, LUA_REGISTRYINDEX);
                     luaL_unref(L, LUA_REGISTRYINDEX, old_ref);
-                    reschedule_script(script);
+                    if (!reschedule_script(script)) {
+                        set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Insufficent memory scheduling %s", script->name);
+                        remove_script(L, script);
+                    }
                     break;
                 }
             default:
@@ -403,17 +509,14 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
         return;
     }
 
-    // ensure that the script isn't in the loaded list for any reason
-    if (scripts == nullptr) {
-        // nothing to do, already not in the list
-    } else if (scripts == script) {
-        scripts = script->next;
-    } else {
-        for(script_info * current = scripts; current->next != nullptr; current = current->next) {
-            if (current->next == script) {
-                current->next = script->next;
-                break;
-            }
+    {
+        // ensure that the script isn't in the run queue for any reason
+        WITH_SEMAPHORE(queue_sem);
+        if (script->queue_index != NOT_QUEUED) {
+            queue_remove(script);
+        }
+        if (running_script == script) {
+            running_script = nullptr;
         }
     }
 
@@ -432,39 +535,91 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
     _heap.deallocate(script);
 }
 
-void lua_scripts::reschedule_script(script_info *script) {
+bool lua_scripts::reschedule_script(script_info *script) {
     if (script == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
        AP_HAL::panic("Lua: Attempted to schedule a null pointer");
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
-       return;
+       return false;
     }
 
-    script->next = nullptr;
-    if (scripts == nullptr) {
-        scripts = script;
-        return;
+    WITH_SEMAPHORE(queue_sem);
+
+    if (run_queue_len >= run_queue_size) {
+        // grow the queue, this normally only happens while loading scripts
+        const uint16_t new_size = MAX(run_queue_size * 2, 8);
+        script_info **new_queue = (script_info **)_heap.change_size(run_queue,
+                                                                    run_queue_size * sizeof(script_info *),
+                                                                    new_size * sizeof(script_info *));
+        if (new_queue == nullptr) {
+            return false;
+        }
+        run_queue = new_queue;
+        run_queue_size = new_size;
     }
 
-    uint64_t next_run_ms = script->next_run_ms;
+    if (running_script == script) {
+        running_script = nullptr;
+    }
+    queue_set(run_queue_len, script);
+    run_queue_len++;
+    queue_sift_up(script->queue_index);
+    return true;
+}
 
-    if (scripts->next_run_ms > next_run_ms) {
-        script->next = scripts;
-        scripts = script;
+// remove a script from anywhere in the run queue
+void lua_scripts::queue_remove(script_info *script) {
+    const uint16_t idx = script->queue_index;
+    if (idx >= run_queue_len || run_queue[idx] != script) {
+#if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
+        AP_HAL::panic("Lua: Attempted to remove a script that is not queued");
+#endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         return;
     }
+    script->queue_index = NOT_QUEUED;
+    run_queue_len--;
+    if (idx == run_queue_len) {
+        // was the last entry
+        return;
+    }
+    // move the last entry into the hole and restore the heap order
+    script_info *moved = run_queue[run_queue_len];
+    queue_set(idx, moved);
+    queue_sift_up(idx);
+    queue_sift_down(moved->queue_index);
+}
 
-    script_info *previous = scripts;
-    while (previous->next != nullptr) {
-        if (previous->next->next_run_ms > next_run_ms) {
-            script->next = previous->next;
-            previous->next = script;
-            return;
+void lua_scripts::queue_sift_up(uint16_t idx) {
+    script_info *script = run_queue[idx];
+    while (idx > 0) {
+        const uint16_t parent = (idx - 1) / 2;
+        if (run_queue[parent]->next_run_ms <= script->next_run_ms) {
+            break;
         }
-        previous = previous->next;
+        queue_set(idx, run_queue[parent]);
+        idx = parent;
     }
+    queue_set(idx, script);
+}
 
-    previous->next = script;
+void lua_scripts::queue_sift_down(uint16_t idx) {
+    script_info *script = run_queue[idx];
+    while (true) {
+        const uint32_t left = 2 * uint32_t(idx) + 1;
+        if (left >= run_queue_len) {
+            break;
+        }
+        uint16_t child = left;
+        if (left + 1 < run_queue_len && run_queue[left + 1]->next_run_ms < run_queue[left]->next_run_ms) {
+            child = left + 1;
+        }
+        if (script->next_run_ms <= run_queue[child]->next_run_ms) {
+            break;
+        }
+        queue_set(idx, run_queue[child]);
+        idx = child;
+    }
+    queue_set(idx, script);
 }
 
 MultiHeap lua_scripts::_heap;
@@ -490,11 +645,11 @@ void lua_scripts::run(void) {
         if (lua_state != nullptr) {
             lua_close(lua_state); // shutdown the old state
         }
-        // remove all the old scheduled scripts
-        for (script_info *script = scripts; script != nullptr; script = scripts) {
+        // remove all the old scheduled scripts, including any that was running when we panicked
+        remove_script(nullptr, running_script);
+        for (script_info *script = peek_next_script(); script != nullptr; script = peek_next_script()) {
             remove_script(nullptr, script);
         }
-        scripts = nullptr;
         overtime = false;
     }
 
@@ -558,55 +713,40 @@ void lua_scripts::run(void) {
         }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
-        if (scripts != nullptr) {
+        script_info *next_script = peek_next_script();
+        if (next_script != nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
-              // Sanity check that the scripts list is ordered correctly
-              script_info *sanity = scripts;
-              while (sanity->next != nullptr) {
-                  if (sanity->next_run_ms > sanity->next->next_run_ms) {
-                      AP_HAL::panic("Lua: Script tasking order has been violated");
-                  }
-                  sanity = sanity->next;
-              }
+            // Sanity check that the run queue is heap ordered
+            for (uint16_t i = 1; i < run_queue_len; i++) {
+                if (run_queue[(i - 1) / 2]->next_run_ms > run_queue[i]->next_run_ms) {
+                    AP_HAL::panic("Lua: Script tasking order has been violated");
+                }
+            }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
             // compute delay time
             uint64_t now_ms = AP_HAL::millis64();
-            if (now_ms < scripts->next_run_ms) {
-                hal.scheduler->delay(scripts->next_run_ms - now_ms);
+            if (now_ms < next_script->next_run_ms) {
+                hal.scheduler->delay(next_script->next_run_ms - now_ms);
             }
 
             if (option_is_set(AP_Scripting::DebugOption::RUNTIME_MSG)) {
-                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", scripts->name);
+                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", next_script->name);
             }
-            // take a copy of the script name for the purposes of
-            // logging statistics.  "scripts" may become invalid
-            // during the "run_next_script" call, below.
-            char script_name[128+1] {};
-            strncpy_noterm(script_name, scripts->name, 128);
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             void *istate = hal.scheduler->disable_interrupts_save();
 #endif
 
-            const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-            const uint32_t loadEnd = AP_HAL::micros();
-
-            // NOTE!  the base pointer of our scripts linked list,
-            // *and all its contents* may become invalid as part of
-            // "run_next_script"!  So do *NOT* attempt to access
-            // anything that was in *scripts after this call.
+            // NOTE!  the script at the head of the run queue may be
+            // freed as part of "run_next_script"!  So do *NOT*
+            // attempt to access next_script after this call.
             run_next_script(L);
 
-            const uint32_t runEnd = AP_HAL::micros();
-            const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             hal.scheduler->restore_interrupts(istate);
 #endif
 
-            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem);
-
 
             // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
             lua_gc(L, LUA_GCCOLLECT, 0);
@@ -639,8 +779,14 @@ void lua_scripts::run(void) {
     }
 
     // make sure all scripts have been removed
-    while (scripts != nullptr) {
-        remove_script(lua_state, scripts);
+    while (peek_next_script() != nullptr) {
+        remove_script(lua_state, peek_next_script());
+    }
+    {
+        WITH_SEMAPHORE(queue_sem);
+        _heap.deallocate(run_queue);
+        run_queue = nullptr;
+        run_queue_size = 0;
     }
 
     if (lua_state != nullptr) {
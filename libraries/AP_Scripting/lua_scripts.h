@@ -29,12 +29,14 @@
 #include <AP_MultiHeap/AP_MultiHeap.h>
 #include "lua_common_defs.h"
 
+class ExpandingString;
+
 #include "lua/src/lua.hpp"
 
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &vm_quota, const AP_Int32 &heap_size, AP_Int8 &debug_options);
 
     ~lua_scripts();
 
@@ -48,6 +50,9 @@ public:
 
     static bool overtime; // script exceeded it's execution slot, and we are bailing out
 
+    // display per-script statistics as text buffer for @SYS/scripts.txt
+    void scripts_info(ExpandingString &str);
+
 private:
 
     void create_sandbox(lua_State *L);
@@ -58,9 +63,27 @@ private:
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        uint32_t crc;         // crc32 checksum
        char *name;           // filename for the script // FIXME: This information should be available from Lua
-       script_info *next;
+       uint16_t queue_index; // index in the run queue, NOT_QUEUED if not scheduled
+
+       // cumulative statistics, always collected
+       struct {
+           uint64_t run_time_us;    // total time spent running
+           uint64_t vm_instructions; // total VM instructions executed
+           uint64_t alloc_bytes;    // total memory growth over all runs
+           uint32_t loaded_ms;      // time the script was loaded
+           uint32_t run_count;      // number of times the script has been run
+           uint32_t max_run_time_us; // worst case single run time
+           uint32_t throttle_count; // number of times the instruction quota deferred a run
+       } stats;
+
+       // instruction quota accounting
+       uint32_t quota_window_start_ms;
+       uint32_t quota_window_instructions;
     } script_info;
 
+    static constexpr uint16_t NOT_QUEUED = UINT16_MAX;
+    static constexpr uint32_t QUOTA_WINDOW_MS = 1000;
+
     script_info *load_script(lua_State *L, char *filename);
 
     void reset_loop_overtime(lua_State *L);
@@ -71,10 +94,30 @@ private:
 
     void remove_script(lua_State *L, script_info *script);
 
-    // reschedule the script for execution. It is assumed the script is not in the list already
-    void reschedule_script(script_info *script);
+    // reschedule the script for execution. It is assumed the script is not in the queue already
+    // returns false if the queue could not be expanded to hold the script
+    bool reschedule_script(script_info *script);
+
+    // run queue, a binary min-heap of scripts ordered by next run time (soonest at index 0)
+    script_info **run_queue;
+    uint16_t run_queue_len;
+    uint16_t run_queue_size;
+    script_info *running_script; // script currently being run, not in the queue
+
+    script_info *peek_next_script(void) const { return run_queue_len > 0 ? run_queue[0] : nullptr; }
+    void queue_remove(script_info *script);
+    void queue_sift_up(uint16_t idx);
+    void queue_sift_down(uint16_t idx);
+    void queue_set(uint16_t idx, script_info *script) {
+        run_queue[idx] = script;
+        script->queue_index = idx;
+    }
+
+    // protects the run queue and script statistics for readers outside the scripting thread
+    HAL_Semaphore queue_sem;
 
-    script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
+    // total time spent running all scripts, used for CPU share
+    uint64_t total_run_time_us;
 
     // hook will be run when CPU time for a script is exceeded
     // it must be static to be passed to the C API
@@ -87,6 +130,7 @@ private:
     lua_State *lua_state;
 
     const AP_Int32 & _vm_steps;
+    const AP_Int32 & _vm_quota;
     AP_Int8 & _debug_options;
 
     bool option_is_set(AP_Scripting::DebugOption option) const {
@@ -100,6 +144,9 @@ private:
     // helper for print and log of runtime stats
     void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
 
+    // accumulate always-on statistics and apply the instruction quota
+    void accumulate_stats(script_info *script, uint32_t run_time_us, int run_mem, uint32_t instructions);
+
     // must be static for use in atpanic
     static void print_error(MAV_SEVERITY severity);
     static char *error_msg_buf;
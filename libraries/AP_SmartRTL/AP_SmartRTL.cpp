@@ -31,7 +31,7 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
     // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Range: 0 1000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -62,7 +62,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    points when their line segments get close. This algorithm will never
 *    compare two consecutive line segments. Obviously the segments (p1,p2) and
 *    (p2,p3) will get very close (they touch), but there would be nothing to
-*    trim between them.
+*    trim between them. Segments are kept in a grid index so each segment is
+*    only compared with the segments that pass through nearby grid cells.
 *
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
 *    for a more complete description.
@@ -115,16 +116,30 @@ void AP_SmartRTL::init()
     _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
     _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
 
+    _index.buckets = (uint16_t*)calloc(SMARTRTL_INDEX_BUCKETS, sizeof(uint16_t));
+    _index.entries_max = _points_max * SMARTRTL_INDEX_ENTRIES_MULT;
+    _index.entries = (index_entry_t*)calloc(_index.entries_max, sizeof(index_entry_t));
+    _index.long_segments = (uint16_t*)calloc(_points_max, sizeof(uint16_t));
+
     // check if memory allocation failed
-    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
+    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr ||
+        _index.buckets == nullptr || _index.entries == nullptr || _index.long_segments == nullptr) {
         log_action(Action::DEACTIVATED_INIT_FAILED);
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
         free(_path);
         free(_prune.loops);
         free(_simplify.stack);
+        free(_index.buckets);
+        free(_index.entries);
+        free(_index.long_segments);
+        _path = nullptr;
         return;
     }
 
+    // grid cells are large compared to the spacing of points so most segments fall in one or two cells
+    _index.cell_size = _accuracy * SMARTRTL_INDEX_CELL_ACCURACY_MULT;
+    index_reset();
+
     _path_points_max = _points_max;
 
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
@@ -367,6 +382,15 @@ void AP_SmartRTL::run_background_cleanup()
     _path_points_completed_limit = SMARTRTL_POINTS_MAX;
     _path_sem.give();
 
+    // points popped from the path may be replaced by new points, so indexed segments beyond the end can't be trusted
+    if (_index.segments >= path_points_completed_limit) {
+        index_reset();
+    }
+
+#if HAL_LOGGING_ENABLED
+    log_cleanup_stats();
+#endif
+
     // check if thorough cleanup is required
     if (_thorough_clean_request_ms > 0) {
         // check if we have already completed the request
@@ -454,7 +478,13 @@ void AP_SmartRTL::routine_cleanup(uint16_t path_points_count, uint16_t path_poin
 bool AP_SmartRTL::thorough_cleanup(uint16_t path_points_count, ThoroughCleanupType clean_type)
 {
     if (clean_type != THOROUGH_CLEAN_PRUNE_ONLY) {
-        // restart simplify if new points have appeared on path
+        // remove simplified points from path if required. This is done before checking for
+        // new points so that simplifications already found are not thrown away by the restart
+        if (_simplify.complete && _simplify.removal_required) {
+            remove_points_by_simplify_bitmask();
+            return false;
+        }
+        // restart simplify if new points have appeared on path, only the new points are checked
         if (_simplify.complete) {
             restart_simplify_if_new_points(path_points_count);
         }
@@ -463,11 +493,6 @@ bool AP_SmartRTL::thorough_cleanup(uint16_t path_points_count, ThoroughCleanupTy
             detect_simplifications();
             return false;
         }
-        // remove simplified points from path if required
-        if (_simplify.removal_required) {
-            remove_points_by_simplify_bitmask();
-            return false;
-        }
     }
 
     if (clean_type != THOROUGH_CLEAN_SIMPLIFY_ONLY) {
@@ -513,7 +538,9 @@ void AP_SmartRTL::detect_simplifications()
     while (_simplify.stack_count > 0) { // while there is something to do
 
         // if this method has run for long enough, exit
-        if (AP_HAL::micros() - start_time_us > SMARTRTL_SIMPLIFY_TIME_US) {
+        const uint32_t elapsed_us = AP_HAL::micros() - start_time_us;
+        if (elapsed_us > SMARTRTL_SIMPLIFY_TIME_US) {
+            _stats.simplify_us += elapsed_us;
             return;
         }
 
@@ -556,12 +583,14 @@ void AP_SmartRTL::detect_simplifications()
     }
     _simplify.path_points_completed = _simplify.path_points_count;
     _simplify.complete = true;
+    _stats.simplify_us += AP_HAL::micros() - start_time_us;
 }
 
 /**
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
 *   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
 *   to the line segment between any other two sequential points. If they get close enough, anything between them could be pruned.
+*   The segment index limits the comparisons to segments that pass through nearby grid cells.
 *
 *   reset_pruning should have been called at least once before this function is called to setup the indexes (_prune.i, etc)
 */
@@ -576,36 +605,146 @@ void AP_SmartRTL::detect_loops()
     // capture start time
     const uint32_t start_time_us = AP_HAL::micros();
 
+    // bring the index up to date with the points to be checked
+    if (!index_build(start_time_us)) {
+        _stats.prune_us += AP_HAL::micros() - start_time_us;
+        return;
+    }
+
     // run for defined amount of time
     while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
 
-        // advance inner loop
-        _prune.j++;
-        if (_prune.j > _prune.i - 2) {
-            // set inner loop back to first point
-            _prune.j = 1;
-            // reduce outer loop
-            _prune.i--;
-            // complete when outer loop has run out of new points to check
-            if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+        // find the earliest segment that comes close to the segment ending at point i
+        uint16_t j;
+        dist_point dp;
+        if (index_find_loop(_prune.i, j, dp)) {
+            // if there is a loop here, add to loop array
+            if (!add_loop(j, _prune.i-1, dp.midpoint)) {
+                // if the buffer is full, stop trying to prune
                 _prune.complete = true;
-                _prune.path_points_completed = _prune.path_points_count;
-                return;
             }
         }
 
-        // find the closest distance between two line segments and the mid-point
-        dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[_prune.j-1], _path[_prune.j]);
-        if (dp.distance < SMARTRTL_PRUNING_DELTA) {
-            // if there is a loop here, add to loop array
-            if (!add_loop(_prune.j, _prune.i-1, dp.midpoint)) {
-                // if the buffer is full, stop trying to prune
-                _prune.complete = true;
+        // move to the previous segment, working back from the end of the path
+        _prune.i--;
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            break;
+        }
+    }
+    _stats.prune_us += AP_HAL::micros() - start_time_us;
+}
+
+// returns the range of grid cells covered by the horizontal bounding box of segment n, grown by margin meters
+void AP_SmartRTL::index_cells(uint16_t segment, float margin, int32_t &x_min, int32_t &y_min, int32_t &x_max, int32_t &y_max) const
+{
+    const Vector3f &p1 = _path[segment-1];
+    const Vector3f &p2 = _path[segment];
+    const float inv_size = 1.0f / _index.cell_size;
+    x_min = floorf((MIN(p1.x, p2.x) - margin) * inv_size);
+    y_min = floorf((MIN(p1.y, p2.y) - margin) * inv_size);
+    x_max = floorf((MAX(p1.x, p2.x) + margin) * inv_size);
+    y_max = floorf((MAX(p1.y, p2.y) + margin) * inv_size);
+}
+
+// hash bucket holding a grid cell
+uint16_t AP_SmartRTL::index_bucket(int32_t x, int32_t y)
+{
+    return ((uint32_t(x) * 73856093U) ^ (uint32_t(y) * 19349663U)) & (SMARTRTL_INDEX_BUCKETS - 1);
+}
+
+// add segments to the index until it covers all segments up to the last path point checked for loops
+// returns false if it ran out of time
+bool AP_SmartRTL::index_build(uint32_t start_time_us)
+{
+    while (_index.segments + 1 < _prune.path_points_count) {
+        if (AP_HAL::micros() - start_time_us > SMARTRTL_PRUNING_LOOP_TIME_US) {
+            return false;
+        }
+        const uint16_t segment = ++_index.segments;
+
+        int32_t x_min, y_min, x_max, y_max;
+        index_cells(segment, 0.0f, x_min, y_min, x_max, y_max);
+        const uint32_t num_cells = uint32_t(x_max - x_min + 1) * uint32_t(y_max - y_min + 1);
+
+        // long segments, and any that don't fit in the entries pool, are checked against every segment
+        if (num_cells > SMARTRTL_INDEX_SEGMENT_CELLS_MAX || _index.entries_count + num_cells > _index.entries_max) {
+            _index.long_segments[_index.long_count++] = segment;
+            continue;
+        }
+
+        for (int32_t x = x_min; x <= x_max; x++) {
+            for (int32_t y = y_min; y <= y_max; y++) {
+                const uint16_t bucket = index_bucket(x, y);
+                _index.entries[_index.entries_count] = index_entry_t {segment, _index.buckets[bucket]};
+                _index.buckets[bucket] = _index.entries_count++;
             }
-            // set inner loop forward to trigger outer loop move to next segment
-            _prune.j = _prune.i;
         }
     }
+    return true;
+}
+
+// forget all indexed segments, called whenever points are removed from the path
+void AP_SmartRTL::index_reset()
+{
+    for (uint16_t i = 0; i < SMARTRTL_INDEX_BUCKETS; i++) {
+        _index.buckets[i] = INDEX_NONE;
+    }
+    _index.entries_count = 0;
+    _index.long_count = 0;
+    _index.segments = 0;
+}
+
+// find the lowest numbered segment before segment i-1 that comes within SMARTRTL_PRUNING_DELTA of segment i
+// segment i runs from point i-1 to point i. Returns the same loop as a search of every earlier segment would
+bool AP_SmartRTL::index_find_loop(uint16_t i, uint16_t &j, dist_point &dp)
+{
+    const Vector3f &p1 = _path[i];
+    const Vector3f &p2 = _path[i-1];
+    uint16_t best = i - 1;
+
+    // compare segment i with candidate segment n, keeping the earliest loop
+    auto check = [&](uint16_t n) {
+        if (n >= best) {
+            // consecutive segments always touch, and we already have an earlier loop
+            return;
+        }
+        _stats.comparisons++;
+        const dist_point candidate = segment_segment_dist(p1, p2, _path[n-1], _path[n]);
+        if (candidate.distance < SMARTRTL_PRUNING_DELTA) {
+            best = n;
+            dp = candidate;
+        }
+    };
+
+    int32_t x_min, y_min, x_max, y_max;
+    index_cells(i, SMARTRTL_PRUNING_DELTA, x_min, y_min, x_max, y_max);
+    const uint32_t num_cells = uint32_t(x_max - x_min + 1) * uint32_t(y_max - y_min + 1);
+    if (num_cells > SMARTRTL_INDEX_SEGMENT_CELLS_MAX) {
+        // a long segment is compared with everything
+        for (uint16_t n = 1; n < best; n++) {
+            check(n);
+        }
+    } else {
+        for (int32_t x = x_min; x <= x_max; x++) {
+            for (int32_t y = y_min; y <= y_max; y++) {
+                for (uint16_t e = _index.buckets[index_bucket(x, y)]; e != INDEX_NONE; e = _index.entries[e].next) {
+                    check(_index.entries[e].segment);
+                }
+            }
+        }
+        for (uint16_t l = 0; l < _index.long_count; l++) {
+            check(_index.long_segments[l]);
+        }
+    }
+
+    if (best >= i - 1) {
+        return false;
+    }
+    j = best;
+    return true;
 }
 
 // restart simplify if new points have been added to path
@@ -649,7 +788,6 @@ void AP_SmartRTL::restart_pruning(uint16_t path_points_count)
 {
     _prune.complete = false;
     _prune.i = (path_points_count > 0) ? path_points_count - 1 : 0;
-    _prune.j = 0;
     _prune.path_points_count = path_points_count;
 }
 
@@ -659,6 +797,7 @@ void AP_SmartRTL::reset_pruning()
     restart_pruning(0);
     _prune.loops_count = 0; // clear the loops that we've recorded
     _prune.path_points_completed = 0;
+    index_reset();
 }
 
 // remove all simplify-able points from the path
@@ -680,6 +819,11 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
         }
     }
 
+    if (removed > 0) {
+        index_reset();
+        _stats.removed += removed;
+    }
+
     // reduce count of the number of points simplified
     if (_path_points_count > removed && _simplify.path_points_count > removed) {
         _path_points_count -= removed;
@@ -754,6 +898,11 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         _prune.loops_count--;
     }
 
+    if (removed_points > 0) {
+        index_reset();
+        _stats.removed += removed_points;
+    }
+
     _path_sem.give();
     return true;
 }
@@ -877,6 +1026,51 @@ void AP_SmartRTL::log_action(Action action, const Vector3f &point) const
         AP::logger().Write_SRTL(_active, _path_points_count, _path_points_max, action, point);
     }
 }
+
+// log cleanup backlog statistics at 1hz
+void AP_SmartRTL::log_cleanup_stats()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _stats.last_log_ms < 1000) {
+        return;
+    }
+    _stats.last_log_ms = now_ms;
+
+    if (!_example_mode) {
+        const uint16_t path_points_count = _path_points_count;
+        const uint16_t simplify_backlog = (path_points_count > _simplify.path_points_completed) ? path_points_count - _simplify.path_points_completed : 0;
+        const uint16_t prune_backlog = (_simplify.path_points_completed > _prune.path_points_completed) ? _simplify.path_points_completed - _prune.path_points_completed : 0;
+
+// @LoggerMessage: SRTC
+// @Description: SmartRTL background cleanup statistics
+// @Field: TimeUS: Time since system startup
+// @Field: N: number of points on the path
+// @Field: Max: maximum number of points on the path
+// @Field: SBk: points not yet checked for simplification
+// @Field: PBk: simplified points not yet checked for loops
+// @Field: Lps: loops found and waiting to be pruned
+// @Field: SUs: time spent detecting simplifications in the last second
+// @Field: PUs: time spent detecting loops in the last second
+// @Field: Cmp: segment comparisons made by loop detection in the last second
+// @Field: Rem: points removed from the path in the last second
+        AP::logger().Write("SRTC", "TimeUS,N,Max,SBk,PBk,Lps,SUs,PUs,Cmp,Rem", "s-----ss--", "F-----FF--", "QHHHHHIIIH",
+                           AP_HAL::micros64(),
+                           path_points_count,
+                           _path_points_max,
+                           simplify_backlog,
+                           prune_backlog,
+                           _prune.loops_count,
+                           _stats.simplify_us,
+                           _stats.prune_us,
+                           _stats.comparisons,
+                           _stats.removed);
+    }
+
+    _stats.simplify_us = 0;
+    _stats.prune_us = 0;
+    _stats.comparisons = 0;
+    _stats.removed = 0;
+}
 #endif
 
 // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
@@ -7,8 +7,8 @@
 
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
-#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
-#define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 30bytes * this number.
+#define SMARTRTL_POINTS_MAX              1000   // the absolute maximum number of points this library can support.
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -21,6 +21,10 @@
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_INDEX_BUCKETS           256    // number of hash buckets in the segment index used by loop detection, must be a power of two
+#define SMARTRTL_INDEX_CELL_ACCURACY_MULT 5.0f  // edge length of a segment index grid cell as a multiple of the _ACCURACY parameter
+#define SMARTRTL_INDEX_SEGMENT_CELLS_MAX 16     // segments covering more grid cells than this are kept in a list that is checked against every segment
+#define SMARTRTL_INDEX_ENTRIES_MULT      2      // segment index entries as compared to maximum number of points
 
 class AP_SmartRTL {
 
@@ -90,6 +94,8 @@ public:
 
 private:
 
+    friend class AP_SmartRTL_Test;
+
     // enums for logging latest actions
     enum Action : uint8_t {
         POINT_ADD = 0,
@@ -170,6 +176,25 @@ private:
     // get the closest distance between 2 line segments and the point midway between the closest points
     static dist_point segment_segment_dist(const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, const Vector3f& p4);
 
+    // segment index. Segment n is the line from path point n-1 to point n
+    // returns the range of grid cells covered by the horizontal bounding box of segment n, grown by margin meters
+    void index_cells(uint16_t segment, float margin, int32_t &x_min, int32_t &y_min, int32_t &x_max, int32_t &y_max) const;
+    // hash bucket holding a grid cell
+    static uint16_t index_bucket(int32_t x, int32_t y);
+    // add segments to the index until it covers all segments up to the last path point checked for loops
+    // returns false if it ran out of time
+    bool index_build(uint32_t start_time_us);
+    // forget all indexed segments, called whenever points are removed from the path
+    void index_reset();
+    // find the lowest numbered segment before segment i-1 that comes within SMARTRTL_PRUNING_DELTA of segment i
+    // returns false if there is none
+    bool index_find_loop(uint16_t i, uint16_t &j, dist_point &dp);
+
+#if HAL_LOGGING_ENABLED
+    // log cleanup backlog statistics at 1hz
+    void log_cleanup_stats();
+#endif
+
     // de-activate SmartRTL, send warning to GCS and logger
     void deactivate(Action action, const char *reason);
 
@@ -231,8 +256,7 @@ private:
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
         uint16_t path_points_completed; // number of points in that path that have already been checked for loops and should be ignored
-        uint16_t i;     // loop search's outer loop index
-        uint16_t j;     // loop search's inner loop index
+        uint16_t i;     // loop search's outer loop index, the last point of the next segment to be checked
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
@@ -240,4 +264,31 @@ private:
 
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
     bool loops_overlap(const prune_loop_t& loop1, const prune_loop_t& loop2) const;
+
+    // Segment index
+    // a horizontal grid hashed into buckets so loop detection only compares segments that are close to each other
+    static const uint16_t INDEX_NONE = UINT16_MAX;
+    typedef struct {
+        uint16_t segment;       // segment number
+        uint16_t next;          // next entry in the same bucket or INDEX_NONE
+    } index_entry_t;
+    struct {
+        uint16_t* buckets;      // first entry in each bucket or INDEX_NONE
+        index_entry_t* entries; // pool of bucket entries
+        uint16_t entries_max;   // maximum number of elements in the entries array
+        uint16_t entries_count; // number of elements in the entries array
+        uint16_t* long_segments;// segments that cover too many cells (or did not fit in entries)
+        uint16_t long_count;    // number of elements in the long_segments array
+        uint16_t segments;      // segments 1 to this number have been indexed
+        float cell_size;        // grid cell edge length in meters
+    } _index;
+
+    // cleanup statistics, accumulated by the background thread and logged at 1hz
+    struct {
+        uint32_t last_log_ms;   // system time of last log
+        uint32_t simplify_us;   // time spent detecting simplifications since last log
+        uint32_t prune_us;      // time spent detecting loops since last log
+        uint32_t comparisons;   // segment comparisons made by loop detection since last log
+        uint16_t removed;       // points removed since last log
+    } _stats;
 };
@@ -0,0 +1,114 @@
+#include <AP_gtest.h>
+
+#include <AP_SmartRTL/AP_SmartRTL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// like the vehicles, rely on static storage to zero the path state
+static AP_SmartRTL smart_rtl{true};
+
+/*
+  check that loop detection using the segment index finds exactly the
+  loops found by comparing each segment with every earlier segment
+ */
+class AP_SmartRTL_Test : public ::testing::Test {
+protected:
+    AP_SmartRTL &srtl = smart_rtl;
+    typedef AP_SmartRTL::dist_point dist_point;
+
+    void SetUp() override {
+        srtl._points_max.set(SMARTRTL_POINTS_MAX);
+        srtl.init();
+        ASSERT_NE(srtl._path, nullptr);
+    }
+
+    // simple deterministic random number generator
+    uint32_t seed;
+    float rand_float(float min, float max) {
+        seed = seed * 1664525U + 1013904223U;
+        return min + (max - min) * ((seed >> 8) / float(1U << 24));
+    }
+
+    // fill the path with a random walk that keeps crossing itself within a
+    // small area, with the occasional long leg that doesn't fit in the grid
+    void make_path(uint32_t path_seed) {
+        seed = path_seed;
+        const float accuracy = srtl._accuracy;
+        Vector3f pos;
+        float heading = 0;
+        for (uint16_t i = 0; i < SMARTRTL_POINTS_MAX; i++) {
+            if (i % 97 == 96) {
+                heading = rand_float(-M_PI, M_PI);
+                pos += Vector3f{cosf(heading), sinf(heading), 0} * rand_float(40, 80);
+            } else {
+                heading += rand_float(-0.6, 0.6);
+                pos += Vector3f{cosf(heading), sinf(heading), rand_float(-0.2, 0.2)} * rand_float(accuracy, 2 * accuracy);
+            }
+            // turn back towards the start when wandering too far away
+            if (pos.xy().length() > 40 && (pos.x * cosf(heading) + pos.y * sinf(heading)) > 0) {
+                heading += M_PI;
+            }
+            srtl._path[i] = pos;
+        }
+        srtl._path_points_count = SMARTRTL_POINTS_MAX;
+        srtl._prune.path_points_count = SMARTRTL_POINTS_MAX;
+    }
+
+    void build_index() {
+        srtl.index_reset();
+        while (!srtl.index_build(AP_HAL::micros())) {
+        }
+    }
+
+    bool index_find_loop(uint16_t i, uint16_t &j, dist_point &dp) {
+        return srtl.index_find_loop(i, j, dp);
+    }
+
+    // the search the index replaces, the earliest segment before segment i-1
+    // that comes within SMARTRTL_PRUNING_DELTA of segment i
+    bool brute_force_find_loop(uint16_t i, uint16_t &j, dist_point &dp) {
+        for (j = 1; j <= i - 2; j++) {
+            dp = AP_SmartRTL::segment_segment_dist(srtl._path[i], srtl._path[i-1], srtl._path[j-1], srtl._path[j]);
+            if (dp.distance < srtl._accuracy * 0.99) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint16_t long_segments() const { return srtl._index.long_count; }
+};
+
+TEST_F(AP_SmartRTL_Test, IndexMatchesBruteForce)
+{
+    uint32_t loops = 0;
+    uint32_t long_count = 0;
+    for (uint32_t path_seed = 1; path_seed <= 40; path_seed++) {
+        make_path(path_seed);
+        build_index();
+        long_count += long_segments();
+
+        for (uint16_t i = SMARTRTL_POINTS_MAX - 1; i >= 4; i--) {
+            uint16_t j_index = 0, j_brute = 0;
+            dist_point dp_index {}, dp_brute {};
+            const bool found_index = index_find_loop(i, j_index, dp_index);
+            const bool found_brute = brute_force_find_loop(i, j_brute, dp_brute);
+            ASSERT_EQ(found_brute, found_index) << "seed " << path_seed << " segment " << i;
+            if (!found_brute) {
+                continue;
+            }
+            loops++;
+            ASSERT_EQ(j_brute, j_index) << "seed " << path_seed << " segment " << i;
+            EXPECT_FLOAT_EQ(dp_brute.distance, dp_index.distance);
+            EXPECT_FLOAT_EQ(dp_brute.midpoint.x, dp_index.midpoint.x);
+            EXPECT_FLOAT_EQ(dp_brute.midpoint.y, dp_index.midpoint.y);
+            EXPECT_FLOAT_EQ(dp_brute.midpoint.z, dp_index.midpoint.z);
+        }
+    }
+
+    // the paths must exercise both the grid and the long segment list
+    EXPECT_GT(loops, 1000U);
+    EXPECT_GT(long_count, 0U);
+}
+
+AP_GTEST_MAIN()
@@ -448,6 +448,14 @@ public:
       allow forwarding of packets / heartbeats to be blocked as required by some components to reduce traffic
     */
     static void disable_channel_routing(mavlink_channel_t chan) { routing.no_route_mask |= (1U<<(chan-MAVLINK_COMM_0)); }
+
+    // routing table and forwarding statistics, for @SYS/routes.txt
+    static void routing_info(ExpandingString &str) { routing.routing_info(str); }
+
+#if AP_MAVLINK_FTP_ENABLED
+    // FTP sessions and throughput, for @SYS/ftp.txt
+    static void ftp_info(ExpandingString &str);
+#endif
     
     /*
       search for a component in the routing table with given mav_type and retrieve it's sysid, compid and channel
@@ -1029,15 +1037,61 @@ private:
         Write,
     };
 
+    struct ftp_session {
+        int fd = -1;
+        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
+        uint8_t session;
+        uint8_t sysid;
+        uint8_t compid;
+        mavlink_channel_t chan;
+        uint32_t last_activity_ms;
+
+        // read-ahead buffer holding file data from buf_offset
+        uint8_t *buf;
+        uint32_t buf_offset;
+        uint16_t buf_len;
+
+        // burst read being streamed by ftp_burst_service()
+        struct {
+            bool active;
+            uint32_t offset;           // file offset of the next packet
+            uint16_t remaining;        // packets left in this burst
+            uint16_t seq_number;
+            uint8_t max_read;
+            uint32_t next_send_us;
+            uint32_t highest_offset;   // end of the data sent, to spot re-requests
+            bool lost;                 // data re-requested during this burst
+        } burst;
+
+        // pacing on links without flow control in bytes/s, 0 when
+        // the link can take data as fast as we can send it
+        uint32_t rate_bps;
+        uint32_t link_bps;
+
+        // throughput
+        uint32_t open_ms;
+        uint32_t bytes_sent;
+        uint32_t rerequests;
+    };
+
     struct ftp_state {
         ObjectBuffer<pending_ftp> *requests;
 
-        // session specific info, currently only support a single session over all links
-        int fd = -1;
-        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
-        int16_t current_session;
+        // reply being built by ftp_burst_service(), kept off the FTP
+        // thread stack which already holds the worker's request and reply
+        pending_ftp *burst_reply;
+
+        ftp_session sessions[AP_MAVLINK_FTP_MAX_SESSIONS];
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+
+        // the last completed read, for @SYS/ftp.txt
+        struct {
+            uint32_t bytes;
+            uint32_t time_ms;
+            uint32_t rerequests;
+        } last_read;
+        uint32_t total_bytes_sent;
     };
     static struct ftp_state ftp;
 
@@ -1045,11 +1099,22 @@ private:
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
 
+    // FTP session management
+    static ftp_session *ftp_find_session(const pending_ftp &request);
+    static bool ftp_session_owned_by_other(const pending_ftp &request);
+    static ftp_session *ftp_open_session(const pending_ftp &request, FTP_FILE_MODE mode);
+    static void ftp_close_session(ftp_session &session);
+    static ssize_t ftp_read(ftp_session &session, uint32_t offset, uint8_t *dest, uint8_t len);
+    static void ftp_start_burst(ftp_session &session, const pending_ftp &request, uint8_t max_read);
+    static void ftp_note_rerequest(ftp_session &session, uint32_t offset);
+
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
     void ftp_push_replies(pending_ftp &reply);
+    bool ftp_try_push_reply(pending_ftp &reply);
+    bool ftp_burst_service(void);
 #endif  // AP_MAVLINK_FTP_ENABLED
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
@@ -1098,6 +1163,9 @@ private:
     DefaultIntervalsFromFiles *default_intervals_from_files;
 #endif
 
+    // parse a block of received bytes, returning the number consumed
+    uint32_t receive_bytes(const uint8_t *data, uint32_t len, uint32_t now_ms, bool &parsed_packet);
+
     // alternative protocol handler support
     struct {
         GCS_MAVLINK::protocol_handler_fn_t handler;
@@ -1898,30 +1898,38 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
     handle_message(msg);
 }
 
-void
-GCS_MAVLINK::update_receive(uint32_t max_time_us)
+/*
+  parse a block of received bytes. Stops after a complete packet has
+  been handled, as handling it may change the port. Returns the number
+  of bytes consumed
+ */
+uint32_t GCS_MAVLINK::receive_bytes(const uint8_t *data, uint32_t len, uint32_t now_ms, bool &parsed_packet)
 {
-    // do absolutely nothing if we are locked
-    if (locked()) {
-        return;
-    }
-
-    // receive new packets
     mavlink_message_t msg;
     mavlink_status_t status;
-    uint32_t tstart_us = AP_HAL::micros();
-    uint32_t now_ms = AP_HAL::millis();
-
     status.packet_rx_drop_count = 0;
 
-    const uint16_t nbytes = _port->available();
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        const uint8_t c = (uint8_t)_port->read();
-        const uint32_t protocol_timeout = 4000;
-        
-        if (alternative.handler &&
-            now_ms - alternative.last_mavlink_ms > protocol_timeout) {
+    const uint32_t protocol_timeout = 4000;
+    parsed_packet = false;
+
+    uint32_t i = 0;
+    while (i < len && !parsed_packet) {
+        const bool try_alternative = alternative.handler &&
+            now_ms - alternative.last_mavlink_ms > protocol_timeout;
+
+        if (!try_alternative) {
+            // payload bytes don't need the byte at a time state machine
+            const uint16_t n = mavlink_frame_payload_span(channel_buffer(), channel_status(),
+                                                          &data[i], MIN(len - i, 0xFFFFU));
+            if (n > 0) {
+                i += n;
+                continue;
+            }
+        }
+
+        const uint8_t c = data[i++];
+
+        if (try_alternative) {
             /*
               we have an alternative protocol handler installed and we
               haven't parsed a MAVLink packet for 4 seconds. Try
@@ -1941,8 +1949,6 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
             }
         }
 
-        bool parsed_packet = false;
-
         // Try to get a new message
         const uint8_t framing = mavlink_frame_char_buffer(channel_buffer(), channel_status(), c, &msg, &status);
         if (framing == MAVLINK_FRAMING_OK) {
@@ -1963,13 +1969,63 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
             }
         }
 #endif // AP_SCRIPTING_ENABLED
+    }
+    return i;
+}
+
+void
+GCS_MAVLINK::update_receive(uint32_t max_time_us)
+{
+    // do absolutely nothing if we are locked
+    if (locked()) {
+        return;
+    }
+
+    // receive new packets
+    uint32_t tstart_us = AP_HAL::micros();
+    uint32_t now_ms = AP_HAL::millis();
 
-        if (parsed_packet || i % 100 == 0) {
+    // check the time budget at least this often when there is no packet
+    const uint32_t check_bytes = 100;
+
+    uint32_t nbytes = _port->available();
+    bool out_of_time = false;
+    while (nbytes > 0 && !out_of_time) {
+        /*
+          parse straight out of the port's receive buffer when the
+          backend supports it, otherwise copy a block out
+         */
+        uint8_t buf[check_bytes];
+        const uint8_t *data;
+        uint32_t n = _port->read_span(data);
+        const bool zero_copy = n > 0;
+        if (zero_copy) {
+            n = MIN(n, nbytes);
+        } else {
+            const ssize_t nread = _port->read(buf, MIN(nbytes, sizeof(buf)));
+            if (nread <= 0) {
+                break;
+            }
+            data = buf;
+            n = nread;
+        }
+
+        uint32_t used = 0;
+        while (used < n) {
+            bool parsed_packet;
+            used += receive_bytes(&data[used], MIN(n - used, check_bytes), now_ms, parsed_packet);
             // make sure we don't spend too much time parsing mavlink messages
-            if (AP_HAL::micros() - tstart_us > max_time_us) {
+            out_of_time = AP_HAL::micros() - tstart_us > max_time_us;
+            if (zero_copy && (parsed_packet || out_of_time)) {
+                // leave the rest in the port, handling a packet
+                // may have changed it
                 break;
             }
         }
+        if (zero_copy) {
+            _port->read_span_advance(used);
+        }
+        nbytes -= MIN(used, nbytes);
     }
 
     const uint32_t tnow = AP_HAL::millis();
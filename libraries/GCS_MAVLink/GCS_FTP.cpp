@@ -26,6 +26,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_HAL/utility/sparse-endian.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -48,11 +49,17 @@ bool GCS_MAVLINK::ftp_init(void) {
         return true;
     }
 
-    ftp.requests = NEW_NOTHROW ObjectBuffer<pending_ftp>(5);
+    // room for a few requests from each session
+    ftp.requests = NEW_NOTHROW ObjectBuffer<pending_ftp>(MAX(5, 2*AP_MAVLINK_FTP_MAX_SESSIONS));
     if (ftp.requests == nullptr || ftp.requests->get_size() == 0) {
         goto failed;
     }
 
+    ftp.burst_reply = NEW_NOTHROW pending_ftp;
+    if (ftp.burst_reply == nullptr) {
+        goto failed;
+    }
+
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_worker, void),
                                       "FTP", 2560, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         goto failed;
@@ -63,6 +70,8 @@ bool GCS_MAVLINK::ftp_init(void) {
 failed:
     delete ftp.requests;
     ftp.requests = nullptr;
+    delete ftp.burst_reply;
+    ftp.burst_reply = nullptr;
     GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "failed to initialize MAVFTP");
 
     return false;
@@ -146,10 +155,27 @@ void GCS_MAVLINK::ftp_error(struct pending_ftp &response, FTP_ERROR error) {
 // send our response back out to the system
 void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
 {
+    while (!ftp_try_push_reply(reply)) {
+        hal.scheduler->delay(2);
+    }
+}
+
+/*
+  try to send a reply on the channel of the request. Returns false if
+  the channel has no space for it right now
+ */
+bool GCS_MAVLINK::ftp_try_push_reply(pending_ftp &reply)
+{
+    GCS_MAVLINK *link = gcs().chan(reply.chan);
+    if (link == nullptr) {
+        // the link has gone, drop the reply
+        return true;
+    }
+
     ftp.last_send_ms = AP_HAL::millis(); // Used to detect active FTP session
 
-    while (!send_ftp_reply(reply)) {
-        hal.scheduler->delay(2);
+    if (!link->send_ftp_reply(reply)) {
+        return false;
     }
 
     if (reply.req_opcode == FTP_OP::TerminateSession) {
@@ -163,8 +189,285 @@ void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
     */
     if (ftp.need_banner_send_mask & (1U<<reply.chan)) {
         ftp.need_banner_send_mask &= ~(1U<<reply.chan);
-        send_banner();
+        link->send_banner();
+    }
+    return true;
+}
+
+/*
+  sessions are identified by the session number the client chose and
+  the client's sysid/compid, so clients on different links can each
+  have files open at the same time
+ */
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_find_session(const pending_ftp &request)
+{
+    for (auto &s : ftp.sessions) {
+        if (s.fd != -1 &&
+            s.session == request.session &&
+            s.sysid == request.sysid &&
+            s.compid == request.compid) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  true if the request's session number is in use by a different client
+ */
+bool GCS_MAVLINK::ftp_session_owned_by_other(const pending_ftp &request)
+{
+    for (const auto &s : ftp.sessions) {
+        if (s.fd != -1 &&
+            s.session == request.session &&
+            (s.sysid != request.sysid || s.compid != request.compid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  take a free session slot for a newly opened file, reclaiming one
+  that has been idle for more than the session timeout if needed
+ */
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_open_session(const pending_ftp &request, FTP_FILE_MODE mode)
+{
+    const uint32_t now = AP_HAL::millis();
+    ftp_session *slot = nullptr;
+    for (auto &s : ftp.sessions) {
+        if (s.fd == -1) {
+            slot = &s;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        for (auto &s : ftp.sessions) {
+            if (now - s.last_activity_ms >= FTP_SESSION_TIMEOUT) {
+                // no activity, assume the client has gone away
+                ftp_close_session(s);
+                slot = &s;
+                break;
+            }
+        }
+    }
+    if (slot == nullptr) {
+        return nullptr;
+    }
+
+    ftp_session &s = *slot;
+    s = {};
+    s.mode = mode;
+    s.session = request.session;
+    s.sysid = request.sysid;
+    s.compid = request.compid;
+    s.chan = request.chan;
+    s.last_activity_ms = now;
+    s.open_ms = now;
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    if (mode == FTP_FILE_MODE::Read) {
+        // without a buffer we read directly from the file
+        s.buf = NEW_NOTHROW uint8_t[AP_MAVLINK_FTP_READ_AHEAD_SIZE];
+    }
+#endif
+    return slot;
+}
+
+void GCS_MAVLINK::ftp_close_session(ftp_session &s)
+{
+    if (s.fd == -1) {
+        return;
+    }
+    AP::FS().close(s.fd);
+    s.fd = -1;
+    delete[] s.buf;
+    s.buf = nullptr;
+    s.burst.active = false;
+
+    if (s.mode == FTP_FILE_MODE::Read && s.bytes_sent > 0) {
+        ftp.last_read.bytes = s.bytes_sent;
+        ftp.last_read.time_ms = s.last_activity_ms - s.open_ms;
+        ftp.last_read.rerequests = s.rerequests;
+        if (s.bytes_sent >= 65536) {
+            const uint32_t time_ms = MAX(ftp.last_read.time_ms, 1U);
+            GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "FTP: %u bytes %.1fkB/s %u rereq",
+                          unsigned(s.bytes_sent),
+                          s.bytes_sent / (1.024f * time_ms),
+                          unsigned(s.rerequests));
+        }
+    }
+}
+
+/*
+  read file data, going through the read-ahead buffer if we have one
+  so the filesystem sees a few large reads rather than one small read
+  per packet. With a null dest this only fills the buffer
+ */
+ssize_t GCS_MAVLINK::ftp_read(ftp_session &s, uint32_t offset, uint8_t *dest, uint8_t len)
+{
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    if (s.buf != nullptr) {
+        const uint32_t buf_end = s.buf_offset + s.buf_len;
+        // refill unless the buffer was filled from this offset and came
+        // up short, in which case that is all the file has for us
+        if (offset < s.buf_offset || offset >= buf_end ||
+            (offset + len > buf_end && offset != s.buf_offset)) {
+            if (AP::FS().lseek(s.fd, offset, SEEK_SET) == -1) {
+                return -1;
+            }
+            const ssize_t n = AP::FS().read(s.fd, s.buf, AP_MAVLINK_FTP_READ_AHEAD_SIZE);
+            if (n < 0) {
+                s.buf_len = 0;
+                return -1;
+            }
+            s.buf_offset = offset;
+            s.buf_len = n;
+        }
+        if (dest == nullptr) {
+            return 0;
+        }
+        const uint32_t avail = s.buf_offset + s.buf_len - offset;
+        const uint8_t n = MIN(avail, len);
+        memcpy(dest, &s.buf[offset - s.buf_offset], n);
+        return n;
+    }
+#endif
+    if (AP::FS().lseek(s.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().read(s.fd, dest, len);
+}
+
+/*
+  the client asked again for data we have already sent it, so packets
+  were lost: back off the burst rate
+ */
+void GCS_MAVLINK::ftp_note_rerequest(ftp_session &s, uint32_t offset)
+{
+    if (offset >= s.burst.highest_offset) {
+        return;
     }
+    s.rerequests++;
+    if (s.rate_bps != 0 && !s.burst.lost) {
+        s.rate_bps = MAX(s.rate_bps / 2, s.link_bps / 8);
+    }
+    s.burst.lost = true;
+}
+
+/*
+  start streaming a burst from the request offset. Packets are sent by
+  ftp_burst_service() between other requests, so several sessions can
+  stream at once and a re-request or terminate is seen straight away
+ */
+void GCS_MAVLINK::ftp_start_burst(ftp_session &s, const pending_ftp &request, uint8_t max_read)
+{
+    ftp_note_rerequest(s, request.offset);
+
+    /*
+      on links without flow control start at 1/3 of the link
+      bandwidth, as a fixed rate did before, then adapt: each burst
+      without lost packets raises the rate, each re-request halves
+      it. This keeps loss low on radios while letting good links run
+      close to their capacity
+     */
+    uint32_t link_bps = 0;
+    if (valid_channel(request.chan)) {
+        auto *port = mavlink_comm_port[request.chan];
+        if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
+            link_bps = port->bw_in_bytes_per_second();
+        }
+    }
+    if (link_bps == 0) {
+        s.rate_bps = 0;
+    } else if (s.rate_bps == 0 || s.link_bps != link_bps) {
+        s.rate_bps = link_bps / 3;
+    } else if (!s.burst.lost) {
+        s.rate_bps = MIN(s.rate_bps + link_bps / 16, link_bps);
+    }
+    s.link_bps = link_bps;
+
+    s.chan = request.chan;
+    s.burst.active = true;
+    s.burst.lost = false;
+    s.burst.offset = request.offset;
+    // this transfer size is enough for a full parameter file with max parameters
+    s.burst.remaining = 500;
+    s.burst.seq_number = request.seq_number + 1;
+    s.burst.max_read = max_read;
+    s.burst.next_send_us = AP_HAL::micros();
+}
+
+/*
+  send the next packet of each active burst which is due and fits on
+  its link. Returns true if anything was sent
+ */
+bool GCS_MAVLINK::ftp_burst_service(void)
+{
+    bool sent = false;
+    for (auto &s : ftp.sessions) {
+        if (s.fd == -1 || !s.burst.active) {
+            continue;
+        }
+        const uint32_t now_us = AP_HAL::micros();
+        if (s.rate_bps != 0 && int32_t(now_us - s.burst.next_send_us) < 0) {
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+            // paced; get the data for the next packet ready meanwhile
+            if (s.buf != nullptr && s.buf_len == AP_MAVLINK_FTP_READ_AHEAD_SIZE) {
+                IGNORE_RETURN(ftp_read(s, s.burst.offset, nullptr, s.burst.max_read));
+            }
+#endif
+            continue;
+        }
+
+        pending_ftp &reply = *ftp.burst_reply;
+        reply = {};
+        reply.req_opcode = FTP_OP::BurstReadFile;
+        reply.session = s.session;
+        reply.seq_number = s.burst.seq_number;
+        reply.chan = s.chan;
+        reply.sysid = s.sysid;
+        reply.compid = s.compid;
+        reply.offset = s.burst.offset;
+
+        const ssize_t read_bytes = ftp_read(s, s.burst.offset, reply.data, s.burst.max_read);
+        if (read_bytes == -1) {
+            ftp_error(reply, FTP_ERROR::FailErrno);
+        } else if (read_bytes == 0) {
+            ftp_error(reply, FTP_ERROR::EndOfFile);
+        } else {
+            reply.opcode = FTP_OP::Ack;
+            reply.burst_complete = (read_bytes < s.burst.max_read) || (s.burst.remaining == 1);
+            reply.size = (uint8_t)read_bytes;
+        }
+
+        if (!ftp_try_push_reply(reply)) {
+            // the link is full, try again next time around
+            continue;
+        }
+        sent = true;
+        s.last_activity_ms = AP_HAL::millis();
+
+        if (reply.opcode == FTP_OP::Nack) {
+            s.burst.active = false;
+            continue;
+        }
+        s.burst.offset += read_bytes;
+        s.burst.highest_offset = MAX(s.burst.highest_offset, s.burst.offset);
+        s.burst.seq_number++;
+        s.burst.remaining--;
+        s.bytes_sent += read_bytes;
+        ftp.total_bytes_sent += read_bytes;
+        if (s.burst.remaining == 0) {
+            s.burst.active = false;
+        }
+        // after a short read we carry on, so the client gets an
+        // EndOfFile Nack next as it did with the blocking burst
+        if (s.rate_bps != 0) {
+            const uint16_t pkt_size = PAYLOAD_SIZE(s.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - s.burst.max_read);
+            s.burst.next_send_us = now_us + pkt_size * 1000000ULL / s.rate_bps;
+        }
+    }
+    return sent;
 }
 
 void GCS_MAVLINK::ftp_worker(void) {
@@ -175,9 +478,21 @@ void GCS_MAVLINK::ftp_worker(void) {
     while (true) {
         bool skip_push_reply = false;
 
-        while (ftp.requests == nullptr || !ftp.requests->pop(request)) {
-            // nothing to handle, delay ourselves a bit then check again. Ideally we'd use conditional waits here
-            hal.scheduler->delay(2);
+        if (ftp.requests == nullptr || !ftp.requests->pop(request)) {
+            // nothing to handle, stream any bursts in progress
+            if (!ftp_burst_service()) {
+                // nothing could be sent, delay ourselves a bit then check again. Ideally we'd use conditional waits here
+                bool bursting = false;
+                for (const auto &s : ftp.sessions) {
+                    bursting |= s.burst.active;
+                }
+                if (bursting) {
+                    hal.scheduler->delay_microseconds(500);
+                } else {
+                    hal.scheduler->delay(2);
+                }
+            }
+            continue;
         }
 
         // if it's a rerequest and we still have the last response then send it
@@ -203,379 +518,326 @@ void GCS_MAVLINK::ftp_worker(void) {
             continue;
         }
 
-        uint32_t now = AP_HAL::millis();
+        const uint32_t now = AP_HAL::millis();
+
+        ftp_session *session = ftp_find_session(request);
+        bool session_idle = false;
+        if (session != nullptr) {
+            session_idle = now - session->last_activity_ms > FTP_SESSION_TIMEOUT;
+            session->last_activity_ms = now;
+        }
+
+        // dispatch the command as needed
+        switch (request.opcode) {
+            case FTP_OP::None:
+                reply.opcode = FTP_OP::Ack;
+                break;
+            case FTP_OP::TerminateSession:
+                if (session != nullptr) {
+                    ftp_close_session(*session);
+                }
+                reply.opcode = FTP_OP::Ack;
+                break;
+            case FTP_OP::ResetSessions:
+                // close everything this client has open
+                for (auto &s : ftp.sessions) {
+                    if (s.sysid == request.sysid && s.compid == request.compid) {
+                        ftp_close_session(s);
+                    }
+                }
+                reply.opcode = FTP_OP::Ack;
+                break;
+            case FTP_OP::ListDirectory:
+                ftp_list_dir(request, reply);
+                break;
+            case FTP_OP::OpenFileRO:
+                {
+                    // only allow one file to be open per session
+                    if (session != nullptr && session_idle) {
+                        // no activity for 3s, assume client has
+                        // timed out receiving open reply, close
+                        // the file
+                        ftp_close_session(*session);
+                        session = nullptr;
+                    }
+                    if (session != nullptr) {
+                        ftp_error(reply, FTP_ERROR::Fail);
+                        break;
+                    }
+
+                    // sanity check that our the request looks well formed
+                    const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                    if ((file_name_len != request.size) || (request.size == 0)) {
+                        ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                        break;
+                    }
+
+                    request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                    // get the file size
+                    struct stat st;
+                    if (AP::FS().stat((char *)request.data, &st)) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
+                        break;
+                    }
+                    const size_t file_size = st.st_size;
+
+                    session = ftp_open_session(request, FTP_FILE_MODE::Read);
+                    if (session == nullptr) {
+                        ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                        break;
+                    }
+
+                    // actually open the file
+                    session->fd = AP::FS().open((char *)request.data, O_RDONLY);
+                    if (session->fd == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
+                        ftp_close_session(*session);
+                        break;
+                    }
 
-        // check for session termination
-        if (request.session != ftp.current_session &&
-            (request.opcode == FTP_OP::TerminateSession || request.opcode == FTP_OP::ResetSessions)) {
-            // terminating a different session, just ack
-            reply.opcode = FTP_OP::Ack;
-        } else if (ftp.fd != -1 && request.session != ftp.current_session &&
-                   now - ftp.last_send_ms < FTP_SESSION_TIMEOUT) {
-            // if we have an open file and the session isn't right
-            // then reject. This prevents IO on the wrong file
-            ftp_error(reply, FTP_ERROR::InvalidSession);
-        } else {
-            if (ftp.fd != -1 &&
-                request.session != ftp.current_session &&
-                now - ftp.last_send_ms >= FTP_SESSION_TIMEOUT) {
-                // if a new session appears and the old session has
-                // been idle for more than the timeout then force
-                // close the old session
-                AP::FS().close(ftp.fd);
-                ftp.fd = -1;
-                ftp.current_session = -1;
-            }
-            // dispatch the command as needed
-            switch (request.opcode) {
-                case FTP_OP::None:
                     reply.opcode = FTP_OP::Ack;
+                    reply.size = sizeof(uint32_t);
+                    put_le32_ptr(reply.data, (uint32_t)file_size);
+
+                    // provide compatibility with old protocol banner download
+                    if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
+                        ftp.need_banner_send_mask |= 1U<<reply.chan;
+                    }
                     break;
-                case FTP_OP::TerminateSession:
-                case FTP_OP::ResetSessions:
-                    // we already handled this, just listed for completeness
-                    if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
+                }
+            case FTP_OP::ReadFile:
+                {
+                    // must actually be working on a file, and an unknown
+                    // session tells the client to reset its state
+                    if (session == nullptr) {
+                        ftp_error(reply, FTP_ERROR::InvalidSession);
+                        break;
+                    }
+
+                    // must have the file in read mode
+                    if ((session->mode != FTP_FILE_MODE::Read)) {
+                        ftp_error(reply, FTP_ERROR::Fail);
+                        break;
                     }
-                    ftp.current_session = -1;
+
+                    // filling a gap in a burst
+                    ftp_note_rerequest(*session, request.offset);
+
+                    // fill the buffer
+                    const ssize_t read_bytes = ftp_read(*session, request.offset, reply.data, MIN(sizeof(reply.data),request.size));
+                    if (read_bytes == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
+                        break;
+                    }
+                    if (read_bytes == 0) {
+                        ftp_error(reply, FTP_ERROR::EndOfFile);
+                        break;
+                    }
+
                     reply.opcode = FTP_OP::Ack;
+                    reply.offset = request.offset;
+                    reply.size = (uint8_t)read_bytes;
+                    session->bytes_sent += read_bytes;
+                    ftp.total_bytes_sent += read_bytes;
                     break;
-                case FTP_OP::ListDirectory:
-                    ftp_list_dir(request, reply);
-                    break;
-                case FTP_OP::OpenFileRO:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1 && now - ftp.last_send_ms > FTP_SESSION_TIMEOUT) {
-                            // no activity for 3s, assume client has
-                            // timed out receiving open reply, close
-                            // the file
-                            AP::FS().close(ftp.fd);
-                            ftp.fd = -1;
-                            ftp.current_session = -1;
-                        }
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // get the file size
-                        struct stat st;
-                        if (AP::FS().stat((char *)request.data, &st)) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        const size_t file_size = st.st_size;
-
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data, O_RDONLY);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Read;
-                        ftp.current_session = request.session;
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, (uint32_t)file_size);
-
-                        // provide compatibility with old protocol banner download
-                        if (strncmp((const char *)request.data, "@PARAM/param.pck", 16) == 0) {
-                            ftp.need_banner_send_mask |= 1U<<reply.chan;
-                        }
+                }
+            case FTP_OP::Ack:
+            case FTP_OP::Nack:
+                // eat these, we just didn't expect them
+                continue;
+                break;
+            case FTP_OP::OpenFileWO:
+            case FTP_OP::CreateFile:
+                {
+                    // only allow one file to be open per session
+                    if (session != nullptr) {
+                        ftp_error(reply, FTP_ERROR::Fail);
                         break;
                     }
-                case FTP_OP::ReadFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
-                        if (read_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        if (read_bytes == 0) {
-                            ftp_error(reply, FTP_ERROR::EndOfFile);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
-                        reply.size = (uint8_t)read_bytes;
+
+                    // sanity check that our the request looks well formed
+                    const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                    if ((file_name_len != request.size) || (request.size == 0)) {
+                        ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                        break;
+                    }
+
+                    request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                    session = ftp_open_session(request, FTP_FILE_MODE::Write);
+                    if (session == nullptr) {
+                        ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                        break;
+                    }
+
+                    // actually open the file
+                    session->fd = AP::FS().open((char *)request.data,
+                                                (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
+                    if (session->fd == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
+                        ftp_close_session(*session);
                         break;
                     }
-                case FTP_OP::Ack:
-                case FTP_OP::Nack:
-                    // eat these, we just didn't expect them
-                    continue;
+
+                    reply.opcode = FTP_OP::Ack;
                     break;
-                case FTP_OP::OpenFileWO:
-                case FTP_OP::CreateFile:
-                    {
-                        // only allow one file to be open per session
-                        if (ftp.fd != -1) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data,
-                                               (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-                        ftp.mode = FTP_FILE_MODE::Write;
-                        ftp.current_session = request.session;
-
-                        reply.opcode = FTP_OP::Ack;
+                }
+            case FTP_OP::WriteFile:
+                {
+                    // must actually be working on a file, and an unknown
+                    // session tells the client to reset its state
+                    if (session == nullptr) {
+                        ftp_error(reply, FTP_ERROR::InvalidSession);
                         break;
                     }
-                case FTP_OP::WriteFile:
-                    {
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in write mode
-                        if ((ftp.mode != FTP_FILE_MODE::Write)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
-                        if (write_bytes == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
-                        reply.offset = request.offset;
+
+                    // must have the file in write mode
+                    if ((session->mode != FTP_FILE_MODE::Write)) {
+                        ftp_error(reply, FTP_ERROR::Fail);
                         break;
                     }
-                case FTP_OP::CreateDirectory:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // actually make the directory
-                        if (AP::FS().mkdir((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
+
+                    // seek to requested offset
+                    if (AP::FS().lseek(session->fd, request.offset, SEEK_SET) == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
                         break;
                     }
-                case FTP_OP::RemoveDirectory:
-                case FTP_OP::RemoveFile:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        // remove the file/dir
-                        if (AP::FS().unlink((char *)request.data) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        reply.opcode = FTP_OP::Ack;
+
+                    // fill the buffer
+                    const ssize_t write_bytes = AP::FS().write(session->fd, request.data, request.size);
+                    if (write_bytes == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
                         break;
                     }
-                case FTP_OP::CalcFileCRC32:
-                    {
-                        // sanity check that our the request looks well formed
-                        const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
-                        if ((file_name_len != request.size) || (request.size == 0)) {
-                            ftp_error(reply, FTP_ERROR::InvalidDataSize);
-                            break;
-                        }
-
-                        request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
-
-                        uint32_t checksum = 0;
-                        if (!AP::FS().crc32((char *)request.data, checksum)) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // reset our scratch area so we don't leak data, and can leverage trimming
-                        memset(reply.data, 0, sizeof(reply.data));
-                        reply.size = sizeof(uint32_t);
-                        put_le32_ptr(reply.data, checksum);
-                        reply.opcode = FTP_OP::Ack;
+
+                    reply.opcode = FTP_OP::Ack;
+                    reply.offset = request.offset;
+                    break;
+                }
+            case FTP_OP::CreateDirectory:
+                {
+                    // sanity check that our the request looks well formed
+                    const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                    if ((file_name_len != request.size) || (request.size == 0)) {
+                        ftp_error(reply, FTP_ERROR::InvalidDataSize);
                         break;
                     }
-                case FTP_OP::BurstReadFile:
-                    {
-                        const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
-                        // must actually be working on a file
-                        if (ftp.fd == -1) {
-                            ftp_error(reply, FTP_ERROR::FileNotFound);
-                            break;
-                        }
-
-                        // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
-                            ftp_error(reply, FTP_ERROR::Fail);
-                            break;
-                        }
-
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        /*
-                          calculate a burst delay so that FTP burst
-                          transfer doesn't use more than 1/3 of
-                          available bandwidth on links that don't have
-                          flow control. This reduces the chance of
-                          lost packets a lot, which results in overall
-                          faster transfers
-                         */
-                        uint32_t burst_delay_ms = 0;
-                        if (valid_channel(request.chan)) {
-                            auto *port = mavlink_comm_port[request.chan];
-                            if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
-                                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
-                            }
-                        }
-
-                        // this transfer size is enough for a full parameter file with max parameters
-                        const uint32_t transfer_size = 500;
-                        for (uint32_t i = 0; (i < transfer_size); i++) {
-                            // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
-                            if (read_bytes == -1) {
-                                ftp_error(reply, FTP_ERROR::FailErrno);
-                                break;
-                            }
-
-                            if (read_bytes != sizeof(reply.data)) {
-                                // don't send any old data
-                                memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
-                            }
-
-                            if (read_bytes == 0) {
-                                ftp_error(reply, FTP_ERROR::EndOfFile);
-                                break;
-                            }
-
-                            reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
-                            reply.burst_complete = ((read_bytes < max_read) || (i == (transfer_size - 1)));
-                            reply.size = (uint8_t)read_bytes;
-
-                            ftp_push_replies(reply);
-
-                            if (read_bytes < max_read) {
-                                // ensure the NACK which we send next is at the right offset
-                                reply.offset += read_bytes;
-                            }
-
-                            // prep the reply to be used again
-                            reply.seq_number++;
-
-                            hal.scheduler->delay(burst_delay_ms);
-                        }
-
-                        if (reply.opcode != FTP_OP::Nack) {
-                            // prevent a duplicate packet send for
-                            // normal replies of burst reads
-                            skip_push_reply = true;
-                        }
+
+                    request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                    // actually make the directory
+                    if (AP::FS().mkdir((char *)request.data) == -1) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
                         break;
                     }
 
-                case FTP_OP::Rename: {
-                    // sanity check that the request looks well formed
-                    const char *filename1 = (char*)request.data;
-                    const size_t len1 = strnlen(filename1, sizeof(request.data)-2);
-                    const char *filename2 = (char*)&request.data[len1+1];
-                    const size_t len2 = strnlen(filename2, sizeof(request.data)-(len1+1));
-                    if (filename1[len1] != 0 || (len1+len2+1 != request.size) || (request.size == 0)) {
+                    reply.opcode = FTP_OP::Ack;
+                    break;
+                }
+            case FTP_OP::RemoveDirectory:
+            case FTP_OP::RemoveFile:
+                {
+                    // sanity check that our the request looks well formed
+                    const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                    if ((file_name_len != request.size) || (request.size == 0)) {
                         ftp_error(reply, FTP_ERROR::InvalidDataSize);
                         break;
                     }
-                    request.data[sizeof(request.data) - 1] = 0; // ensure the 2nd path is null terminated
+
+                    request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
                     // remove the file/dir
-                    if (AP::FS().rename(filename1, filename2) != 0) {
+                    if (AP::FS().unlink((char *)request.data) == -1) {
                         ftp_error(reply, FTP_ERROR::FailErrno);
                         break;
                     }
+
                     reply.opcode = FTP_OP::Ack;
                     break;
                 }
+            case FTP_OP::CalcFileCRC32:
+                {
+                    // no file needs to be open, but the session must not
+                    // be another client's
+                    if (ftp_session_owned_by_other(request)) {
+                        ftp_error(reply, FTP_ERROR::InvalidSession);
+                        break;
+                    }
 
-                case FTP_OP::TruncateFile:
-                default:
-                    // this was bad data, just nack it
-                    GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
-                    ftp_error(reply, FTP_ERROR::Fail);
+                    // sanity check that our the request looks well formed
+                    const size_t file_name_len = strnlen((char *)request.data, sizeof(request.data));
+                    if ((file_name_len != request.size) || (request.size == 0)) {
+                        ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                        break;
+                    }
+
+                    request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
+
+                    uint32_t checksum = 0;
+                    if (!AP::FS().crc32((char *)request.data, checksum)) {
+                        ftp_error(reply, FTP_ERROR::FailErrno);
+                        break;
+                    }
+
+                    // reset our scratch area so we don't leak data, and can leverage trimming
+                    memset(reply.data, 0, sizeof(reply.data));
+                    reply.size = sizeof(uint32_t);
+                    put_le32_ptr(reply.data, checksum);
+                    reply.opcode = FTP_OP::Ack;
                     break;
+                }
+            case FTP_OP::BurstReadFile:
+                {
+                    const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
+                    // must actually be working on a file, and an unknown
+                    // session tells the client to reset its state
+                    if (session == nullptr) {
+                        ftp_error(reply, FTP_ERROR::InvalidSession);
+                        break;
+                    }
+
+                    // must have the file in read mode
+                    if ((session->mode != FTP_FILE_MODE::Read)) {
+                        ftp_error(reply, FTP_ERROR::Fail);
+                        break;
+                    }
+
+                    ftp_start_burst(*session, request, MIN(sizeof(reply.data), max_read));
+
+                    // the burst replies are sent by ftp_burst_service(),
+                    // and a repeat of this request restarts the burst
+                    skip_push_reply = true;
+                    reply.session = -1;
+                    break;
+                }
+
+            case FTP_OP::Rename: {
+                // sanity check that the request looks well formed
+                const char *filename1 = (char*)request.data;
+                const size_t len1 = strnlen(filename1, sizeof(request.data)-2);
+                const char *filename2 = (char*)&request.data[len1+1];
+                const size_t len2 = strnlen(filename2, sizeof(request.data)-(len1+1));
+                if (filename1[len1] != 0 || (len1+len2+1 != request.size) || (request.size == 0)) {
+                    ftp_error(reply, FTP_ERROR::InvalidDataSize);
+                    break;
+                }
+                request.data[sizeof(request.data) - 1] = 0; // ensure the 2nd path is null terminated
+                // remove the file/dir
+                if (AP::FS().rename(filename1, filename2) != 0) {
+                    ftp_error(reply, FTP_ERROR::FailErrno);
+                    break;
+                }
+                reply.opcode = FTP_OP::Ack;
+                break;
             }
+
+            case FTP_OP::TruncateFile:
+            default:
+                // this was bad data, just nack it
+                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Unsupported FTP: %d", static_cast<int>(request.opcode));
+                ftp_error(reply, FTP_ERROR::Fail);
+                break;
         }
 
         if (!skip_push_reply) {
@@ -586,6 +848,43 @@ void GCS_MAVLINK::ftp_worker(void) {
     }
 }
 
+/*
+  report open sessions and read throughput
+ */
+void GCS_MAVLINK::ftp_info(ExpandingString &str)
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("FTPV1\n");
+
+    const uint32_t now = AP_HAL::millis();
+    for (const auto &s : ftp.sessions) {
+        if (s.fd == -1) {
+            continue;
+        }
+        const float time_s = MAX(now - s.open_ms, 1U) * 0.001f;
+        str.printf("SESSION=%3u SYS=%3u COMP=%3u CH=%u MODE=%c BYTES=%10u RATE=%7.1fkB/s PACE=%6.1fkB/s REREQ=%5u%s\n",
+                   unsigned(s.session),
+                   unsigned(s.sysid),
+                   unsigned(s.compid),
+                   unsigned(s.chan - MAVLINK_COMM_0),
+                   s.mode == FTP_FILE_MODE::Read ? 'R' : 'W',
+                   unsigned(s.bytes_sent),
+                   s.bytes_sent / (1024.0f * time_s),
+                   s.rate_bps / 1024.0f,
+                   unsigned(s.rerequests),
+                   s.burst.active ? " BURST" : "");
+    }
+    if (ftp.last_read.bytes > 0) {
+        const float time_s = MAX(ftp.last_read.time_ms, 1U) * 0.001f;
+        str.printf("LAST BYTES=%10u TIME=%7.1fs RATE=%7.1fkB/s REREQ=%5u\n",
+                   unsigned(ftp.last_read.bytes),
+                   time_s,
+                   ftp.last_read.bytes / (1024.0f * time_s),
+                   unsigned(ftp.last_read.rerequests));
+    }
+    str.printf("TOTAL BYTES=%u\n", unsigned(ftp.total_bytes_sent));
+}
+
 // calculates how much string length is needed to fit this in a list response
 int GCS_MAVLINK::gen_dir_entry(char *dest, size_t space, const char *path, const struct dirent * entry) {
 #if AP_FILESYSTEM_HAVE_DIRENT_DTYPE
@@ -77,4 +77,31 @@ void comm_send_lock(mavlink_channel_t chan, uint16_t size);
 void comm_send_unlock(mavlink_channel_t chan);
 HAL_Semaphore &comm_chan_lock(mavlink_channel_t chan);
 
+/*
+  feed payload bytes to a parser that is part way through a message
+  payload, copying and CRCing them as a block rather than one call to
+  mavlink_frame_char_buffer() per byte. Returns the number of bytes
+  consumed, 0 if the parser is not inside a payload. Headers, CRC and
+  signature bytes must still go through mavlink_frame_char_buffer()
+ */
+static inline uint16_t mavlink_frame_payload_span(mavlink_message_t *rxmsg, mavlink_status_t *status,
+                                                  const uint8_t *data, uint16_t len)
+{
+    if (status->parse_state != MAVLINK_PARSE_STATE_GOT_MSGID3 ||
+        status->packet_idx >= rxmsg->len) {
+        return 0;
+    }
+    uint16_t n = rxmsg->len - status->packet_idx;
+    if (n > len) {
+        n = len;
+    }
+    memcpy(&_MAV_PAYLOAD_NON_CONST(rxmsg)[status->packet_idx], data, n);
+    crc_accumulate_buffer(&rxmsg->checksum, (const char *)data, n);
+    status->packet_idx += n;
+    if (status->packet_idx == rxmsg->len) {
+        status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
+    }
+    return n;
+}
+
 #pragma GCC diagnostic pop
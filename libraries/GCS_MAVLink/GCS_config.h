@@ -86,6 +86,16 @@
 #define AP_MAVLINK_FTP_ENABLED HAL_GCS_ENABLED
 #endif
 
+// number of FTP sessions (open files) which can be active at once
+#ifndef AP_MAVLINK_FTP_MAX_SESSIONS
+#define AP_MAVLINK_FTP_MAX_SESSIONS ((HAL_MEM_CLASS >= HAL_MEM_CLASS_300) ? 4 : 1)
+#endif
+
+// size of the read-ahead buffer of each FTP read session, 0 to disable
+#ifndef AP_MAVLINK_FTP_READ_AHEAD_SIZE
+#define AP_MAVLINK_FTP_READ_AHEAD_SIZE ((HAL_MEM_CLASS >= HAL_MEM_CLASS_300) ? 4096 : 0)
+#endif
+
 // GCS should be using MISSION_REQUEST_INT instead; this is a waste of
 // flash.  MISSION_REQUEST was deprecated in June 2020.  We started
 // sending warnings to the GCS in Sep 2022 if MISSION_REQUEST was used.
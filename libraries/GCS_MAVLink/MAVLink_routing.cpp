@@ -27,13 +27,18 @@
 #include "MAVLink_routing.h"
 
 #include <AP_ADSB/AP_ADSB.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) : num_routes(0)
+{
+    memset(key_buckets, NO_ROUTE, sizeof(key_buckets));
+    memset(sysid_buckets, NO_ROUTE, sizeof(sysid_buckets));
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -173,41 +178,32 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
 
     // forward on any channels matching the targets
     bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
-            continue;
+    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
+    if (broadcast_system) {
+        // one copy on each channel we have a route on. Private
+        // channels only get messages targeted at their routes
+        const uint16_t mask = route_channel_mask & ~GCS_MAVLINK::private_channel_mask();
+        for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+            const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+            if ((mask & (1U<<i)) == 0 || channel == in_link.get_chan() ||
+                gcs().chan(channel) == nullptr) {
+                continue;
+            }
+            forward_on_channel(channel, msg);
+            forwarded = true;
         }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    } else if (broadcast_component || !match_system) {
+        // all routes to the target system
+        for (uint8_t i=sysid_buckets[sysid_bucket(target_system)]; i != NO_ROUTE; i=routes[i].next_sysid) {
+            if (routes[i].sysid == target_system) {
+                forwarded |= forward_on_route(in_link, msg, i, target_system, target_component, sent_to_chan);
+            }
         }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
-#if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link.get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
-#endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
+    } else {
+        // routes to the target component of our own system
+        for (uint8_t i=key_buckets[key_bucket(target_system, target_component)]; i != NO_ROUTE; i=routes[i].next_key) {
+            if (routes[i].sysid == target_system && routes[i].compid == target_component) {
+                forwarded |= forward_on_route(in_link, msg, i, target_system, target_component, sent_to_chan);
             }
         }
     }
@@ -220,6 +216,64 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     return process_locally;
 }
 
+/*
+  forward a message along a route, once per channel. Returns true if
+  the route's channel should receive the message
+ */
+bool MAVLink_routing::forward_on_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg, uint8_t i,
+                                       int16_t target_system, int16_t target_component,
+                                       bool sent_to_chan[])
+{
+    route &r = routes[i];
+    GCS_MAVLINK *out_link = gcs().chan(r.channel);
+    if (out_link == nullptr) {
+        // this is bad
+        return false;
+    }
+    // Skip if channel is private and the target system or component IDs do not match
+    if (out_link->is_private() &&
+        (target_system != r.sysid ||
+         target_component != r.compid)) {
+        return false;
+    }
+    if (&in_link == out_link || sent_to_chan[r.channel]) {
+        return false;
+    }
+#if ROUTING_DEBUG
+    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+             msg.msgid,
+             (unsigned)in_link.get_chan(),
+             (unsigned)r.channel,
+             (int)target_system,
+             (int)target_component);
+#endif
+    if (forward_on_channel(r.channel, msg)) {
+        r.fwd_msgs++;
+        r.fwd_bytes += msg.len + GCS_MAVLINK::packet_overhead_chan(r.channel);
+    }
+    sent_to_chan[r.channel] = true;
+    return true;
+}
+
+/*
+  resend a message on a channel if its payload fits
+ */
+bool MAVLink_routing::forward_on_channel(mavlink_channel_t channel, const mavlink_message_t &msg)
+{
+    GCS_MAVLINK *out_link = gcs().chan(channel);
+    if (out_link == nullptr) {
+        return false;
+    }
+    if (!out_link->check_payload_size(msg.len)) {
+        chan_stats[channel].dropped++;
+        return false;
+    }
+    _mavlink_resend_uart(channel, &msg);
+    chan_stats[channel].msgs++;
+    chan_stats[channel].bytes += msg.len + GCS_MAVLINK::packet_overhead_chan(channel);
+    return true;
+}
+
 /*
   send a MAVLink message to all components with this vehicle's system id
 
@@ -238,10 +292,10 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 {
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    // check learned routes to our system
+    for (uint8_t i=sysid_buckets[sysid_bucket(mavlink_system.sysid)]; i != NO_ROUTE; i=routes[i].next_sysid) {
         if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
+            // another system sharing the hash bucket
             continue;
         }
         if (sent_to_chan[routes[i].channel]) {
@@ -272,6 +326,8 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
+        chan_stats[routes[i].channel].msgs++;
+        chan_stats[routes[i].channel].bytes += MIN(entry->max_msg_len, pkt_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel);
         sent_to_chan[routes[i].channel] = true;
     }
 }
@@ -312,12 +368,71 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
     return false;
 }
 
+/*
+  link route i into the hash chains
+ */
+void MAVLink_routing::index_route(uint8_t i)
+{
+    route &r = routes[i];
+    uint8_t &key_head = key_buckets[key_bucket(r.sysid, r.compid)];
+    r.next_key = key_head;
+    key_head = i;
+    uint8_t &sysid_head = sysid_buckets[sysid_bucket(r.sysid)];
+    r.next_sysid = sysid_head;
+    sysid_head = i;
+    route_channel_mask |= 1U<<((unsigned)(r.channel-MAVLINK_COMM_0));
+}
+
+void MAVLink_routing::reindex_routes()
+{
+    memset(key_buckets, NO_ROUTE, sizeof(key_buckets));
+    memset(sysid_buckets, NO_ROUTE, sizeof(sysid_buckets));
+    route_channel_mask = 0;
+    for (uint8_t i=0; i<num_routes; i++) {
+        index_route(i);
+    }
+}
+
+/*
+  find a slot for a new route. When the table is full the route heard
+  from least recently is replaced, provided it has timed out
+ */
+bool MAVLink_routing::allocate_route(uint8_t &i)
+{
+    if (num_routes < MAVLINK_MAX_ROUTES) {
+        i = num_routes++;
+        return true;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    uint8_t oldest = 0;
+    for (uint8_t j=1; j<num_routes; j++) {
+        if (now_ms - routes[j].last_seen_ms > now_ms - routes[oldest].last_seen_ms) {
+            oldest = j;
+        }
+    }
+    if (now_ms - routes[oldest].last_seen_ms < MAVLINK_ROUTE_TIMEOUT_MS) {
+        return false;
+    }
+#if ROUTING_DEBUG
+    ::printf("expired route %u %u via %u\n",
+             (unsigned)routes[oldest].sysid,
+             (unsigned)routes[oldest].compid,
+             (unsigned)routes[oldest].channel);
+#endif
+    // keep the table dense, this is rare enough to rebuild the index
+    routes[oldest] = routes[num_routes-1];
+    num_routes--;
+    reindex_routes();
+    routes_replaced++;
+    i = num_routes++;
+    return true;
+}
+
 /*
   see if the message is for a new route and learn it
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -335,31 +450,41 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         return;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=key_buckets[key_bucket(msg.sysid, msg.compid)]; i != NO_ROUTE; i=routes[i].next_key) {
+        route &r = routes[i];
+        if (r.sysid == msg.sysid &&
+            r.compid == msg.compid &&
+            r.channel == in_channel) {
+            r.last_seen_ms = now_ms;
+            if (r.mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
             }
-            break;
+            return;
         }
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
+
+    uint8_t i;
+    if (!allocate_route(i)) {
+        routes_rejected++;
+        return;
+    }
+    route &r = routes[i];
+    r = {};
+    r.sysid = msg.sysid;
+    r.compid = msg.compid;
+    r.channel = in_channel;
+    r.last_seen_ms = now_ms;
+    if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    index_route(i);
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
-                 (unsigned)msg.sysid,
-                 (unsigned)msg.compid,
-                 (unsigned)in_channel);
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid,
+             (unsigned)in_channel);
 #endif
-    }
 }
 
 
@@ -382,7 +507,7 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=key_buckets[key_bucket(msg.sysid, msg.compid)]; i != NO_ROUTE; i=routes[i].next_key) {
         if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
@@ -407,6 +532,10 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
                          (unsigned)msg.compid);
 #endif
                 _mavlink_resend_uart(channel, &msg);
+                chan_stats[channel].msgs++;
+                chan_stats[channel].bytes += msg.len + GCS_MAVLINK::packet_overhead_chan(channel);
+            } else {
+                chan_stats[channel].dropped++;
             }
         }
     }
@@ -432,4 +561,43 @@ void MAVLink_routing::get_targets(const mavlink_message_t &msg, int16_t &sysid,
     }
 }
 
+/*
+  report the routing table with per-route and per-channel forwarding
+  statistics
+ */
+void MAVLink_routing::routing_info(ExpandingString &str) const
+{
+    // a header to allow for machine parsers to determine format
+    str.printf("RoutesV1\n");
+
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=0; i<num_routes; i++) {
+        const route &r = routes[i];
+        str.printf("SYS=%3u COMP=%3u CH=%2u TYPE=%3u AGE=%7.1fs MSGS=%9u BYTES=%11u\n",
+                   unsigned(r.sysid),
+                   unsigned(r.compid),
+                   unsigned(r.channel - MAVLINK_COMM_0),
+                   unsigned(r.mavtype),
+                   (now_ms - r.last_seen_ms) * 0.001f,
+                   unsigned(r.fwd_msgs),
+                   unsigned(r.fwd_bytes));
+    }
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        const auto &c = chan_stats[i];
+        if (c.msgs == 0 && c.dropped == 0) {
+            continue;
+        }
+        str.printf("CH=%2u MSGS=%9u BYTES=%11u DROPPED=%7u\n",
+                   unsigned(i),
+                   unsigned(c.msgs),
+                   unsigned(c.bytes),
+                   unsigned(c.dropped));
+    }
+    str.printf("ROUTES=%u/%u REPLACED=%u REJECTED=%u\n",
+               unsigned(num_routes),
+               unsigned(MAVLINK_MAX_ROUTES),
+               unsigned(routes_replaced),
+               unsigned(routes_rejected));
+}
+
 #endif  // HAL_GCS_ENABLED
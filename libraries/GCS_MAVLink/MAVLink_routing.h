@@ -3,11 +3,30 @@
 #pragma once
 
 #include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL_Boards.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// number of hash buckets for each route index, must be a power of 2
+#define MAVLINK_ROUTE_BUCKETS 32
+
+// a route not heard from for this long may be replaced by a new
+// route once the table is full
+#ifndef MAVLINK_ROUTE_TIMEOUT_MS
+#define MAVLINK_ROUTE_TIMEOUT_MS 30000
+#endif
+
+static_assert(MAVLINK_MAX_ROUTES < 255, "route indexes are uint8_t");
+static_assert((MAVLINK_ROUTE_BUCKETS & (MAVLINK_ROUTE_BUCKETS-1)) == 0, "MAVLINK_ROUTE_BUCKETS must be a power of 2");
+
+class ExpandingString;
 
 /*
   object to handle MAVLink packet routing
@@ -49,20 +68,74 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    // report routes and forwarding statistics, for @SYS/routes.txt
+    void routing_info(ExpandingString &str) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    static constexpr uint8_t NO_ROUTE = 0xFF;
+
+    /*
+      the routes are kept densely packed in an array, and indexed by
+      two sets of hash chains: one keyed on sysid/compid for learning
+      and targeted forwarding, and one keyed on sysid alone for
+      messages to all components of a system. Forwarding cost then
+      depends on the number of routes to the target, not the size of
+      the table
+     */
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
+        uint8_t next_key;       // next route in the same key_buckets chain
+        uint8_t next_sysid;     // next route in the same sysid_buckets chain
+        uint32_t last_seen_ms;
+        uint32_t fwd_msgs;
+        uint32_t fwd_bytes;
     } routes[MAVLINK_MAX_ROUTES];
-    
+    uint8_t key_buckets[MAVLINK_ROUTE_BUCKETS];
+    uint8_t sysid_buckets[MAVLINK_ROUTE_BUCKETS];
+
+    // forwarding statistics for each outgoing channel
+    struct {
+        uint32_t msgs;
+        uint32_t bytes;
+        uint32_t dropped;
+    } chan_stats[MAVLINK_COMM_NUM_BUFFERS];
+    uint32_t routes_replaced;
+    uint32_t routes_rejected;
+
+    // channels which have at least one route
+    uint16_t route_channel_mask;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
-    
+
+    static uint8_t key_bucket(uint8_t sysid, uint8_t compid) {
+        return (sysid * 37U + compid) & (MAVLINK_ROUTE_BUCKETS-1);
+    }
+    static uint8_t sysid_bucket(uint8_t sysid) {
+        return sysid & (MAVLINK_ROUTE_BUCKETS-1);
+    }
+
+    // add route i to the hash chains
+    void index_route(uint8_t i);
+
+    // rebuild the hash chains and channel mask after removing a route
+    void reindex_routes();
+
+    // find space for a new route, replacing a stale one if full
+    bool allocate_route(uint8_t &i);
+
+    // forward msg along route i unless already sent on that channel
+    bool forward_on_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg, uint8_t i,
+                          int16_t target_system, int16_t target_component,
+                          bool sent_to_chan[]);
+
+    // forward msg on a channel, updating channel statistics
+    bool forward_on_channel(mavlink_channel_t channel, const mavlink_message_t &msg);
+
     // learn new routes
     void learn_route(GCS_MAVLINK &link, const mavlink_message_t &msg);
 
@@ -0,0 +1,140 @@
+/*
+  MAVLink receive parse rate. A captured style stream of messages is
+  parsed the way GCS_MAVLINK::update_receive() used to, one
+  mavlink_frame_char_buffer() call per byte, and the way it does now,
+  with payload bytes copied and CRCed as a block out of the UART
+  buffer span. The items_per_second figure is messages per second.
+
+  The ratio between the two is what matters; on a ChibiOS board the
+  per-byte call overhead is a larger share of the cost than on a PC,
+  so the saving there is at least as large as shown here.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+AP_SerialManager _serialmanager;
+GCS_Dummy _gcs;
+
+enum class Mix {
+    // heartbeats, attitude and GPS, as a GCS link mostly sees
+    TELEMETRY = 0,
+    // FTP and parameter traffic, full size payloads
+    BULK = 1,
+};
+
+static const uint32_t stream_messages = 256;
+static uint8_t stream[stream_messages * MAVLINK_MAX_PACKET_LEN];
+
+static uint32_t build_stream(Mix mix)
+{
+    mavlink_status_t status {};
+    mavlink_message_t msg;
+    uint32_t len = 0;
+    for (uint32_t i=0; i<stream_messages; i++) {
+        if (mix == Mix::BULK) {
+            if (i % 4 == 0) {
+                mavlink_param_value_t param {};
+                param.param_value = i;
+                param.param_index = i;
+                mavlink_msg_param_value_encode_status(1, 1, &status, &msg, &param);
+            } else {
+                mavlink_file_transfer_protocol_t ftp {};
+                for (uint8_t j=0; j<sizeof(ftp.payload); j++) {
+                    ftp.payload[j] = i + j;
+                }
+                mavlink_msg_file_transfer_protocol_encode_status(1, 1, &status, &msg, &ftp);
+            }
+        } else {
+            switch (i % 3) {
+            case 0: {
+                mavlink_heartbeat_t heartbeat {};
+                mavlink_msg_heartbeat_encode_status(1, 1, &status, &msg, &heartbeat);
+                break;
+            }
+            case 1: {
+                mavlink_attitude_t attitude {};
+                attitude.time_boot_ms = i;
+                attitude.roll = 0.1f * i;
+                mavlink_msg_attitude_encode_status(1, 1, &status, &msg, &attitude);
+                break;
+            }
+            default: {
+                mavlink_gps_raw_int_t gps {};
+                gps.time_usec = i;
+                gps.lat = -353632620 + i;
+                gps.lon = 1491652370 + i;
+                mavlink_msg_gps_raw_int_encode_status(1, 1, &status, &msg, &gps);
+                break;
+            }
+            }
+        }
+        len += mavlink_msg_to_send_buffer(&stream[len], &msg);
+    }
+    return len;
+}
+
+static void BM_MAVLinkReceive_PerByte(benchmark::State& state)
+{
+    const uint32_t len = build_stream(Mix(state.range(0)));
+    mavlink_message_t rxmsg {};
+    mavlink_status_t rxstatus {};
+
+    while (state.KeepRunning()) {
+        uint32_t count = 0;
+        for (uint32_t i=0; i<len; i++) {
+            mavlink_message_t msg;
+            mavlink_status_t status;
+            if (mavlink_frame_char_buffer(&rxmsg, &rxstatus, stream[i], &msg, &status) == MAVLINK_FRAMING_OK) {
+                count++;
+            }
+        }
+        if (count != stream_messages) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * stream_messages);
+    state.SetBytesProcessed(state.iterations() * len);
+}
+
+static void BM_MAVLinkReceive_Span(benchmark::State& state)
+{
+    const uint32_t len = build_stream(Mix(state.range(0)));
+    mavlink_message_t rxmsg {};
+    mavlink_status_t rxstatus {};
+
+    while (state.KeepRunning()) {
+        uint32_t count = 0;
+        uint32_t i = 0;
+        while (i < len) {
+            const uint16_t n = mavlink_frame_payload_span(&rxmsg, &rxstatus, &stream[i], MIN(len - i, 0xFFFFU));
+            if (n > 0) {
+                i += n;
+                continue;
+            }
+            mavlink_message_t msg;
+            mavlink_status_t status;
+            if (mavlink_frame_char_buffer(&rxmsg, &rxstatus, stream[i++], &msg, &status) == MAVLINK_FRAMING_OK) {
+                count++;
+            }
+        }
+        if (count != stream_messages) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * stream_messages);
+    state.SetBytesProcessed(state.iterations() * len);
+}
+
+BENCHMARK(BM_MAVLinkReceive_PerByte)->Arg(int(Mix::TELEMETRY))->Arg(int(Mix::BULK));
+BENCHMARK(BM_MAVLinkReceive_Span)->Arg(int(Mix::TELEMETRY))->Arg(int(Mix::BULK));
+
+BENCHMARK_MAIN();
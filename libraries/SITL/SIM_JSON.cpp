@@ -70,6 +70,10 @@ JSON::JSON(const char *frame_str) :
         target_ip = colon+1;
     }
 
+    if (!parser.init(keytable, ARRAY_SIZE(keytable))) {
+        AP_HAL::panic("JSON: unable to build key table");
+    }
+
     for (uint8_t i=0; i<ARRAY_SIZE(sim_defaults); i++) {
     AP_Param::set_default_by_name(sim_defaults[i].name, sim_defaults[i].value);
         if (sim_defaults[i].save) {
@@ -137,100 +141,44 @@ void JSON::output_servos(const struct sitl_input &input)
 
 
 /*
-    very simple JSON parser for sensor data
-    called with pointer to one row of sensor data, nul terminated
-
-    This parser does not do any syntax checking, and is not at all
-    general purpose
+    decode a fixed layout binary sensor frame into the same state the
+    JSON parser fills in
 */
-uint32_t JSON::parse_sensors(const char *json)
+bool JSON::parse_binary_sensors(const uint8_t *buf, ssize_t len, uint32_t &received_bitmask)
 {
-    uint32_t received_bitmask = 0;
-
-    //printf("%s\n", json);
-    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
-        struct keytable &key = keytable[i];
-
-        /* look for section header */
-        const char *p = strstr(json, key.section);
-        if (!p) {
-            // we don't have this sensor
-            if (key.required) {
-                printf("Failed to find %s\n", key.section);
-                return 0;
-            }
-            continue;
-        }
-        p += strlen(key.section)+1;
-
-        // find key inside section
-        p = strstr(p, key.key);
-        if (!p) {
-            if (key.required) {
-                printf("Failed to find key %s/%s\n", key.section, key.key);
-                return 0;
-            }
-            continue;
-        }
-
-        // record the keys that are found
-        received_bitmask |= 1U << i;
-
-        p += strlen(key.key)+2;
-        switch (key.type) {
-            case DATA_UINT64:
-                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
-                //printf("%s/%s = %lu\n", key.section, key.key, *((uint64_t *)key.ptr));
-                break;
-
-            case DATA_FLOAT:
-                *((float *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((float *)key.ptr));
-                break;
-
-            case DATA_DOUBLE:
-                *((double *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((double *)key.ptr));
-                break;
-
-            case DATA_VECTOR3F: {
-                Vector3f *v = (Vector3f *)key.ptr;
-                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
-            }
-
-            case DATA_VECTOR3D: {
-                Vector3d *v = (Vector3d *)key.ptr;
-                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
-            }
-
-            case QUATERNION: {
-                Quaternion *v = static_cast<Quaternion*>(key.ptr);
-                if (sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4)) != 4) {
-                    printf("Failed to parse Vector4f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                break;
-            }
-
-            case BOOLEAN:
-                *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
-                //printf("%s/%s = %i\n", key.section, key.key, *((unit8_t *)key.ptr));
-                break;
-
-        }
+    sensor_packet_binary pkt;
+    if (len != sizeof(pkt)) {
+        return false;
+    }
+    memcpy(&pkt, buf, sizeof(pkt));
+    if (pkt.magic != SENSOR_BINARY_MAGIC || pkt.length != sizeof(pkt)) {
+        return false;
+    }
+    if (!binary_frames) {
+        printf("JSON: using binary sensor frames\n");
+        binary_frames = true;
     }
 
-    return received_bitmask;
+    const uint32_t required = TIMESTAMP | GYRO | ACCEL_BODY | POSITION | VELOCITY;
+    if ((pkt.present & required) != required) {
+        received_bitmask = 0;
+        return true;
+    }
+    received_bitmask = pkt.present & ((1U << ARRAY_SIZE(keytable)) - 1);
+
+    state.timestamp_s = pkt.timestamp_s;
+    state.imu.gyro = Vector3f(pkt.gyro[0], pkt.gyro[1], pkt.gyro[2]);
+    state.imu.accel_body = Vector3f(pkt.accel_body[0], pkt.accel_body[1], pkt.accel_body[2]);
+    state.position = Vector3d(pkt.position[0], pkt.position[1], pkt.position[2]);
+    state.attitude = Vector3f(pkt.attitude[0], pkt.attitude[1], pkt.attitude[2]);
+    state.quaternion = Quaternion(pkt.quaternion[0], pkt.quaternion[1], pkt.quaternion[2], pkt.quaternion[3]);
+    state.velocity = Vector3f(pkt.velocity[0], pkt.velocity[1], pkt.velocity[2]);
+    memcpy(state.rng, pkt.rng, sizeof(state.rng));
+    state.wind_vane_apparent.direction = pkt.windvane_direction;
+    state.wind_vane_apparent.speed = pkt.windvane_speed;
+    state.airspeed = pkt.airspeed;
+    state.no_time_sync = pkt.no_time_sync != 0;
+    return true;
 }
 
 /*
@@ -254,23 +202,34 @@ void JSON::recv_fdm(const struct sitl_input &input)
         }
     }
 
-    // convert '\n' into nul
-    while (uint8_t *p = (uint8_t *)memchr(&sensor_buffer[sensor_buffer_len], '\n', ret)) {
-        *p = 0;
-    }
-    sensor_buffer_len += ret;
+    uint32_t received_bitmask = 0;
+    if (sensor_buffer_len == 0 && parse_binary_sensors(sensor_buffer, ret, received_bitmask)) {
+        // binary frames are whole datagrams, nothing to keep in the buffer
+    } else {
+        // convert '\n' into nul
+        while (uint8_t *p = (uint8_t *)memchr(&sensor_buffer[sensor_buffer_len], '\n', ret)) {
+            *p = 0;
+        }
+        sensor_buffer_len += ret;
 
-    const uint8_t *p2 = (const uint8_t *)memrchr(sensor_buffer, 0, sensor_buffer_len);
-    if (p2 == nullptr || p2 == sensor_buffer) {
-        return;
-    }
+        const uint8_t *p2 = (const uint8_t *)memrchr(sensor_buffer, 0, sensor_buffer_len);
+        if (p2 == nullptr || p2 == sensor_buffer) {
+            return;
+        }
 
-    const uint8_t *p1 = (const uint8_t *)memrchr(sensor_buffer, 0, p2 - sensor_buffer);
-    if (p1 == nullptr) {
-        return;
+        const uint8_t *p1 = (const uint8_t *)memrchr(sensor_buffer, 0, p2 - sensor_buffer);
+        if (p1 == nullptr) {
+            return;
+        }
+
+        received_bitmask = parser.parse((const char *)(p1+1));
+
+        // consume everything up to the end of the frame we parsed,
+        // including a malformed one so it can't block later frames
+        memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
+        sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
     }
 
-    const uint32_t received_bitmask = parse_sensors((const char *)(p1+1));
     if (received_bitmask == 0) {
         // did not receive one of the mandatory fields
         printf("Did not contain all mandatory fields\n");
@@ -301,9 +260,6 @@ void JSON::recv_fdm(const struct sitl_input &input)
     }
     last_received_bitmask = received_bitmask;
 
-    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
-    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
-
     accel_body = state.imu.accel_body;
     gyro = state.imu.gyro;
     velocity_ef = state.velocity;
@@ -20,6 +20,7 @@
 
 #include <AP_HAL/utility/Socket_native.h>
 #include "SIM_Aircraft.h"
+#include "SIM_JSON_Parser.h"
 
 namespace SITL {
 
@@ -68,21 +69,40 @@ private:
     void output_servos(const struct sitl_input &input);
     void recv_fdm(const struct sitl_input &input);
 
-    uint32_t parse_sensors(const char *json);
-
     // buffer for parsing pose data in JSON format
     uint8_t sensor_buffer[65000];
     uint32_t sensor_buffer_len;
 
-    enum data_type {
-        DATA_UINT64,
-        DATA_FLOAT,
-        DATA_DOUBLE,
-        DATA_VECTOR3F,
-        DATA_VECTOR3D,
-        QUATERNION,
-        BOOLEAN,
+    /*
+      fixed layout binary alternative to the JSON sensor frame. A
+      physics backend may send this instead of JSON; it is recognised
+      by its magic and length, so the backend chooses the format per
+      datagram. present is a DataKey bitmask of the valid fields
+     */
+    struct PACKED sensor_packet_binary {
+        uint16_t magic;
+        uint16_t length;
+        uint32_t present;
+        double timestamp_s;
+        float gyro[3];
+        float accel_body[3];
+        double position[3];
+        float attitude[3];
+        float quaternion[4];
+        float velocity[3];
+        float rng[6];
+        float windvane_direction;
+        float windvane_speed;
+        float airspeed;
+        uint8_t no_time_sync;
     };
+    static constexpr uint16_t SENSOR_BINARY_MAGIC = 21322;
+    bool binary_frames;
+
+    // decode a binary sensor frame, returns false if this is not one
+    bool parse_binary_sensors(const uint8_t *buf, ssize_t len, uint32_t &received_bitmask);
+
+    JSONParser parser;
 
     struct {
         double timestamp_s;
@@ -104,30 +124,24 @@ private:
     } state;
 
     // table to aid parsing of JSON sensor data
-    struct keytable {
-        const char *section;
-        const char *key;
-        void *ptr;
-        enum data_type type;
-        bool required;
-    } keytable[17] = {
-        { "", "timestamp", &state.timestamp_s, DATA_DOUBLE, true },
-        { "imu", "gyro",    &state.imu.gyro, DATA_VECTOR3F, true },
-        { "imu", "accel_body", &state.imu.accel_body, DATA_VECTOR3F, true },
-        { "", "position", &state.position, DATA_VECTOR3D, true },
-        { "", "attitude", &state.attitude, DATA_VECTOR3F, false },
-        { "", "quaternion", &state.quaternion, QUATERNION, false },
-        { "", "velocity", &state.velocity, DATA_VECTOR3F, true },
-        { "", "rng_1", &state.rng[0], DATA_FLOAT, false },
-        { "", "rng_2", &state.rng[1], DATA_FLOAT, false },
-        { "", "rng_3", &state.rng[2], DATA_FLOAT, false },
-        { "", "rng_4", &state.rng[3], DATA_FLOAT, false },
-        { "", "rng_5", &state.rng[4], DATA_FLOAT, false },
-        { "", "rng_6", &state.rng[5], DATA_FLOAT, false },
-        {"windvane","direction", &state.wind_vane_apparent.direction, DATA_FLOAT, false},
-        {"windvane","speed", &state.wind_vane_apparent.speed, DATA_FLOAT, false},
-        {"", "airspeed", &state.airspeed, DATA_FLOAT, false},
-        {"", "no_time_sync", &state.no_time_sync, BOOLEAN, false},
+    const JSONParser::keytable keytable[17] = {
+        { "", "timestamp", &state.timestamp_s, JSONParser::DATA_DOUBLE, true },
+        { "imu", "gyro",    &state.imu.gyro, JSONParser::DATA_VECTOR3F, true },
+        { "imu", "accel_body", &state.imu.accel_body, JSONParser::DATA_VECTOR3F, true },
+        { "", "position", &state.position, JSONParser::DATA_VECTOR3D, true },
+        { "", "attitude", &state.attitude, JSONParser::DATA_VECTOR3F, false },
+        { "", "quaternion", &state.quaternion, JSONParser::QUATERNION, false },
+        { "", "velocity", &state.velocity, JSONParser::DATA_VECTOR3F, true },
+        { "", "rng_1", &state.rng[0], JSONParser::DATA_FLOAT, false },
+        { "", "rng_2", &state.rng[1], JSONParser::DATA_FLOAT, false },
+        { "", "rng_3", &state.rng[2], JSONParser::DATA_FLOAT, false },
+        { "", "rng_4", &state.rng[3], JSONParser::DATA_FLOAT, false },
+        { "", "rng_5", &state.rng[4], JSONParser::DATA_FLOAT, false },
+        { "", "rng_6", &state.rng[5], JSONParser::DATA_FLOAT, false },
+        {"windvane","direction", &state.wind_vane_apparent.direction, JSONParser::DATA_FLOAT, false},
+        {"windvane","speed", &state.wind_vane_apparent.speed, JSONParser::DATA_FLOAT, false},
+        {"", "airspeed", &state.airspeed, JSONParser::DATA_FLOAT, false},
+        {"", "no_time_sync", &state.no_time_sync, JSONParser::BOOLEAN, false},
     };
 
     // Enum coresponding to the ordering of keys in the keytable.
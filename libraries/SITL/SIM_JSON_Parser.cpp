@@ -0,0 +1,398 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+    single pass parser for the sensor data sent by JSON physics backends
+
+    The datagram is walked once. Each key is looked up in a perfect
+    hash table built from the key table at startup, so the cost per
+    frame is proportional to the size of the frame rather than the
+    number of keys times the size of the frame.
+
+    This parser does only the syntax checking needed to find its way
+    through the object, and is not at all general purpose
+*/
+
+#include "SIM_JSON_Parser.h"
+
+#if AP_SIM_JSON_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace SITL;
+
+/*
+  FNV-1a over "section/key" with a seed to allow a collision free
+  table to be found
+ */
+uint32_t JSONParser::hash(uint32_t _seed, const char *section, uint8_t section_len, const char *key, uint8_t key_len)
+{
+    uint32_t h = 2166136261U ^ _seed;
+    for (uint8_t i=0; i<section_len; i++) {
+        h = (h ^ uint8_t(section[i])) * 16777619U;
+    }
+    h = (h ^ uint8_t('/')) * 16777619U;
+    for (uint8_t i=0; i<key_len; i++) {
+        h = (h ^ uint8_t(key[i])) * 16777619U;
+    }
+    return h;
+}
+
+bool JSONParser::init(const struct keytable *_keys, uint8_t _num_keys)
+{
+    keys = _keys;
+    num_keys = 0;
+    required_mask = 0;
+    if (_num_keys > MAX_KEYS) {
+        return false;
+    }
+
+    for (uint32_t s=0; s<1024; s++) {
+        memset(slots, EMPTY_SLOT, sizeof(slots));
+        bool collision = false;
+        for (uint8_t i=0; i<_num_keys; i++) {
+            const uint32_t h = hash(s,
+                                    keys[i].section, strlen(keys[i].section),
+                                    keys[i].key, strlen(keys[i].key));
+            uint8_t &slot = slots[h % HASH_TABLE_SIZE];
+            if (slot != EMPTY_SLOT) {
+                collision = true;
+                break;
+            }
+            slot = i;
+        }
+        if (!collision) {
+            seed = s;
+            num_keys = _num_keys;
+            for (uint8_t i=0; i<num_keys; i++) {
+                if (keys[i].required) {
+                    required_mask |= 1U << i;
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+int8_t JSONParser::lookup(const char *section, uint8_t section_len, const char *key, uint8_t key_len) const
+{
+    const uint8_t idx = slots[hash(seed, section, section_len, key, key_len) % HASH_TABLE_SIZE];
+    if (idx == EMPTY_SLOT) {
+        return -1;
+    }
+    // unknown keys can land in a used slot, so confirm the match
+    const struct keytable &k = keys[idx];
+    if (strncmp(k.section, section, section_len) != 0 || k.section[section_len] != 0 ||
+        strncmp(k.key, key, key_len) != 0 || k.key[key_len] != 0) {
+        return -1;
+    }
+    return idx;
+}
+
+/*
+  parse a number. Plain decimals with up to 15 significant digits are
+  converted exactly with one division by a power of ten (the value is
+  correctly rounded as both operands are exact doubles); anything else
+  falls back to strtod()
+ */
+double JSONParser::parse_number(const char *p, const char **end)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+    const char *s = p;
+    bool negative = false;
+    if (*s == '-') {
+        negative = true;
+        s++;
+    }
+    uint64_t mantissa = 0;
+    uint8_t digits = 0;
+    uint8_t frac_digits = 0;
+    const char *start = s;
+    while (*s >= '0' && *s <= '9') {
+        mantissa = mantissa*10 + (*s++ - '0');
+        digits++;
+    }
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            mantissa = mantissa*10 + (*s++ - '0');
+            digits++;
+            frac_digits++;
+        }
+    }
+    if (s == start || digits > 15 || *s == 'e' || *s == 'E') {
+        char *e;
+        const double ret = strtod(p, &e);
+        *end = e;
+        return ret;
+    }
+    *end = s;
+    const double ret = double(mantissa) / pow10[frac_digits];
+    return negative ? -ret : ret;
+}
+
+const char *JSONParser::parse_float_array(const char *p, float *v, uint8_t n)
+{
+    p = skip_space(p);
+    if (*p++ != '[') {
+        return nullptr;
+    }
+    for (uint8_t i=0; i<n; i++) {
+        const char *end;
+        p = skip_space(p);
+        v[i] = parse_number(p, &end);
+        if (end == p) {
+            return nullptr;
+        }
+        p = skip_space(end);
+        if (*p++ != (i == n-1 ? ']' : ',')) {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+const char *JSONParser::parse_double_array(const char *p, double *v, uint8_t n)
+{
+    p = skip_space(p);
+    if (*p++ != '[') {
+        return nullptr;
+    }
+    for (uint8_t i=0; i<n; i++) {
+        const char *end;
+        p = skip_space(p);
+        v[i] = parse_number(p, &end);
+        if (end == p) {
+            return nullptr;
+        }
+        p = skip_space(end);
+        if (*p++ != (i == n-1 ? ']' : ',')) {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+const char *JSONParser::parse_value(const char *p, const struct keytable &key)
+{
+    const char *end = nullptr;
+    switch (key.type) {
+        case DATA_UINT64:
+            *((uint64_t *)key.ptr) = strtoull(p, (char **)&end, 10);
+            break;
+
+        case DATA_FLOAT:
+            *((float *)key.ptr) = parse_number(p, &end);
+            break;
+
+        case DATA_DOUBLE:
+            *((double *)key.ptr) = parse_number(p, &end);
+            break;
+
+        case DATA_VECTOR3F: {
+            Vector3f *v = (Vector3f *)key.ptr;
+            float f[3];
+            p = parse_float_array(p, f, 3);
+            if (p != nullptr) {
+                v->x = f[0];
+                v->y = f[1];
+                v->z = f[2];
+            }
+            return p;
+        }
+
+        case DATA_VECTOR3D: {
+            Vector3d *v = (Vector3d *)key.ptr;
+            double d[3];
+            p = parse_double_array(p, d, 3);
+            if (p != nullptr) {
+                v->x = d[0];
+                v->y = d[1];
+                v->z = d[2];
+            }
+            return p;
+        }
+
+        case QUATERNION: {
+            Quaternion *v = static_cast<Quaternion*>(key.ptr);
+            float f[4];
+            p = parse_float_array(p, f, 4);
+            if (p != nullptr) {
+                v->q1 = f[0];
+                v->q2 = f[1];
+                v->q3 = f[2];
+                v->q4 = f[3];
+            }
+            return p;
+        }
+
+        case BOOLEAN:
+            if (strncmp(p, "true", 4) == 0) {
+                *((bool *)key.ptr) = true;
+                return p + 4;
+            }
+            if (strncmp(p, "false", 5) == 0) {
+                *((bool *)key.ptr) = false;
+                return p + 5;
+            }
+            *((bool *)key.ptr) = strtoull(p, (char **)&end, 10) != 0;
+            break;
+    }
+    if (end == p) {
+        return nullptr;
+    }
+    return end;
+}
+
+const char *JSONParser::skip_value(const char *p)
+{
+    p = skip_space(p);
+    uint8_t nesting = 0;
+    bool in_string = false;
+    for (; *p; p++) {
+        const char c = *p;
+        if (in_string) {
+            if (c == '\\' && p[1] != 0) {
+                p++;
+            } else if (c == '"') {
+                in_string = false;
+                if (nesting == 0) {
+                    return p + 1;
+                }
+            }
+            continue;
+        }
+        switch (c) {
+        case '"':
+            in_string = true;
+            break;
+        case '{':
+        case '[':
+            nesting++;
+            break;
+        case '}':
+        case ']':
+            if (nesting == 0) {
+                // end of the enclosing object
+                return p;
+            }
+            if (--nesting == 0) {
+                return p + 1;
+            }
+            break;
+        case ',':
+            if (nesting == 0) {
+                return p;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return p;
+}
+
+const char *JSONParser::parse_object(const char *p, const char *section, uint8_t section_len, uint8_t depth, uint32_t &received_bitmask, bool &ok) const
+{
+    while (true) {
+        p = skip_space(p);
+        if (*p == '}') {
+            return p + 1;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        if (*p != '"') {
+            return nullptr;
+        }
+        const char *key = ++p;
+        const char *key_end = (const char *)strchr(key, '"');
+        if (key_end == nullptr || key_end - key > UINT8_MAX) {
+            return nullptr;
+        }
+        p = skip_space(key_end + 1);
+        if (*p++ != ':') {
+            return nullptr;
+        }
+        p = skip_space(p);
+        const uint8_t key_len = key_end - key;
+
+        if (*p == '{') {
+            if (depth == 0) {
+                // sections are one level deep
+                p = parse_object(p + 1, key, key_len, depth + 1, received_bitmask, ok);
+            } else {
+                p = skip_value(p);
+            }
+            if (p == nullptr || !ok) {
+                return p;
+            }
+            continue;
+        }
+
+        const int8_t idx = lookup(section, section_len, key, key_len);
+        if (idx < 0) {
+            p = skip_value(p);
+            continue;
+        }
+
+        // record the keys that are found
+        received_bitmask |= 1U << idx;
+
+        const struct keytable &k = keys[idx];
+        p = parse_value(p, k);
+        if (p == nullptr) {
+            printf("Failed to parse %s/%s\n", k.section, k.key);
+            ok = false;
+            return nullptr;
+        }
+    }
+}
+
+uint32_t JSONParser::parse(const char *json) const
+{
+    uint32_t received_bitmask = 0;
+
+    const char *p = skip_space(json);
+    if (*p != '{') {
+        printf("Failed to find JSON object\n");
+        return 0;
+    }
+    bool ok = true;
+    parse_object(p + 1, "", 0, 0, received_bitmask, ok);
+    if (!ok) {
+        return received_bitmask;
+    }
+
+    if ((received_bitmask & required_mask) != required_mask) {
+        const uint32_t missing = required_mask & ~received_bitmask;
+        for (uint8_t i=0; i<num_keys; i++) {
+            if (missing & (1U << i)) {
+                printf("Failed to find %s/%s\n", keys[i].section, keys[i].key);
+                break;
+            }
+        }
+        return 0;
+    }
+
+    return received_bitmask;
+}
+
+#endif  // AP_SIM_JSON_ENABLED
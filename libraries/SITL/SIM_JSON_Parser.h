@@ -0,0 +1,110 @@
+/*
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+    single pass parser for the sensor data sent by JSON physics backends
+*/
+
+#pragma once
+
+#include "SIM_config.h"
+
+#if AP_SIM_JSON_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+namespace SITL {
+
+class JSONParser {
+public:
+    enum data_type : uint8_t {
+        DATA_UINT64,
+        DATA_FLOAT,
+        DATA_DOUBLE,
+        DATA_VECTOR3F,
+        DATA_VECTOR3D,
+        QUATERNION,
+        BOOLEAN,
+    };
+
+    // a field to be extracted, section is "" for top level keys
+    struct keytable {
+        const char *section;
+        const char *key;
+        void *ptr;
+        enum data_type type;
+        bool required;
+    };
+
+    static constexpr uint8_t MAX_KEYS = 32;
+
+    /*
+      build the lookup table for a set of keys. The table must outlive
+      the parser. Returns false if there are too many keys or no
+      collision free hash could be found
+     */
+    bool init(const struct keytable *keys, uint8_t num_keys);
+
+    /*
+      parse one nul terminated JSON object, writing the value of each
+      known key to its pointer. Returns a bitmask of the keys found,
+      indexed by position in the table, or 0 if a required key was
+      missing
+     */
+    uint32_t parse(const char *json) const;
+
+private:
+    static constexpr uint8_t HASH_TABLE_SIZE = 64;
+    static constexpr uint8_t EMPTY_SLOT = 0xFF;
+
+    const struct keytable *keys;
+    uint8_t num_keys;
+    uint32_t required_mask;
+    uint32_t seed;
+
+    // index into keys for each hash slot, EMPTY_SLOT if unused
+    uint8_t slots[HASH_TABLE_SIZE];
+
+    static uint32_t hash(uint32_t seed, const char *section, uint8_t section_len, const char *key, uint8_t key_len);
+
+    // find the key index for a section and key, returns -1 if unknown
+    int8_t lookup(const char *section, uint8_t section_len, const char *key, uint8_t key_len) const;
+
+    // parse the members of an object, p points after the opening brace
+    const char *parse_object(const char *p, const char *section, uint8_t section_len, uint8_t depth, uint32_t &received_bitmask, bool &ok) const;
+
+    // parse a value into the given key, returns nullptr on a malformed value
+    static const char *parse_value(const char *p, const struct keytable &key);
+
+    // parse a number without the overhead of strtod() in the common case
+    static double parse_number(const char *p, const char **end);
+
+    // parse a [a, b, ...] array of n numbers
+    static const char *parse_float_array(const char *p, float *v, uint8_t n);
+    static const char *parse_double_array(const char *p, double *v, uint8_t n);
+
+    // skip over a value we don't know about
+    static const char *skip_value(const char *p);
+
+    static const char *skip_space(const char *p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+        }
+        return p;
+    }
+};
+
+}
+
+#endif  // AP_SIM_JSON_ENABLED
@@ -0,0 +1,145 @@
+#include <AP_gbenchmark.h>
+
+#include <SITL/SIM_JSON_Parser.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_JSON_ENABLED
+
+using namespace SITL;
+
+/*
+  frames as recorded from typical JSON physics backends
+ */
+static const char *recorded_frames[] = {
+    // minimal frame, as sent by the example backends
+    "{\"timestamp\":2500.0025,\"imu\":{\"gyro\":[0.0012,-0.0031,0.0004],\"accel_body\":[0.0213,-0.0119,-9.8066]},\"position\":[12.345678,-3.456789,-10.123456],\"attitude\":[0.0012,-0.0021,1.5707],\"velocity\":[0.5123,-0.0231,-0.0012]}",
+    // frame with optional sensors, pretty printed
+    "{\"timestamp\": 812.4375, \"imu\": {\"gyro\": [0.01234567, -0.00456789, 0.1234567], \"accel_body\": [0.1234567, 0.0456789, -9.7654321]}, "
+    "\"position\": [-123.456789, 456.789012, -50.123456], \"quaternion\": [0.9987654, 0.0123456, -0.0234567, 0.0456789], "
+    "\"velocity\": [5.1234567, -2.3456789, 0.1234567], \"rng_1\": 12.34, \"rng_2\": 5.67, "
+    "\"windvane\": {\"direction\": 0.7853981, \"speed\": 4.5678}, \"airspeed\": 15.6789, \"no_time_sync\": 0}",
+};
+
+static struct {
+    double timestamp_s;
+    Vector3f gyro;
+    Vector3f accel_body;
+    Vector3d position;
+    Vector3f attitude;
+    Quaternion quaternion;
+    Vector3f velocity;
+    float rng[6];
+    float wind_direction;
+    float wind_speed;
+    float airspeed;
+    bool no_time_sync;
+} state;
+
+static const JSONParser::keytable keytable[] = {
+    { "", "timestamp", &state.timestamp_s, JSONParser::DATA_DOUBLE, true },
+    { "imu", "gyro",    &state.gyro, JSONParser::DATA_VECTOR3F, true },
+    { "imu", "accel_body", &state.accel_body, JSONParser::DATA_VECTOR3F, true },
+    { "", "position", &state.position, JSONParser::DATA_VECTOR3D, true },
+    { "", "attitude", &state.attitude, JSONParser::DATA_VECTOR3F, false },
+    { "", "quaternion", &state.quaternion, JSONParser::QUATERNION, false },
+    { "", "velocity", &state.velocity, JSONParser::DATA_VECTOR3F, true },
+    { "", "rng_1", &state.rng[0], JSONParser::DATA_FLOAT, false },
+    { "", "rng_2", &state.rng[1], JSONParser::DATA_FLOAT, false },
+    { "", "rng_3", &state.rng[2], JSONParser::DATA_FLOAT, false },
+    { "", "rng_4", &state.rng[3], JSONParser::DATA_FLOAT, false },
+    { "", "rng_5", &state.rng[4], JSONParser::DATA_FLOAT, false },
+    { "", "rng_6", &state.rng[5], JSONParser::DATA_FLOAT, false },
+    {"windvane","direction", &state.wind_direction, JSONParser::DATA_FLOAT, false},
+    {"windvane","speed", &state.wind_speed, JSONParser::DATA_FLOAT, false},
+    {"", "airspeed", &state.airspeed, JSONParser::DATA_FLOAT, false},
+    {"", "no_time_sync", &state.no_time_sync, JSONParser::BOOLEAN, false},
+};
+
+/*
+  the previous parser, a strstr() search of the whole frame per key,
+  kept here as the baseline
+ */
+static uint32_t parse_strstr(const char *json)
+{
+    uint32_t received_bitmask = 0;
+    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        const JSONParser::keytable &key = keytable[i];
+        const char *p = strstr(json, key.section);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        p += strlen(key.section)+1;
+        p = strstr(p, key.key);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        received_bitmask |= 1U << i;
+        p += strlen(key.key)+2;
+        switch (key.type) {
+        case JSONParser::DATA_UINT64:
+            *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
+            break;
+        case JSONParser::DATA_FLOAT:
+            *((float *)key.ptr) = atof(p);
+            break;
+        case JSONParser::DATA_DOUBLE:
+            *((double *)key.ptr) = atof(p);
+            break;
+        case JSONParser::DATA_VECTOR3F: {
+            Vector3f *v = (Vector3f *)key.ptr;
+            sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z);
+            break;
+        }
+        case JSONParser::DATA_VECTOR3D: {
+            Vector3d *v = (Vector3d *)key.ptr;
+            sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z);
+            break;
+        }
+        case JSONParser::QUATERNION: {
+            Quaternion *v = static_cast<Quaternion*>(key.ptr);
+            sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4));
+            break;
+        }
+        case JSONParser::BOOLEAN:
+            *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
+            break;
+        }
+    }
+    return received_bitmask;
+}
+
+static void BM_JSONParseStrstr(benchmark::State& bstate)
+{
+    const char *frame = recorded_frames[bstate.range(0)];
+    while (bstate.KeepRunning()) {
+        uint32_t mask = parse_strstr(frame);
+        gbenchmark_escape(&mask);
+    }
+    bstate.SetBytesProcessed(int64_t(bstate.iterations()) * strlen(frame));
+}
+
+static void BM_JSONParseSinglePass(benchmark::State& bstate)
+{
+    JSONParser parser;
+    parser.init(keytable, ARRAY_SIZE(keytable));
+    const char *frame = recorded_frames[bstate.range(0)];
+    while (bstate.KeepRunning()) {
+        uint32_t mask = parser.parse(frame);
+        gbenchmark_escape(&mask);
+    }
+    bstate.SetBytesProcessed(int64_t(bstate.iterations()) * strlen(frame));
+}
+
+BENCHMARK(BM_JSONParseStrstr)->DenseRange(0, ARRAY_SIZE(recorded_frames)-1);
+BENCHMARK(BM_JSONParseSinglePass)->DenseRange(0, ARRAY_SIZE(recorded_frames)-1);
+
+#endif  // AP_SIM_JSON_ENABLED
+
+BENCHMARK_MAIN();
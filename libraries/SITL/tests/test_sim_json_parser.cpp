@@ -0,0 +1,64 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_JSON_Parser.h>
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+using namespace SITL;
+
+static struct {
+    double timestamp_s;
+    Vector3f gyro;
+    Vector3d position;
+    Quaternion quaternion;
+    float direction;
+    bool no_time_sync;
+} state;
+
+static const JSONParser::keytable keytable[] = {
+    { "", "timestamp", &state.timestamp_s, JSONParser::DATA_DOUBLE, true },
+    { "imu", "gyro", &state.gyro, JSONParser::DATA_VECTOR3F, true },
+    { "", "position", &state.position, JSONParser::DATA_VECTOR3D, true },
+    { "", "quaternion", &state.quaternion, JSONParser::QUATERNION, false },
+    { "windvane", "direction", &state.direction, JSONParser::DATA_FLOAT, false },
+    { "", "no_time_sync", &state.no_time_sync, JSONParser::BOOLEAN, false },
+};
+
+TEST(JSONParser, Parse)
+{
+    JSONParser parser;
+    ASSERT_TRUE(parser.init(keytable, ARRAY_SIZE(keytable)));
+
+    const char *json = "{\"timestamp\": 2500.125, \"other\":{\"gyro\":[9,9,9],\"s\":\"}\"},"
+        "\"imu\":{\"gyro\":[0.5, -0.25,1e-3]},\"position\":[-12.5,3,1234567.125],"
+        "\"windvane\":{\"direction\":0.75},\"no_time_sync\":true}";
+    EXPECT_EQ(parser.parse(json), 0x37U);
+    EXPECT_DOUBLE_EQ(state.timestamp_s, 2500.125);
+    EXPECT_FLOAT_EQ(state.gyro.x, 0.5);
+    EXPECT_FLOAT_EQ(state.gyro.y, -0.25);
+    EXPECT_FLOAT_EQ(state.gyro.z, 0.001);
+    EXPECT_DOUBLE_EQ(state.position.x, -12.5);
+    EXPECT_DOUBLE_EQ(state.position.z, 1234567.125);
+    EXPECT_FLOAT_EQ(state.direction, 0.75);
+    EXPECT_TRUE(state.no_time_sync);
+}
+
+TEST(JSONParser, MissingRequired)
+{
+    JSONParser parser;
+    ASSERT_TRUE(parser.init(keytable, ARRAY_SIZE(keytable)));
+
+    // gyro outside of the imu section does not count
+    EXPECT_EQ(parser.parse("{\"timestamp\":1,\"gyro\":[1,2,3],\"position\":[1,2,3]}"), 0U);
+    EXPECT_EQ(parser.parse("not json"), 0U);
+}
+
+TEST(JSONParser, Malformed)
+{
+    JSONParser parser;
+    ASSERT_TRUE(parser.init(keytable, ARRAY_SIZE(keytable)));
+
+    // parsing stops at the bad vector, reporting what was found so far
+    EXPECT_EQ(parser.parse("{\"timestamp\":1,\"imu\":{\"gyro\":[1,2]},\"position\":[1,2,3]}"), 0x3U);
+}
+
+AP_GTEST_MAIN()